@@ -0,0 +1,225 @@
+#include "adf_test.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "distributions.h"
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// MacKinnon (1994) response surface for N = 1, indexed by AdfRegression
+const double TAU_MAX[3] = {std::numeric_limits<double>::infinity(), 2.74, 0.7};
+const double TAU_MIN[3] = {-19.04, -18.83, -16.18};
+const double TAU_STAR[3] = {-1.04, -1.61, -2.89};
+const double TAU_SMALLP[3][3] = {
+    {0.6344, 1.2378, 3.2496e-2},
+    {2.1659, 1.4412, 3.8269e-2},
+    {3.2512, 1.6047, 4.9588e-2},
+};
+const double TAU_LARGEP[3][4] = {
+    {0.4797, 9.3557e-1, -0.6999e-1, 3.3066e-2},
+    {1.7339, 9.3202e-1, -1.2745e-1, -1.0368e-2},
+    {2.5261, 6.1654e-1, -3.7956e-1, -6.0285e-2},
+};
+
+// MacKinnon (2010) critical values for N = 1: 1%, 5%, 10%, each a polynomial in 1 / nobs
+const double TAU_2010[3][3][4] = {
+    {{-2.56574, -2.2358, -3.627, 0}, {-1.94100, -0.2686, -3.365, 31.223}, {-1.61682, 0.2656, -2.714, 25.364}},
+    {{-3.43035, -6.5393, -16.786, -79.433}, {-2.86154, -2.8903, -4.234, -40.040}, {-2.56677, -1.5384, -2.809, 0}},
+    {{-3.95877, -9.0531, -28.428, -134.155}, {-3.41049, -4.3904, -9.036, -45.374}, {-3.12705, -2.5856, -3.925, -22.380}},
+};
+
+// Buffers reused from one test to the next
+struct AdfWorkspace {
+    std::vector<double> values;   // the series without NaN
+    std::vector<double> design;   // column-major, nobs x columns
+    std::vector<double> response; // differences, then Q^T times them
+};
+
+thread_local AdfWorkspace workspace;
+
+double polynomial(const double* coefficients, int count, double x) {
+    double value = 0.0;
+    for (int i = count - 1; i >= 0; --i) value = value * x + coefficients[i];
+    return value;
+}
+
+// Function to build the Dickey-Fuller regression with lag lagged differences
+// over the last n - 1 - lag differences: deterministic terms, then the lagged
+// level and the lagged differences (levelFirst), or the level last
+size_t buildDesign(const std::vector<double>& x, int terms, int lag, bool levelFirst, AdfWorkspace& ws) {
+    const size_t nobs = x.size() - 1 - lag;
+    const size_t columns = terms + 1 + lag;
+    ws.design.resize(nobs * columns);
+    ws.response.resize(nobs);
+
+    double* column = ws.design.data();
+    auto nextColumn = [&]() {
+        double* c = column;
+        column += nobs;
+        return c;
+    };
+
+    if (terms > 0) std::fill_n(nextColumn(), nobs, 1.0);
+    if (terms > 1) {
+        double* trend = nextColumn();
+        for (size_t t = 0; t < nobs; ++t) trend[t] = static_cast<double>(t + 1);
+    }
+
+    double* level = levelFirst ? nextColumn() : nullptr;
+    for (int i = 1; i <= lag; ++i) {
+        double* lagged = nextColumn();
+        for (size_t t = 0; t < nobs; ++t) {
+            const size_t j = lag + t - i;
+            lagged[t] = x[j + 1] - x[j];
+        }
+    }
+    if (!level) level = nextColumn();
+
+    for (size_t t = 0; t < nobs; ++t) {
+        level[t] = x[lag + t];
+        ws.response[t] = x[lag + t + 1] - x[lag + t];
+    }
+    return nobs;
+}
+
+// Function to triangularize the design in place with Householder reflections,
+// applying the same reflections to the response. The diagonal of R is left
+// on the diagonal of the design.
+void householderQr(double* a, size_t rows, size_t columns, double* y) {
+    for (size_t j = 0; j < columns && j < rows; ++j) {
+        double* v = a + j * rows;
+        double norm2 = 0.0;
+        for (size_t i = j; i < rows; ++i) norm2 += v[i] * v[i];
+        if (norm2 == 0.0) continue;
+
+        const double alpha = v[j] > 0.0 ? -std::sqrt(norm2) : std::sqrt(norm2);
+        const double head = v[j] - alpha; // first element of the reflection vector
+        const double vNorm2 = norm2 - v[j] * v[j] + head * head;
+        v[j] = alpha;
+
+        auto reflect = [&](double* c) {
+            double s = head * c[j];
+            for (size_t i = j + 1; i < rows; ++i) s += v[i] * c[i];
+            const double f = 2.0 * s / vNorm2;
+            c[j] -= f * head;
+            for (size_t i = j + 1; i < rows; ++i) c[i] -= f * v[i];
+        };
+        for (size_t c = j + 1; c < columns; ++c) reflect(a + c * rows);
+        reflect(y);
+    }
+}
+
+AdfResult runAdf(const std::vector<double>& x, const AdfOptions& options, AdfWorkspace& ws) {
+    AdfResult result;
+    const size_t n = x.size();
+    if (n < 2 || *std::max_element(x.begin(), x.end()) == *std::min_element(x.begin(), x.end())) {
+        return result;
+    }
+
+    const int terms = options.regression == ADF_NO_CONSTANT ? 0 : (options.regression == ADF_CONSTANT ? 1 : 2);
+    const long cap = static_cast<long>(n / 2) - terms - 1;
+    long maxLag = options.maxLag;
+    if (maxLag < 0) {
+        // Schwert (1989), as in statsmodels
+        maxLag = std::min(cap, static_cast<long>(std::ceil(12.0 * std::pow(n / 100.0, 0.25))));
+    }
+    if (maxLag < 0 || maxLag > cap) {
+        return result;
+    }
+
+    int usedLag = static_cast<int>(maxLag);
+    if (options.autolag != ADF_LAG_FIXED) {
+        // Every candidate uses the same observations; with the level in the
+        // leading columns, the fit with the first j columns has the residual
+        // sum of squares of the last nobs - j entries of Q^T y
+        const size_t nobs = buildDesign(x, terms, usedLag, true, ws);
+        const size_t startColumns = terms + 1;
+        householderQr(ws.design.data(), nobs, startColumns + maxLag, ws.response.data());
+
+        const double penalty = options.autolag == ADF_LAG_AIC ? 2.0 : std::log(static_cast<double>(nobs));
+        double ssr = 0.0;
+        for (size_t i = startColumns + maxLag; i < nobs; ++i) ssr += ws.response[i] * ws.response[i];
+
+        for (long lag = maxLag; lag >= 0; --lag) {
+            const size_t columns = startColumns + lag;
+            if (lag < maxLag) ssr += ws.response[columns] * ws.response[columns];
+
+            // -2 log-likelihood of a Gaussian OLS fit plus the penalty per parameter
+            const double ic = nobs * (std::log(2.0 * PI) + std::log(ssr / nobs) + 1.0) + penalty * columns;
+            if (lag == maxLag || ic <= result.icBest) { // ties go to the shorter lag
+                result.icBest = ic;
+                usedLag = static_cast<int>(lag);
+            }
+        }
+    }
+
+    const size_t nobs = buildDesign(x, terms, usedLag, false, ws);
+    const size_t columns = terms + 1 + usedLag;
+    if (nobs <= columns) {
+        return AdfResult();
+    }
+    householderQr(ws.design.data(), nobs, columns, ws.response.data());
+
+    const double rLevel = ws.design[(columns - 1) * nobs + columns - 1];
+    double ssr = 0.0;
+    for (size_t i = columns; i < nobs; ++i) ssr += ws.response[i] * ws.response[i];
+    if (rLevel == 0.0 || !(ssr > 0.0)) {
+        return AdfResult();
+    }
+
+    // With the level last, its coefficient is (Q^T y)_k / R_kk and its
+    // standard error sigma / |R_kk|
+    const double sigma = std::sqrt(ssr / (nobs - columns));
+    result.statistic = ws.response[columns - 1] / sigma * (rLevel > 0.0 ? 1.0 : -1.0);
+    result.pValue = mackinnonPValue(result.statistic, options.regression);
+    result.usedLag = usedLag;
+    result.nobs = nobs;
+    mackinnonCriticalValues(options.regression, nobs, result.criticalValues);
+    return result;
+}
+
+} // namespace
+
+double mackinnonPValue(double statistic, AdfRegression regression) {
+    if (std::isnan(statistic)) return NAN;
+    if (statistic > TAU_MAX[regression]) return 1.0;
+    if (statistic < TAU_MIN[regression]) return 0.0;
+
+    if (statistic <= TAU_STAR[regression]) {
+        return normalCdf(polynomial(TAU_SMALLP[regression], 3, statistic));
+    }
+    return normalCdf(polynomial(TAU_LARGEP[regression], 4, statistic));
+}
+
+void mackinnonCriticalValues(AdfRegression regression, size_t nobs, double criticalValues[3]) {
+    for (int level = 0; level < 3; ++level) {
+        criticalValues[level] = polynomial(TAU_2010[regression][level], 4, 1.0 / static_cast<double>(nobs));
+    }
+}
+
+AdfResult adfTest(const double* y, size_t n, const AdfOptions& options) {
+    AdfResult result;
+    adfTestBatch(y, n, 0, 1, 1, options, &result);
+    return result;
+}
+
+template <typename T>
+void adfTestBatch(const T* y, size_t n, size_t seriesStride, size_t timeStride, size_t series,
+                  const AdfOptions& options, AdfResult* results) {
+    AdfWorkspace& ws = workspace;
+    for (size_t s = 0; s < series; ++s) {
+        ws.values.clear();
+        for (size_t i = 0; i < n; ++i) {
+            const double v = y[s * seriesStride + i * timeStride];
+            if (!std::isnan(v)) ws.values.push_back(v);
+        }
+        results[s] = runAdf(ws.values, options, ws);
+    }
+}
+
+template void adfTestBatch<float>(const float*, size_t, size_t, size_t, size_t, const AdfOptions&, AdfResult*);
+template void adfTestBatch<double>(const double*, size_t, size_t, size_t, size_t, const AdfOptions&, AdfResult*);
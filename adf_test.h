@@ -0,0 +1,60 @@
+#ifndef ADF_TEST_H
+#define ADF_TEST_H
+
+#include <cmath>
+#include <cstddef>
+
+// Deterministic terms of the Dickey-Fuller regression
+enum AdfRegression {
+    ADF_NO_CONSTANT,   // "n"
+    ADF_CONSTANT,      // "c", the default
+    ADF_CONSTANT_TREND // "ct"
+};
+
+// How the number of lagged differences is chosen
+enum AdfLagSelection {
+    ADF_LAG_FIXED, // always maxLag
+    ADF_LAG_AIC,
+    ADF_LAG_BIC
+};
+
+struct AdfOptions {
+    AdfRegression regression = ADF_CONSTANT;
+    AdfLagSelection autolag = ADF_LAG_AIC;
+    int maxLag = -1; // -1: ceil(12 * (n / 100)^(1/4)), capped at n / 2 - terms - 1
+};
+
+// Outcome of one Augmented Dickey-Fuller test; everything is NaN (and
+// usedLag -1) when the series is too short or constant
+struct AdfResult {
+    double statistic = NAN;         // t statistic of the lagged level
+    double pValue = NAN;            // MacKinnon (1994) approximate p-value
+    int usedLag = -1;               // lagged differences in the final regression
+    size_t nobs = 0;                // observations in the final regression
+    double criticalValues[3] = {NAN, NAN, NAN}; // 1%, 5%, 10% (MacKinnon 2010)
+    double icBest = NAN;            // information criterion of the chosen lag
+
+    bool valid() const { return !std::isnan(statistic); }
+};
+
+// Function to run the Augmented Dickey-Fuller unit root test on n values,
+// skipping NaN ones. It follows statsmodels' adfuller: with automatic lag
+// selection every lag 0..maxLag is fitted on the same observations, the lag
+// with the smallest criterion is chosen and the regression refitted on all
+// observations that lag allows.
+AdfResult adfTest(const double* y, size_t n, const AdfOptions& options);
+
+// Function to test many series laid out as in regressBatch: value i of series
+// s is y[s * seriesStride + i * timeStride]. Work buffers are reused across
+// series (and kept per thread), so a batch allocates nothing once warm.
+template <typename T>
+void adfTestBatch(const T* y, size_t n, size_t seriesStride, size_t timeStride, size_t series,
+                  const AdfOptions& options, AdfResult* results);
+
+// Function to compute MacKinnon's approximate p-value of a test statistic
+double mackinnonPValue(double statistic, AdfRegression regression);
+
+// Function to compute the 1%, 5% and 10% critical values for nobs observations
+void mackinnonCriticalValues(AdfRegression regression, size_t nobs, double criticalValues[3]);
+
+#endif // ADF_TEST_H
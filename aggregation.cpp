@@ -0,0 +1,134 @@
+#include "aggregation.h"
+
+#include <cmath>
+#include <limits>
+
+#include "gridded_field.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Month groups whose sums make up the aggregates
+enum MonthGroup { GROUP_JF, GROUP_MAM, GROUP_JJA, GROUP_SON, GROUP_DEC, GROUP_PREVIOUS_DEC, GROUP_COUNT };
+
+const int GROUP_OF_MONTH[MONTHS_PER_YEAR] = {GROUP_JF,  GROUP_JF,  GROUP_MAM, GROUP_MAM, GROUP_MAM, GROUP_JJA,
+                                             GROUP_JJA, GROUP_JJA, GROUP_SON, GROUP_SON, GROUP_SON, GROUP_DEC};
+
+} // namespace
+
+template <typename T>
+void aggregateMonths(const T* const months[MONTHS_PER_YEAR], size_t stride, size_t rows, const int* years,
+                     const AggregationRules& rules, T* const aggregates[AGG_COUNT], size_t outStride) {
+    // Per-thread scratch: sum and valid count of each group, group-major
+    thread_local std::vector<double> sums, counts;
+    sums.assign(GROUP_COUNT * rows, 0.0);
+    counts.assign(GROUP_COUNT * rows, 0.0);
+
+    for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+        const T* column = months[m];
+        double* sum = &sums[GROUP_OF_MONTH[m] * rows];
+        double* count = &counts[GROUP_OF_MONTH[m] * rows];
+        for (size_t r = 0; r < rows; ++r) {
+            const double v = column[r * stride];
+            const bool valid = v == v;
+            sum[r] += valid ? v : 0.0;
+            count[r] += valid ? 1.0 : 0.0;
+        }
+    }
+
+    // December of the previous row, where that row is the previous year
+    double* previousSum = &sums[GROUP_PREVIOUS_DEC * rows];
+    double* previousCount = &counts[GROUP_PREVIOUS_DEC * rows];
+    const double* decemberSum = &sums[GROUP_DEC * rows];
+    const double* decemberCount = &counts[GROUP_DEC * rows];
+    for (size_t r = 1; r < rows; ++r) {
+        const bool follows = !years || years[r - 1] == years[r] - 1;
+        previousSum[r] = follows ? decemberSum[r - 1] : 0.0;
+        previousCount[r] = follows ? decemberCount[r - 1] : 0.0;
+    }
+
+    const double missing = std::numeric_limits<double>::quiet_NaN();
+    const double annualMinimum = rules.minAnnualMonths;
+    const double seasonMinimum = rules.minSeasonMonths;
+    auto group = [&](const std::vector<double>& values, int g) { return &values[g * rows]; };
+    const double *jfSum = group(sums, GROUP_JF), *jfCount = group(counts, GROUP_JF);
+    const double *mamSum = group(sums, GROUP_MAM), *mamCount = group(counts, GROUP_MAM);
+    const double *jjaSum = group(sums, GROUP_JJA), *jjaCount = group(counts, GROUP_JJA);
+    const double *sonSum = group(sums, GROUP_SON), *sonCount = group(counts, GROUP_SON);
+
+    T* jd = aggregates[AGG_JD];
+    T* dn = aggregates[AGG_DN];
+    T* djf = aggregates[AGG_DJF];
+    T* mam = aggregates[AGG_MAM];
+    T* jja = aggregates[AGG_JJA];
+    T* son = aggregates[AGG_SON];
+    for (size_t r = 0; r < rows; ++r) {
+        const double janNovSum = jfSum[r] + mamSum[r] + jjaSum[r] + sonSum[r];
+        const double janNovCount = jfCount[r] + mamCount[r] + jjaCount[r] + sonCount[r];
+        const double jdCount = janNovCount + decemberCount[r];
+        const double dnCount = janNovCount + previousCount[r];
+        const double djfCount = jfCount[r] + previousCount[r];
+
+        const size_t out = r * outStride;
+        jd[out] = static_cast<T>(jdCount >= annualMinimum ? (janNovSum + decemberSum[r]) / jdCount : missing);
+        dn[out] = static_cast<T>(dnCount >= annualMinimum ? (janNovSum + previousSum[r]) / dnCount : missing);
+        djf[out] = static_cast<T>(djfCount >= seasonMinimum ? (jfSum[r] + previousSum[r]) / djfCount : missing);
+        mam[out] = static_cast<T>(mamCount[r] >= seasonMinimum ? mamSum[r] / mamCount[r] : missing);
+        jja[out] = static_cast<T>(jjaCount[r] >= seasonMinimum ? jjaSum[r] / jjaCount[r] : missing);
+        son[out] = static_cast<T>(sonCount[r] >= seasonMinimum ? sonSum[r] / sonCount[r] : missing);
+    }
+}
+
+void computeAggregates(ClimateTable& table, const AggregationRules& rules) {
+    const double* months[MONTHS_PER_YEAR];
+    double* aggregates[AGG_COUNT];
+    for (int m = 0; m < MONTHS_PER_YEAR; ++m) months[m] = table.monthly[m].data();
+    for (int c = 0; c < AGG_COUNT; ++c) {
+        table.aggregates[c].resize(table.size());
+        aggregates[c] = table.aggregates[c].mutableData();
+    }
+    aggregateMonths(months, 1, table.size(), table.years.data(), rules, aggregates, 1);
+}
+
+bool deriveMissingAggregates(ClimateTable& table) {
+    if (table.empty()) {
+        return false;
+    }
+    for (const Column<double>& column : table.aggregates) {
+        for (double value : column) {
+            if (!isMissing(value)) return false;
+        }
+    }
+    computeAggregates(table, AggregationRules());
+    return true;
+}
+
+void aggregateField(const GriddedField& field, const AggregationRules& rules, ThreadPool& pool,
+                    std::vector<float>& aggregates) {
+    const size_t years = field.years();
+    aggregates.resize(field.cells() * years * AGG_COUNT);
+
+    pool.parallelFor(0, field.cells(), 16, [&](size_t first, size_t last) {
+        thread_local std::vector<float> padded;
+        for (size_t cell = first; cell < last; ++cell) {
+            // A cell's series is year-major already, unless the last year is partial
+            const float* series = field.series(cell);
+            if (field.months % MONTHS_PER_YEAR != 0) {
+                padded.assign(series, series + field.months);
+                padded.resize(years * MONTHS_PER_YEAR, std::numeric_limits<float>::quiet_NaN());
+                series = padded.data();
+            }
+
+            const float* months[MONTHS_PER_YEAR];
+            float* out[AGG_COUNT];
+            for (int m = 0; m < MONTHS_PER_YEAR; ++m) months[m] = series + m;
+            for (int c = 0; c < AGG_COUNT; ++c) out[c] = &aggregates[cell * years * AGG_COUNT + c];
+            aggregateMonths(months, MONTHS_PER_YEAR, years, nullptr, rules, out, AGG_COUNT);
+        }
+    });
+}
+
+template void aggregateMonths<float>(const float* const[MONTHS_PER_YEAR], size_t, size_t, const int*,
+                                     const AggregationRules&, float* const[AGG_COUNT], size_t);
+template void aggregateMonths<double>(const double* const[MONTHS_PER_YEAR], size_t, size_t, const int*,
+                                      const AggregationRules&, double* const[AGG_COUNT], size_t);
@@ -0,0 +1,46 @@
+#ifndef AGGREGATION_H
+#define AGGREGATION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "climate_table.h"
+
+class ThreadPool;
+struct GriddedField;
+
+// Minimum number of valid months behind an aggregate; with fewer the
+// aggregate is missing. The defaults require every month, which reproduces
+// the "***" cells of a published GISTEMP table.
+struct AggregationRules {
+    int minAnnualMonths = 12; // J-D and D-N, out of 12
+    int minSeasonMonths = 3;  // DJF, MAM, JJA and SON, out of 3
+};
+
+// Function to compute the six aggregate columns (J-D, D-N, DJF, MAM, JJA,
+// SON) of rows of monthly values. Month m of row r is months[m][r * stride]
+// and aggregate c of row r is written to aggregates[c][r * outStride]. D-N
+// and DJF take December from the previous row, and are missing for the first
+// row or, when years is given, when the previous row is not the previous
+// year. Each aggregate is built from whole-column passes over the rows with
+// no branches, so the passes vectorize.
+template <typename T>
+void aggregateMonths(const T* const months[MONTHS_PER_YEAR], size_t stride, size_t rows, const int* years,
+                     const AggregationRules& rules, T* const aggregates[AGG_COUNT], size_t outStride);
+
+// Function to recompute every aggregate column of a table from its months
+void computeAggregates(ClimateTable& table, const AggregationRules& rules);
+
+// Function to derive the aggregate columns of a monthly-only table (one
+// whose aggregate cells are all missing); other tables are left alone.
+// Returns true if the aggregates were derived.
+bool deriveMissingAggregates(ClimateTable& table);
+
+// Function to compute the aggregates of every cell of a monthly field, in
+// parallel over cells. Aggregate c of year y of a cell is
+// aggregates[(cell * years + y) * AGG_COUNT + c]; a trailing partial year
+// counts its missing months as missing.
+void aggregateField(const GriddedField& field, const AggregationRules& rules, ThreadPool& pool,
+                    std::vector<float>& aggregates);
+
+#endif // AGGREGATION_H
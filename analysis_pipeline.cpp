@@ -0,0 +1,130 @@
+#include "analysis_pipeline.h"
+
+AnalysisPipeline::AnalysisPipeline(const ClimateTable& table, const ResamplingOptions& resampling, ThreadPool* pool)
+    : table_(table), resampling_(resampling), pool_(pool) {
+}
+
+template <typename T, typename Compute>
+const T& AnalysisPipeline::get(const Stage<T>& stage, Compute compute) const {
+    std::call_once(stage.once, [&] {
+        compute(stage.value);
+        ++stagesRun_;
+    });
+    return stage.value;
+}
+
+const RecordSet& AnalysisPipeline::records() const {
+    return get(records_, [&](RecordSet& records) {
+        computeRecords(table_, records);
+    });
+}
+
+const std::array<RegressionResult, MONTHS_PER_YEAR>& AnalysisPipeline::gapRegressions() const {
+    return get(gapRegressions_, [&](std::array<RegressionResult, MONTHS_PER_YEAR>& fits) {
+        const RecordSet& set = records();
+        for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+            fits[month] = linearRegression(set.months[month].gapyears, set.months[month].gapsizes);
+        }
+    });
+}
+
+const std::array<RegressionResult, MONTHS_PER_YEAR>& AnalysisPipeline::monthlyTrends() const {
+    return get(monthlyTrends_, [&](std::array<RegressionResult, MONTHS_PER_YEAR>& fits) {
+        const std::vector<double> years(table_.years.begin(), table_.years.end());
+        for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+            fits[month] = linearRegression(years.data(), table_.month(month).data(), table_.size());
+        }
+    });
+}
+
+const std::array<WarmCoolSlopes, MONTHS_PER_YEAR>& AnalysisPipeline::warmCoolSlopes() const {
+    return get(warmCoolSlopes_, [&](std::array<WarmCoolSlopes, MONTHS_PER_YEAR>& slopes) {
+        computeWarmCoolSlopes(table_, records(), monthlyTrends().data(), slopes.data());
+        computeWarmCoolIntervals(table_, records(), resampling_, pool_, slopes.data());
+    });
+}
+
+const AnnualSeries& AnalysisPipeline::jdSeries() const {
+    return get(jdSeries_, [&](AnnualSeries& series) {
+        // Years without a J-D average are left out of the trends
+        const Column<double>& jd = table_.aggregate(AGG_JD);
+        for (size_t i = 0; i < table_.size(); ++i) {
+            if (!isMissing(jd[i])) {
+                series.years.push_back(table_.years[i]);
+                series.values.push_back(jd[i]);
+            }
+        }
+    });
+}
+
+const RegressionResult& AnalysisPipeline::overallTrend() const {
+    return get(overallTrend_, [&](RegressionResult& fit) {
+        fit = linearRegression(jdSeries().years, jdSeries().values);
+    });
+}
+
+const SlopeInterval& AnalysisPipeline::overallInterval() const {
+    return get(overallInterval_, [&](SlopeInterval& interval) {
+        const AnnualSeries& series = jdSeries();
+        interval = bootstrapSlope(series.years.data(), series.values.data(), series.years.size(), resampling_, 0,
+                                  pool_);
+    });
+}
+
+const std::vector<DecadeTrend>& AnalysisPipeline::decadeTrends() const {
+    return get(decadeTrends_, [&](std::vector<DecadeTrend>& trends) {
+        const AnnualSeries& series = jdSeries();
+        trends = computeDecadeTrends(series.years, series.values);
+        computeDecadeIntervals(series.years, series.values, resampling_, 1, pool_, trends);
+    });
+}
+
+const ChangepointResult& AnalysisPipeline::jdChangepoints() const {
+    return get(jdChangepoints_, [&](ChangepointResult& result) {
+        const AnnualSeries& series = jdSeries();
+        result = detectChangepoints(series.years.data(), series.values.data(), series.years.size(), 1,
+                                    ChangepointOptions());
+    });
+}
+
+const std::array<ChangepointResult, MONTHS_PER_YEAR>& AnalysisPipeline::monthlyChangepoints() const {
+    return get(monthlyChangepoints_, [&](std::array<ChangepointResult, MONTHS_PER_YEAR>& results) {
+        const std::vector<double> years(table_.years.begin(), table_.years.end());
+        for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+            results[month] = detectChangepoints(years.data(), table_.month(month).data(), table_.size(), 1,
+                                                ChangepointOptions());
+        }
+    });
+}
+
+const std::array<RobustTrend, MONTHS_PER_YEAR>& AnalysisPipeline::robustGapTrends() const {
+    return get(robustGapTrends_, [&](std::array<RobustTrend, MONTHS_PER_YEAR>& trends) {
+        const RecordSet& set = records();
+        for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+            trends[month] = theilSen(set.months[month].gapyears, set.months[month].gapsizes, resampling_.confidence);
+        }
+    });
+}
+
+const std::array<RobustTrend, MONTHS_PER_YEAR>& AnalysisPipeline::robustMonthlyTrends() const {
+    return get(robustMonthlyTrends_, [&](std::array<RobustTrend, MONTHS_PER_YEAR>& trends) {
+        // The twelve calendar months of the monthly stream, one batch across the pool
+        std::vector<double> time, values;
+        monthlyTimeSeries(table_, time, values);
+        const std::vector<double> years(table_.years.begin(), table_.years.end());
+        theilSenBatch(years.data(), years.size(), values.data(), 1, MONTHS_PER_YEAR, MONTHS_PER_YEAR, trends.data(),
+                      pool_, resampling_.confidence);
+    });
+}
+
+const RobustTrend& AnalysisPipeline::robustOverallTrend() const {
+    return get(robustOverallTrend_, [&](RobustTrend& trend) {
+        trend = theilSen(jdSeries().years, jdSeries().values, resampling_.confidence);
+    });
+}
+
+const std::vector<RobustDecadeTrend>& AnalysisPipeline::robustDecadeTrends() const {
+    return get(robustDecadeTrends_, [&](std::vector<RobustDecadeTrend>& trends) {
+        trends = computeRobustDecadeTrends(jdSeries().years, jdSeries().values, resampling_.confidence);
+    });
+}
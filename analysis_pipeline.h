@@ -0,0 +1,126 @@
+#ifndef ANALYSIS_PIPELINE_H
+#define ANALYSIS_PIPELINE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "changepoint.h"
+#include "climate_analysis.h"
+#include "climate_table.h"
+#include "record_engine.h"
+#include "regression.h"
+#include "resampling.h"
+#include "robust_trend.h"
+
+class ThreadPool;
+
+// Years with a J-D average and their averages, the input of the J-D trends
+struct AnnualSeries {
+    std::vector<double> years;
+    std::vector<double> values;
+};
+
+// The intermediates the reports share, computed lazily from one table. Each
+// stage reads only the stages it depends on:
+//
+//   table -+- records ---------------+- gap regressions
+//          |                         +- warm/cool slopes and intervals
+//          |                         +- robust gap trends
+//          +- monthly trends --------+  (also the stationarity fits)
+//          +- robust monthly trends
+//          +- monthly changepoints
+//          +- J-D series -+- overall trend
+//                         +- overall trend interval
+//                         +- decade trends and intervals
+//                         +- robust overall and decade trends
+//                         +- J-D changepoints
+//
+// A stage runs the first time it is asked for and never again; concurrent
+// callers wait for that first run and then share its result. Stages depend
+// only on the table and the resampling options, so one pipeline serves a
+// dataset version for as long as the table lives and is not modified.
+// Running every report through one pipeline costs the union of their
+// stages, not the sum.
+class AnalysisPipeline {
+public:
+    // The table must outlive the pipeline and not change while it is used
+    AnalysisPipeline(const ClimateTable& table, const ResamplingOptions& resampling, ThreadPool* pool = nullptr);
+
+    AnalysisPipeline(const AnalysisPipeline&) = delete;
+    AnalysisPipeline& operator=(const AnalysisPipeline&) = delete;
+
+    const ClimateTable& table() const { return table_; }
+    const ResamplingOptions& resampling() const { return resampling_; }
+    ThreadPool* pool() const { return pool_; }
+
+    // Running records and record gaps of each month
+    const RecordSet& records() const;
+    // Regression of gap size on gap start year, per month
+    const std::array<RegressionResult, MONTHS_PER_YEAR>& gapRegressions() const;
+    // Regression of each month's anomalies on the year
+    const std::array<RegressionResult, MONTHS_PER_YEAR>& monthlyTrends() const;
+    // Both warm/cool slopes and the bootstrap interval of their difference;
+    // month m uses resampling stream m
+    const std::array<WarmCoolSlopes, MONTHS_PER_YEAR>& warmCoolSlopes() const;
+
+    const AnnualSeries& jdSeries() const;
+    // Regression of J-D on the year, and its bootstrap interval (stream 0)
+    const RegressionResult& overallTrend() const;
+    const SlopeInterval& overallInterval() const;
+    // Trend and bootstrap interval of every calendar decade (streams 1, 2, ...)
+    const std::vector<DecadeTrend>& decadeTrends() const;
+
+    // Segments of constant trend (ChangepointOptions defaults) of the J-D
+    // series and of each month's series
+    const ChangepointResult& jdChangepoints() const;
+    const std::array<ChangepointResult, MONTHS_PER_YEAR>& monthlyChangepoints() const;
+
+    // Theil-Sen lines and Mann-Kendall tests, with slope intervals at the
+    // resampling confidence: of gap size on gap start year and of the
+    // anomalies on the year per month, of J-D, and of each calendar decade
+    // of J-D
+    const std::array<RobustTrend, MONTHS_PER_YEAR>& robustGapTrends() const;
+    const std::array<RobustTrend, MONTHS_PER_YEAR>& robustMonthlyTrends() const;
+    const RobustTrend& robustOverallTrend() const;
+    const std::vector<RobustDecadeTrend>& robustDecadeTrends() const;
+
+    // Function to return how many stages have run so far
+    size_t stagesRun() const { return stagesRun_.load(); }
+
+private:
+    // One memoized result; value is written once, inside the call_once
+    template <typename T>
+    struct Stage {
+        mutable std::once_flag once;
+        mutable T value;
+    };
+
+    // Function to run a stage's computation on its first use
+    template <typename T, typename Compute>
+    const T& get(const Stage<T>& stage, Compute compute) const;
+
+    const ClimateTable& table_;
+    ResamplingOptions resampling_;
+    ThreadPool* pool_;
+    mutable std::atomic<size_t> stagesRun_{0};
+
+    Stage<RecordSet> records_;
+    Stage<std::array<RegressionResult, MONTHS_PER_YEAR>> gapRegressions_;
+    Stage<std::array<RegressionResult, MONTHS_PER_YEAR>> monthlyTrends_;
+    Stage<std::array<WarmCoolSlopes, MONTHS_PER_YEAR>> warmCoolSlopes_;
+    Stage<AnnualSeries> jdSeries_;
+    Stage<RegressionResult> overallTrend_;
+    Stage<SlopeInterval> overallInterval_;
+    Stage<std::vector<DecadeTrend>> decadeTrends_;
+    Stage<ChangepointResult> jdChangepoints_;
+    Stage<std::array<ChangepointResult, MONTHS_PER_YEAR>> monthlyChangepoints_;
+    Stage<std::array<RobustTrend, MONTHS_PER_YEAR>> robustGapTrends_;
+    Stage<std::array<RobustTrend, MONTHS_PER_YEAR>> robustMonthlyTrends_;
+    Stage<RobustTrend> robustOverallTrend_;
+    Stage<std::vector<RobustDecadeTrend>> robustDecadeTrends_;
+};
+
+#endif // ANALYSIS_PIPELINE_H
@@ -0,0 +1,264 @@
+#include "analysis_service.h"
+
+#include <cstdlib>
+#include <sstream>
+
+#include "climate_reports.h"
+#include "parallel_ingest.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Memoized reports kept per dataset version before the memo is emptied
+const size_t MAX_RESPONSES = 256;
+
+bool isReport(const std::string& command) {
+    static const char* const REPORTS[] = {"gaps",     "regression", "warmcool", "trends",
+                                          "seasonal", "extremes",   "sweep",    "stationarity",
+                                          "changepoints", "spectrum", "robust"};
+    for (const char* report : REPORTS) {
+        if (command == report) return true;
+    }
+    return false;
+}
+
+// Function to parse a whole word as an int
+bool parseInt(const std::string& word, int& value) {
+    char* end;
+    value = static_cast<int>(std::strtol(word.c_str(), &end, 10));
+    return !word.empty() && *end == '\0';
+}
+
+void describe(const DatasetSnapshot& dataset, std::ostream& out) {
+    out << dataset.name << " " << dataset.filename << " rows " << dataset.table.size();
+    if (!dataset.table.empty()) {
+        out << " years " << dataset.table.years[0] << "-" << dataset.table.years.back();
+    }
+    out << " generation " << dataset.generation << "\n";
+}
+
+} // namespace
+
+AnalysisService::AnalysisService(ThreadPool& pool, const ResamplingOptions& resampling)
+    : pool_(pool), resampling_(resampling) {
+}
+
+bool AnalysisService::load(const std::string& name, const std::string& filename, size_t generation,
+                           std::shared_ptr<DatasetSnapshot>& snapshot, std::string& error) {
+    snapshot = std::make_shared<DatasetSnapshot>();
+    snapshot->name = name;
+    snapshot->filename = filename;
+    snapshot->generation = generation;
+    if (!stampSource(filename, snapshot->stamp, error)) {
+        return false;
+    }
+
+    IngestReport report;
+    if (!loadClimateTable(filename, pool_, IngestOptions(), snapshot->table, report, error)) {
+        return false;
+    }
+    snapshot->pipeline = std::make_unique<AnalysisPipeline>(snapshot->table, resampling_, &pool_);
+    if (!snapshot->index.build(snapshot->table, error)) {
+        error = filename + ": " + error;
+        return false;
+    }
+
+    // A file rewritten while it was read is picked up again on the next check
+    SourceStamp after;
+    if (!stampSource(filename, after, error)) {
+        return false;
+    }
+    if (after.size != snapshot->stamp.size || after.mtimeNs != snapshot->stamp.mtimeNs ||
+        after.hash != snapshot->stamp.hash) {
+        error = filename + " changed while it was loaded";
+        return false;
+    }
+    return true;
+}
+
+bool AnalysisService::addDataset(const std::string& name, const std::string& filename, std::string& error) {
+    std::shared_ptr<DatasetSnapshot> loaded;
+    if (!load(name, filename, 1, loaded, error)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (datasets_.count(name)) {
+        error = "duplicate dataset name: " + name;
+        return false;
+    }
+    names_.push_back(name);
+    datasets_[name] = std::move(loaded);
+    return true;
+}
+
+size_t AnalysisService::reloadChanged(std::ostream& log) {
+    std::vector<std::shared_ptr<const DatasetSnapshot>> current;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::string& name : names_) current.push_back(datasets_[name]);
+    }
+
+    size_t swapped = 0;
+    for (const auto& dataset : current) {
+        SourceStamp stamp;
+        std::string error;
+        if (!stampSource(dataset->filename, stamp, error)) {
+            log << dataset->name << ": " << error << "; keeping generation " << dataset->generation << "\n";
+            continue;
+        }
+        if (stamp.size == dataset->stamp.size && stamp.mtimeNs == dataset->stamp.mtimeNs &&
+            stamp.hash == dataset->stamp.hash) {
+            continue;
+        }
+
+        std::shared_ptr<DatasetSnapshot> loaded;
+        if (!load(dataset->name, dataset->filename, dataset->generation + 1, loaded, error)) {
+            log << dataset->name << ": " << error << "; keeping generation " << dataset->generation << "\n";
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        datasets_[dataset->name] = std::move(loaded);
+        ++swapped;
+        log << dataset->name << ": reloaded " << dataset->filename << " as generation " << dataset->generation + 1
+            << "\n";
+    }
+    return swapped;
+}
+
+std::shared_ptr<const DatasetSnapshot> AnalysisService::snapshot(const std::string& name) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (name.empty()) {
+        return names_.empty() ? nullptr : datasets_.at(names_.front());
+    }
+    auto found = datasets_.find(name);
+    return found == datasets_.end() ? nullptr : found->second;
+}
+
+bool AnalysisService::handle(const std::string& request, std::string& response) {
+    std::istringstream in(request);
+    std::vector<std::string> words;
+    for (std::string word; in >> word;) words.push_back(word);
+
+    std::string name;
+    if (!words.empty() && words[0][0] == '@') {
+        name = words[0].substr(1);
+        words.erase(words.begin());
+    }
+    if (words.empty()) {
+        response = "empty request";
+        return false;
+    }
+    const std::string& command = words[0];
+
+    if (command == "ping") {
+        response = "pong\n";
+        return true;
+    }
+    if (command == "datasets") {
+        std::vector<std::shared_ptr<const DatasetSnapshot>> all;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (const std::string& n : names_) all.push_back(datasets_.at(n));
+        }
+        std::ostringstream out;
+        for (const auto& dataset : all) describe(*dataset, out);
+        response = out.str();
+        return true;
+    }
+
+    // Pin one version of the dataset for the whole request
+    std::shared_ptr<const DatasetSnapshot> dataset = snapshot(name);
+    if (!dataset) {
+        response = "unknown dataset: " + name;
+        return false;
+    }
+
+    std::ostringstream out;
+    if (command == "info") {
+        describe(*dataset, out);
+        response = out.str();
+        return true;
+    }
+    if (command == "query") {
+        std::string query;
+        for (size_t i = 1; i < words.size(); ++i) query += (i > 1 ? " " : "") + words[i];
+        if (!runRangeQuery(dataset->index, query, out)) {
+            response = "invalid query: " + query;
+            return false;
+        }
+        response = out.str();
+        return true;
+    }
+    if (!isReport(command)) {
+        response = "unknown command: " + command;
+        return false;
+    }
+
+    std::string key = command;
+    for (size_t i = 1; i < words.size(); ++i) key += " " + words[i];
+    {
+        std::lock_guard<std::mutex> lock(dataset->responseMutex);
+        auto found = dataset->responses.find(key);
+        if (found != dataset->responses.end()) {
+            response = found->second;
+            return true;
+        }
+    }
+
+    const ClimateTable& table = dataset->table;
+    const AnalysisPipeline& pipeline = *dataset->pipeline;
+    const size_t argumentCount = words.size() - 1;
+    if (command == "gaps" && argumentCount == 0) {
+        printRecordGaps(pipeline.records(), out);
+    } else if (command == "regression" && argumentCount == 0) {
+        printGapRegressions(pipeline, out);
+    } else if (command == "warmcool" && argumentCount == 0) {
+        printWarmCoolAnalysis(pipeline, out);
+    } else if (command == "trends" && argumentCount == 0) {
+        std::string error;
+        printTrendAnalysis(pipeline, "", out, error);
+    } else if (command == "seasonal" && argumentCount == 0) {
+        printSeasonalAnalysis(pipeline, out);
+    } else if (command == "stationarity" && argumentCount == 0) {
+        printStationarityAnalysis(pipeline, out);
+    } else if (command == "changepoints" && argumentCount == 0) {
+        printChangepointAnalysis(pipeline, out);
+    } else if (command == "spectrum" && argumentCount == 0) {
+        printSpectralAnalysis(pipeline, out);
+    } else if (command == "robust" && argumentCount == 0) {
+        printRobustTrendAnalysis(pipeline, out);
+    } else if (command == "extremes" && argumentCount <= 2) {
+        int threshold = 3;
+        std::vector<double> amplitude;
+        bool valid = argumentCount < 1 || (parseInt(words[1], threshold) && threshold >= 1);
+        if (valid && argumentCount == 2) {
+            valid = parseAmplitudes(words[2], amplitude) && amplitude.size() == 1;
+        }
+        if (!valid) {
+            response = "usage: extremes [threshold [amplitude]]";
+            return false;
+        }
+        analyzeEventFrequencyDuration(table, threshold, amplitude.empty() ? 0.0 : amplitude[0], out);
+    } else if (command == "sweep" && argumentCount <= 2) {
+        std::vector<double> amplitudes;
+        int maxDuration = 24;
+        if ((argumentCount >= 1 && (!parseAmplitudes(words[1], amplitudes) || amplitudes.empty())) ||
+            (argumentCount == 2 && (!parseInt(words[2], maxDuration) || maxDuration < 1))) {
+            response = "usage: sweep [amplitudes [maxDuration]]";
+            return false;
+        }
+        if (amplitudes.empty()) amplitudes.push_back(0.0);
+        printThresholdSweep(table, amplitudes, maxDuration, out);
+    } else {
+        response = command + " takes no arguments";
+        return false;
+    }
+
+    response = out.str();
+    std::lock_guard<std::mutex> lock(dataset->responseMutex);
+    if (dataset->responses.size() >= MAX_RESPONSES) dataset->responses.clear();
+    dataset->responses.emplace(key, response);
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef ANALYSIS_SERVICE_H
+#define ANALYSIS_SERVICE_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "analysis_pipeline.h"
+#include "climate_table.h"
+#include "range_index.h"
+#include "resampling.h"
+#include "table_cache.h"
+
+class ThreadPool;
+
+// One loaded dataset and everything derived from it. A snapshot never
+// changes once published: a reload builds a new one and swaps the pointer,
+// so requests that started on the old version finish on it.
+struct DatasetSnapshot {
+    std::string name;
+    std::string filename;
+    SourceStamp stamp;
+    size_t generation = 0; // 1 for the first load, +1 per reload
+    ClimateTable table;
+    RangeIndex index;
+    std::unique_ptr<AnalysisPipeline> pipeline; // stages shared by this version's reports
+
+    // Report text already produced for this version, by request
+    mutable std::mutex responseMutex;
+    mutable std::map<std::string, std::string> responses;
+};
+
+// Requests understood by AnalysisService::handle. A request is one line of
+// whitespace-separated words: an optional "@name" selecting a dataset (the
+// first one added by default), a command and its arguments.
+//
+//   ping                          liveness check, answers "pong"
+//   datasets                      name, file, rows and generation of each dataset
+//   info                          the same for the selected dataset
+//   gaps | regression | warmcool | trends | seasonal | stationarity | changepoints | spectrum | robust
+//                                 the report of the climate command of that name
+//   extremes [threshold [amplitude]]
+//   sweep [amplitudes [maxDuration]]
+//   query COLUMN FIRST [LAST]     range query, as climate_query
+//
+// Report text is memoized per dataset version, so a repeated request only
+// costs the lookup, and different reports of one version share their
+// intermediate stages through the version's pipeline.
+class AnalysisService {
+public:
+    AnalysisService(ThreadPool& pool, const ResamplingOptions& resampling);
+
+    // Function to load a dataset under a name; fails if the file cannot be loaded
+    bool addDataset(const std::string& name, const std::string& filename, std::string& error);
+
+    // Function to reload every dataset whose source file changed and swap it
+    // in; a dataset that fails to reload keeps its current version. Returns
+    // the number of datasets swapped.
+    size_t reloadChanged(std::ostream& log);
+
+    // Function to answer one request. Returns false with an error message in
+    // response when the request is invalid.
+    bool handle(const std::string& request, std::string& response);
+
+    // Function to return the current version of a dataset ("" for the
+    // default), or null if there is no such dataset
+    std::shared_ptr<const DatasetSnapshot> snapshot(const std::string& name) const;
+
+private:
+    bool load(const std::string& name, const std::string& filename, size_t generation,
+              std::shared_ptr<DatasetSnapshot>& snapshot, std::string& error);
+
+    ThreadPool& pool_;
+    ResamplingOptions resampling_;
+
+    mutable std::mutex mutex_; // guards the pointers below, never held while analyzing
+    std::vector<std::string> names_;
+    std::map<std::string, std::shared_ptr<const DatasetSnapshot>> datasets_;
+};
+
+#endif // ANALYSIS_SERVICE_H
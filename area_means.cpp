@@ -0,0 +1,175 @@
+#include "area_means.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+#include "gridded_field.h"
+#include "packed_anomaly.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Months reduced together; a block's row sums stay in cache
+const size_t MONTH_BLOCK = 256;
+
+// Validity and scale of one stored value, so one kernel serves both fields
+inline bool cellValid(float value) { return value == value; }
+inline bool cellValid(std::int16_t value) { return value != PACKED_MISSING; }
+inline double valueScale(const GriddedField&) { return 1.0; }
+inline double valueScale(const PackedField&) { return 1.0 / PACKED_SCALE; }
+
+// Function to add one cell's months [t0, t0 + length) to its row sums, with
+// no branches so the loop vectorizes
+template <typename T>
+void accumulateCell(const T* series, size_t length, double* sum, double* count) {
+    for (size_t t = 0; t < length; ++t) {
+        const bool valid = cellValid(series[t]);
+        sum[t] += valid ? static_cast<double>(series[t]) : 0.0;
+        count[t] += valid ? 1.0 : 0.0;
+    }
+}
+
+bool inRegion(const MeanRegion& region, double latitude) {
+    return latitude >= region.south && (latitude < region.north || region.north >= 90.0);
+}
+
+// Function to append one cell, "***" for NaN
+void appendCell(std::string& out, double value) {
+    if (std::isnan(value)) {
+        out += ",***";
+        return;
+    }
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), ",%.2f", value);
+    out.append(buffer, length);
+}
+
+} // namespace
+
+std::vector<MeanRegion> standardRegions() {
+    return {
+        {"Glob", -90.0, 90.0},    {"NHem", 0.0, 90.0},      {"SHem", -90.0, 0.0},     {"24N-90N", 24.0, 90.0},
+        {"24S-24N", -24.0, 24.0}, {"90S-24S", -90.0, -24.0}, {"64N-90N", 64.0, 90.0},  {"44N-64N", 44.0, 64.0},
+        {"24N-44N", 24.0, 44.0},  {"EQU-24N", 0.0, 24.0},    {"24S-EQU", -24.0, 0.0},  {"44S-24S", -44.0, -24.0},
+        {"64S-44S", -64.0, -44.0}, {"90S-64S", -90.0, -64.0},
+    };
+}
+
+template <typename Field>
+void areaMeans(const Field& field, const std::vector<MeanRegion>& regions, const AreaMeanOptions& options,
+               ThreadPool& pool, std::vector<ClimateTable>& tables) {
+    const size_t months = static_cast<size_t>(field.months);
+    const size_t regionCount = regions.size();
+
+    // Row weights, the regions of each row and each region's full weight
+    std::vector<double> rowWeight(field.nlat);
+    std::vector<std::vector<size_t>> rowRegions(field.nlat);
+    std::vector<double> fullWeight(regionCount, 0.0);
+    for (int lat = 0; lat < field.nlat; ++lat) {
+        const double latitude = field.latitude(lat);
+        rowWeight[lat] = std::cos(latitude * M_PI / 180.0);
+        for (size_t r = 0; r < regionCount; ++r) {
+            if (inRegion(regions[r], latitude)) {
+                rowRegions[lat].push_back(r);
+                fullWeight[r] += rowWeight[lat] * field.nlon;
+            }
+        }
+    }
+
+    // Weighted sums and valid weights of region r at month t, at r * months + t
+    std::vector<double> regionSum(regionCount * months, 0.0);
+    std::vector<double> regionWeight(regionCount * months, 0.0);
+    const size_t blocks = (months + MONTH_BLOCK - 1) / MONTH_BLOCK;
+    pool.parallelFor(0, blocks, 1, [&](size_t firstBlock, size_t lastBlock) {
+        thread_local std::vector<double> rowSum, rowCount;
+        for (size_t block = firstBlock; block < lastBlock; ++block) {
+            const size_t t0 = block * MONTH_BLOCK;
+            const size_t length = std::min(MONTH_BLOCK, months - t0);
+            for (int lat = 0; lat < field.nlat; ++lat) {
+                rowSum.assign(length, 0.0);
+                rowCount.assign(length, 0.0);
+                for (int lon = 0; lon < field.nlon; ++lon) {
+                    const size_t cell = static_cast<size_t>(lat) * field.nlon + lon;
+                    accumulateCell(field.series(cell) + t0, length, rowSum.data(), rowCount.data());
+                }
+
+                const double w = rowWeight[lat];
+                for (size_t r : rowRegions[lat]) {
+                    double* sum = &regionSum[r * months + t0];
+                    double* weight = &regionWeight[r * months + t0];
+                    for (size_t t = 0; t < length; ++t) {
+                        sum[t] += w * rowSum[t];
+                        weight[t] += w * rowCount[t];
+                    }
+                }
+            }
+        }
+    });
+
+    // One Global.csv-shaped table per region, the trailing partial year padded with missing months
+    const size_t years = static_cast<size_t>(field.years());
+    const double scale = valueScale(field);
+    tables.assign(regionCount, ClimateTable());
+    for (size_t r = 0; r < regionCount; ++r) {
+        ClimateTable& table = tables[r];
+        table.years.resize(years);
+        for (size_t y = 0; y < years; ++y) table.years.mutableData()[y] = field.startYear + static_cast<int>(y);
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            table.monthly[m].resize(years);
+            double* column = table.monthly[m].mutableData();
+            for (size_t y = 0; y < years; ++y) {
+                const size_t t = y * MONTHS_PER_YEAR + m;
+                const double weight = t < months ? regionWeight[r * months + t] : 0.0;
+                const bool covered = weight > 0.0 && weight >= options.minCoverage * fullWeight[r];
+                column[y] = covered ? scale * regionSum[r * months + t] / weight
+                                    : std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+
+        const double* monthColumns[MONTHS_PER_YEAR];
+        double* aggregateColumns[AGG_COUNT];
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) monthColumns[m] = table.monthly[m].data();
+        for (int c = 0; c < AGG_COUNT; ++c) {
+            table.aggregates[c].resize(years);
+            aggregateColumns[c] = table.aggregates[c].mutableData();
+        }
+        aggregateMonths(monthColumns, 1, years, table.years.data(), options.rules, aggregateColumns, 1);
+    }
+}
+
+bool writeClimateCsv(const ClimateTable& table, const std::string& title, const std::string& filename,
+                     std::string& error) {
+    std::string out;
+    out.reserve(table.size() * 120 + 256);
+    out += title + ",,,,,,,,,,,,,,,,,,\n";
+    out += "Year";
+    for (int m = 0; m < MONTHS_PER_YEAR; ++m) out += std::string(",") + monthName(m);
+    for (int c = 0; c < AGG_COUNT; ++c) out += std::string(",") + aggregateName(static_cast<AggregateColumn>(c));
+    out += "\n";
+    for (size_t i = 0; i < table.size(); ++i) {
+        out += std::to_string(table.years[i]);
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) appendCell(out, table.month(m)[i]);
+        for (int c = 0; c < AGG_COUNT; ++c) appendCell(out, table.aggregate(static_cast<AggregateColumn>(c))[i]);
+        out += "\n";
+    }
+
+    std::ofstream output_file(filename, std::ios::binary);
+    if (!output_file) {
+        error = "Error opening file: " + filename;
+        return false;
+    }
+    if (!output_file.write(out.data(), static_cast<std::streamsize>(out.size()))) {
+        error = "Error writing file: " + filename;
+        return false;
+    }
+    return true;
+}
+
+template void areaMeans<GriddedField>(const GriddedField&, const std::vector<MeanRegion>&, const AreaMeanOptions&,
+                                      ThreadPool&, std::vector<ClimateTable>&);
+template void areaMeans<PackedField>(const PackedField&, const std::vector<MeanRegion>&, const AreaMeanOptions&,
+                                     ThreadPool&, std::vector<ClimateTable>&);
@@ -0,0 +1,53 @@
+#ifndef AREA_MEANS_H
+#define AREA_MEANS_H
+
+#include <string>
+#include <vector>
+
+#include "aggregation.h"
+#include "climate_table.h"
+
+class ThreadPool;
+
+// A band of latitudes; a cell belongs to it when its centre latitude is in
+// [south, north), or [south, 90] for a band reaching the north pole
+struct MeanRegion {
+    std::string name;
+    double south;
+    double north;
+};
+
+// Function to return the regions of a GISTEMP zonal table: Glob, NHem, SHem,
+// the 24N-90N, 24S-24N and 90S-24S belts and the eight bands from 64N-90N
+// down to 90S-64S
+std::vector<MeanRegion> standardRegions();
+
+struct AreaMeanOptions {
+    // Fraction of a region's area that must have a value for the month's
+    // mean to be reported; 0 reports any month with a single valid cell
+    double minCoverage = 0.0;
+    AggregationRules rules; // for the J-D, D-N and seasonal columns
+};
+
+// Function to reduce a monthly field to area-weighted means, one table per
+// region with the same rows and columns as Global.csv. Each cell is
+// weighted by the cosine of its latitude, and each month's weights are
+// renormalized over the cells that have a value, so missing cells neither
+// pull the mean toward zero nor change what it means. A field with one
+// longitude holds zonal means and reduces the same way.
+//
+// The cells of a latitude row share one weight, so each row is summed first
+// (value and valid count per month, contiguous along every cell's series)
+// and regions then combine rows. Blocks of months run in parallel; the
+// result does not depend on the number of threads.
+template <typename Field>
+void areaMeans(const Field& field, const std::vector<MeanRegion>& regions, const AreaMeanOptions& options,
+               ThreadPool& pool, std::vector<ClimateTable>& tables);
+
+// Function to write a table as a GISTEMP CSV: the title line, the
+// Year,Jan,...,SON header and one row per year with two decimals and "***"
+// for missing values
+bool writeClimateCsv(const ClimateTable& table, const std::string& title, const std::string& filename,
+                     std::string& error);
+
+#endif // AREA_MEANS_H
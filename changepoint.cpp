@@ -0,0 +1,264 @@
+#include "changepoint.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace {
+
+enum PrefixSum { SUM_X = 0, SUM_Y, SUM_XX, SUM_YY, SUM_XY, SUM_COUNT };
+
+// Segment costs of a series of valid points in O(1) each, from compensated
+// prefix sums of the centered values (as in computeRollingTrends)
+class SegmentCosts {
+public:
+    void build(const std::vector<double>& x, const std::vector<double>& y) {
+        const size_t n = x.size();
+        centerX_ = 0.5 * (x.front() + x.back());
+        shiftY_ = y.front();
+        hi_.assign((n + 1) * SUM_COUNT, 0.0);
+        lo_.assign((n + 1) * SUM_COUNT, 0.0);
+        for (size_t i = 0; i < n; ++i) {
+            const double dx = x[i] - centerX_;
+            const double dy = y[i] - shiftY_;
+            const double terms[SUM_COUNT] = {dx, dy, dx * dx, dy * dy, dx * dy};
+            for (int k = 0; k < SUM_COUNT; ++k) {
+                // Knuth's TwoSum
+                const double previous = hi_[i * SUM_COUNT + k];
+                const double sum = previous + terms[k];
+                const double virtualTerm = sum - previous;
+                const double error = (previous - (sum - virtualTerm)) + (terms[k] - virtualTerm);
+                hi_[(i + 1) * SUM_COUNT + k] = sum;
+                lo_[(i + 1) * SUM_COUNT + k] = lo_[i * SUM_COUNT + k] + error;
+            }
+        }
+    }
+
+    // Function to return the centered co-moments of points [s, t)
+    void moments(size_t s, size_t t, double& c, double& mx, double& my, double& sxx, double& syy,
+                 double& sxy) const {
+        double sums[SUM_COUNT];
+        const double* hiS = &hi_[s * SUM_COUNT];
+        const double* hiT = &hi_[t * SUM_COUNT];
+        const double* loS = &lo_[s * SUM_COUNT];
+        const double* loT = &lo_[t * SUM_COUNT];
+        for (int k = 0; k < SUM_COUNT; ++k) sums[k] = (hiT[k] - hiS[k]) + (loT[k] - loS[k]);
+        c = static_cast<double>(t - s);
+        mx = sums[SUM_X] / c;
+        my = sums[SUM_Y] / c;
+        sxx = sums[SUM_XX] - sums[SUM_X] * mx;
+        syy = sums[SUM_YY] - sums[SUM_Y] * my;
+        sxy = sums[SUM_XY] - sums[SUM_X] * my;
+    }
+
+    // Function to return the residual sum of squares of points [s, t)
+    double cost(size_t s, size_t t, ChangeModel model) const {
+        double c, mx, my, sxx, syy, sxy;
+        moments(s, t, c, mx, my, sxx, syy, sxy);
+        double rss = syy;
+        if (model == CHANGE_TREND && sxx > 0.0) rss -= sxy * sxy / sxx;
+        return std::max(rss, 0.0);
+    }
+
+    void describe(size_t s, size_t t, ChangeSegment& segment) const {
+        double c, mx, my, sxx, syy, sxy;
+        moments(s, t, c, mx, my, sxx, syy, sxy);
+        segment.mean = my + shiftY_;
+        segment.fit = regressionFromMoments(c, mx + centerX_, my + shiftY_, sxx, syy, sxy);
+    }
+
+private:
+    double centerX_ = 0.0;
+    double shiftY_ = 0.0;
+    std::vector<double> hi_; // prefix i, sum k at i * SUM_COUNT + k
+    std::vector<double> lo_;
+};
+
+// Function to estimate the noise variance from the median absolute first
+// difference, which level shifts and trends barely move
+double noiseVariance(const std::vector<double>& y) {
+    thread_local std::vector<double> differences;
+    differences.clear();
+    for (size_t i = 1; i < y.size(); ++i) differences.push_back(std::fabs(y[i] - y[i - 1]));
+    if (differences.empty()) {
+        return 0.0;
+    }
+    const size_t middle = differences.size() / 2;
+    std::nth_element(differences.begin(), differences.begin() + middle, differences.end());
+    // For Gaussian noise of variance v a difference has variance 2v and its
+    // absolute value a median of 0.6745 * sqrt(2v)
+    const double sigma = differences[middle] / (0.6744897501960817 * std::sqrt(2.0));
+    if (sigma > 0.0) {
+        return sigma * sigma;
+    }
+
+    // Mostly repeated values: fall back to the mean squared difference
+    double sum = 0.0;
+    for (double difference : differences) sum += difference * difference;
+    return sum / (2.0 * differences.size());
+}
+
+// Function to find the optimal segment ends by PELT. Returns false when the
+// budget of cost evaluations runs out before the end of the series.
+//
+// A start s that fails best[s] + cost(s, t) <= best[t] is beaten by starting
+// at t instead, but only for ends that t can start a segment for, i.e. from
+// t + minSegment on. Until then s stays a candidate, so the pruning takes
+// effect minSegment steps late (as in the changepoint package for R).
+bool peltSegments(const SegmentCosts& costs, size_t n, size_t minSegment, double penalty, ChangeModel model,
+                  size_t budget, std::vector<size_t>& ends) {
+    const double infinity = std::numeric_limits<double>::infinity();
+    const size_t never = std::numeric_limits<size_t>::max();
+    thread_local std::vector<double> best;
+    thread_local std::vector<size_t> previous, candidates, prunedAt;
+    thread_local std::vector<double> candidateCosts;
+    best.assign(n + 1, infinity);
+    previous.assign(n + 1, 0);
+    candidates.assign(1, 0);
+    prunedAt.assign(1, never);
+    best[0] = -penalty;
+
+    size_t evaluations = 0;
+    for (size_t t = minSegment; t <= n; ++t) {
+        // The last point that can end a segment before t
+        if (t >= 2 * minSegment) {
+            candidates.push_back(t - minSegment);
+            prunedAt.push_back(never);
+        }
+
+        // Drop the starts pruned at least minSegment steps ago
+        size_t kept = 0;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (prunedAt[i] != never && prunedAt[i] + minSegment <= t) continue;
+            candidates[kept] = candidates[i];
+            prunedAt[kept] = prunedAt[i];
+            ++kept;
+        }
+        candidates.resize(kept);
+        prunedAt.resize(kept);
+
+        candidateCosts.resize(candidates.size());
+        double minimum = infinity;
+        size_t argmin = 0;
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            const size_t s = candidates[i];
+            candidateCosts[i] = best[s] + costs.cost(s, t, model);
+            if (candidateCosts[i] < minimum) {
+                minimum = candidateCosts[i];
+                argmin = s;
+            }
+        }
+        best[t] = minimum + penalty;
+        previous[t] = argmin;
+
+        // A start that cannot beat the optimum now never will, once t can start a segment
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (prunedAt[i] == never && candidateCosts[i] > best[t]) prunedAt[i] = t;
+        }
+
+        evaluations += candidateCosts.size();
+        if (budget > 0 && evaluations > budget) {
+            return false;
+        }
+    }
+
+    ends.clear();
+    for (size_t t = n; t > 0; t = previous[t]) ends.push_back(t);
+    std::reverse(ends.begin(), ends.end());
+    return true;
+}
+
+// Function to split greedily: each segment is cut where the cut lowers the
+// cost most, as long as that beats the penalty
+void binarySegments(const SegmentCosts& costs, size_t n, size_t minSegment, double penalty, ChangeModel model,
+                    std::vector<size_t>& ends) {
+    ends.assign(1, n);
+    std::vector<std::pair<size_t, size_t>> pending(1, std::make_pair(size_t(0), n));
+    while (!pending.empty()) {
+        const size_t a = pending.back().first, b = pending.back().second;
+        pending.pop_back();
+        if (b - a < 2 * minSegment) continue;
+
+        const double whole = costs.cost(a, b, model);
+        double bestGain = penalty;
+        size_t split = 0;
+        for (size_t s = a + minSegment; s + minSegment <= b; ++s) {
+            const double gain = whole - costs.cost(a, s, model) - costs.cost(s, b, model);
+            if (gain > bestGain) {
+                bestGain = gain;
+                split = s;
+            }
+        }
+        if (split == 0) continue;
+        ends.push_back(split);
+        pending.emplace_back(a, split);
+        pending.emplace_back(split, b);
+    }
+    std::sort(ends.begin(), ends.end());
+}
+
+} // namespace
+
+template <typename T>
+ChangepointResult detectChangepoints(const double* x, const T* y, size_t n, size_t stride,
+                                     const ChangepointOptions& options) {
+    ChangepointResult result;
+
+    // Valid points only, remembering where each came from
+    thread_local std::vector<double> validX, validY;
+    thread_local std::vector<size_t> index;
+    validX.clear();
+    validY.clear();
+    index.clear();
+    for (size_t i = 0; i < n; ++i) {
+        const double value = y[i * stride];
+        if (std::isnan(value)) continue;
+        validX.push_back(x[i]);
+        validY.push_back(value);
+        index.push_back(i);
+    }
+    const size_t valid = validX.size();
+    if (valid == 0) {
+        return result;
+    }
+
+    const size_t parameters = options.model == CHANGE_TREND ? 2 : 1;
+    const size_t minSegment = std::max<size_t>(options.minSegment > 0 ? options.minSegment : 3 * parameters, 1);
+    result.penalty = options.penalty > 0.0
+                         ? options.penalty
+                         : (parameters + 1) * std::log(static_cast<double>(valid)) * noiseVariance(validY);
+
+    thread_local SegmentCosts costs;
+    costs.build(validX, validY);
+
+    thread_local std::vector<size_t> ends;
+    const size_t budget = options.pruningBudget > 0 ? std::max<size_t>(options.pruningBudget * valid, 1 << 20) : 0;
+    result.method = options.method;
+    if (valid < 2 * minSegment) {
+        ends.assign(1, valid);
+    } else if (options.method != CHANGE_PELT ||
+               !peltSegments(costs, valid, minSegment, result.penalty, options.model, budget, ends)) {
+        result.method = CHANGE_BINARY_SEGMENTATION;
+        binarySegments(costs, valid, minSegment, result.penalty, options.model, ends);
+    }
+
+    result.cost = 0.0;
+    size_t start = 0;
+    for (size_t end : ends) {
+        ChangeSegment segment;
+        segment.first = index[start];
+        segment.last = index[end - 1] + 1;
+        segment.start = validX[start];
+        segment.end = validX[end - 1];
+        costs.describe(start, end, segment);
+        result.cost += costs.cost(start, end, options.model);
+        result.segments.push_back(segment);
+        start = end;
+    }
+    return result;
+}
+
+template ChangepointResult detectChangepoints<float>(const double*, const float*, size_t, size_t,
+                                                     const ChangepointOptions&);
+template ChangepointResult detectChangepoints<double>(const double*, const double*, size_t, size_t,
+                                                      const ChangepointOptions&);
@@ -0,0 +1,69 @@
+#ifndef CHANGEPOINT_H
+#define CHANGEPOINT_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "regression.h"
+
+// What stays fixed within a segment: its mean, or its line (level and slope)
+enum ChangeModel {
+    CHANGE_MEAN,
+    CHANGE_TREND
+};
+
+enum ChangeMethod {
+    CHANGE_PELT,                // exact penalized optimum, pruned (Killick, Fearnhead and Eckley 2012)
+    CHANGE_BINARY_SEGMENTATION  // greedy splits, O(n log n) whatever the data
+};
+
+struct ChangepointOptions {
+    ChangeModel model = CHANGE_TREND;
+    ChangeMethod method = CHANGE_PELT;
+    // Cost of each changepoint in residual sum of squares; 0 uses
+    // (parameters + 1) * log(n) * noise variance, with the noise variance
+    // estimated from the median absolute first difference (a BIC-style
+    // penalty that neither the level nor the trend of the series affects)
+    double penalty = 0.0;
+    // Fewest valid points in a segment; 0 uses 3 per segment parameter
+    size_t minSegment = 0;
+    // PELT switches to binary segmentation once it has evaluated this many
+    // segment costs per point (and at least 2^20 in all), which happens only
+    // when pruning fails: its work grows with n times the segment length, so
+    // long series with few changepoints approach O(n^2). 0 never switches.
+    size_t pruningBudget = 64;
+};
+
+// One segment of the piecewise fit, over the valid points with indices in
+// [first, last) of the input series
+struct ChangeSegment {
+    size_t first;
+    size_t last;
+    double start;        // x of the first and last valid point
+    double end;
+    double mean = NAN;
+    RegressionResult fit; // the segment's own line; its slope is the segment trend
+};
+
+struct ChangepointResult {
+    std::vector<ChangeSegment> segments; // in x order; changepoints are the starts of all but the first
+    ChangeMethod method = CHANGE_PELT;   // method that produced the segments
+    double penalty = NAN;                // penalty used
+    double cost = NAN;                   // residual sum of squares of the fit
+
+    size_t changepoints() const { return segments.empty() ? 0 : segments.size() - 1; }
+};
+
+// Function to split a series into segments of constant mean or trend,
+// minimizing the residual sum of squares plus a penalty per changepoint.
+// Value i is y[i * stride] at x[i], with x ascending; NaN values are
+// skipped. Segment costs come from compensated prefix sums, so each costs
+// O(1); PELT then runs in about linear time when the number of changepoints
+// grows with n, and binary segmentation in O(n log n). Each segment is fit
+// independently, so the piecewise line may jump at a changepoint.
+template <typename T>
+ChangepointResult detectChangepoints(const double* x, const T* y, size_t n, size_t stride,
+                                     const ChangepointOptions& options);
+
+#endif // CHANGEPOINT_H
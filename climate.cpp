@@ -0,0 +1,241 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+#include "aggregation.h"
+#include "analysis_pipeline.h"
+#include "climate_table.h"
+#include "record_engine.h"
+#include "climate_reports.h"
+#include "parallel_ingest.h"
+#include "resampling.h"
+#include "thread_pool.h"
+
+// Analyses the driver can run, in the order "all" runs them
+const char* const COMMANDS[] = {"gaps", "regression", "warmcool", "trends", "seasonal", "extremes", "sweep", "stationarity",
+                               "changepoints", "spectrum", "robust"};
+
+// Analyses that run only when named, since their output depends on their own options
+const char* const EXTRA_COMMANDS[] = {"rolling"};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <command>...\n"
+              << "Commands:\n"
+              << "  gaps        gaps between monthly records (parse_data)\n"
+              << "  regression  regression of record gaps per month (linear_regression)\n"
+              << "  warmcool    warming / cooling interpretation per month (global_warm_cool)\n"
+              << "  trends      overall and decade J-D trends (decade_trend_analysis)\n"
+              << "  seasonal    overall trend, monthly and yearly analysis (seasional_analysis)\n"
+              << "  extremes    heatwave and cold snap frequency (extreme_event_frequency)\n"
+              << "  sweep       event counts for every amplitude and minimum duration, as CSV\n"
+              << "  stationarity  OLS diagnostics and ADF unit root test per month (stats_test)\n"
+              << "  changepoints  segments of constant trend of J-D and of each month (PELT)\n"
+              << "  spectrum    ENSO, solar cycle and longer band variances, Welch spectrum, per-month ENSO share\n"
+              << "  robust      Theil-Sen slopes and Mann-Kendall tests of record gaps, months, J-D and decades\n"
+              << "  all         every analysis above, loading the dataset once\n"
+              << "  rolling     J-D (or monthly) trends in sliding windows; not part of all\n"
+              << "Options:\n"
+              << "  -i, --input FILE       dataset to analyze (default Global.csv)\n"
+              << "  -t, --threshold N      consecutiveMonthsThreshold for extremes (default 3)\n"
+              << "  -a, --amplitudes LIST  comma-separated anomaly thresholds for sweep; extremes uses\n"
+              << "                         the first (default 0)\n"
+              << "  -p, --percentiles U,L  extremes: a month is warm above the U-th and cold below the L-th\n"
+              << "                         percentile of its calendar month (e.g. 90,10) instead of +/-amplitude\n"
+              << "  --base FIRST,LAST      baseline years of the percentiles (default: every year)\n"
+              << "  --max-duration N       longest minimum duration swept, in months (default 24)\n"
+              << "  -j, --threads N        workers for parsing and resampling (default: all cores)\n"
+              << "  --errors FILE          write malformed rows as CSV instead of only counting them\n"
+              << "  --trend-csv FILE       where trends writes its CSV (default trend_analysis.csv)\n"
+              << "  --resamples N          bootstrap resamples and permutations per series (default 10000)\n"
+              << "  --seed N               seed of the resampling streams (default 1880)\n"
+              << "  --aggregate A,S        recompute J-D, D-N and the seasons from the months, each needing\n"
+              << "                         A of 12 (annual) or S of 3 (seasonal) valid months\n"
+              << "  --window W             rolling: window length in years (default 10)\n"
+              << "  --stride S             rolling: years between window starts (default 10)\n"
+              << "  --align A              rolling: start windows on multiples of A years (default: first year)\n"
+              << "  --monthly              rolling: fit the monthly series instead of J-D\n"
+              << "  --partial              rolling: keep trailing windows that run past the end of the data\n"
+              << "  --csv FILE             rolling: also write the windows as CSV\n";
+}
+
+bool isCommand(const std::string& name) {
+    for (const char* command : COMMANDS) {
+        if (name == command) return true;
+    }
+    for (const char* command : EXTRA_COMMANDS) {
+        if (name == command) return true;
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    std::string filename = "Global.csv";
+    std::string trendCsv = "trend_analysis.csv";
+    int consecutiveMonthsThreshold = 3;
+    std::vector<double> amplitudes;
+    int maxDuration = 24;
+    unsigned threads = 0;
+    std::string errorsCsv;
+    PercentileOptions percentiles;
+    bool percentileEvents = false;
+    ResamplingOptions resampling;
+    AggregationRules aggregation;
+    bool recomputeAggregates = false;
+    RollingTrendOptions rolling;
+    bool rollingMonthly = false;
+    std::string rollingCsv;
+    std::vector<std::string> commands;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-i" || arg == "--input") && i + 1 < argc) {
+            filename = argv[++i];
+        } else if ((arg == "-t" || arg == "--threshold") && i + 1 < argc) {
+            consecutiveMonthsThreshold = std::atoi(argv[++i]);
+        } else if ((arg == "-a" || arg == "--amplitudes") && i + 1 < argc) {
+            if (!parseAmplitudes(argv[++i], amplitudes)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if ((arg == "-p" || arg == "--percentiles") && i + 1 < argc) {
+            if (!parsePercentiles(argv[++i], percentiles)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            percentileEvents = true;
+        } else if (arg == "--base" && i + 1 < argc) {
+            if (!parseBaseYears(argv[++i], percentiles)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--max-duration" && i + 1 < argc) {
+            maxDuration = std::atoi(argv[++i]);
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--errors" && i + 1 < argc) {
+            errorsCsv = argv[++i];
+        } else if (arg == "--trend-csv" && i + 1 < argc) {
+            trendCsv = argv[++i];
+        } else if (arg == "--resamples" && i + 1 < argc) {
+            resampling.replicates = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            resampling.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--aggregate" && i + 1 < argc) {
+            char* end;
+            aggregation.minAnnualMonths = static_cast<int>(std::strtol(argv[++i], &end, 10));
+            aggregation.minSeasonMonths = *end == ',' ? static_cast<int>(std::strtol(end + 1, &end, 10)) : 0;
+            if (*end != '\0' || aggregation.minAnnualMonths < 1 || aggregation.minAnnualMonths > 12
+                || aggregation.minSeasonMonths < 1 || aggregation.minSeasonMonths > 3) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            recomputeAggregates = true;
+        } else if (arg == "--window" && i + 1 < argc) {
+            rolling.window = std::atof(argv[++i]);
+        } else if (arg == "--stride" && i + 1 < argc) {
+            rolling.stride = std::atof(argv[++i]);
+        } else if (arg == "--align" && i + 1 < argc) {
+            rolling.alignTo = std::atof(argv[++i]);
+        } else if (arg == "--monthly") {
+            rollingMonthly = true;
+        } else if (arg == "--partial") {
+            rolling.partialWindows = true;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            rollingCsv = argv[++i];
+        } else if (arg == "all") {
+            commands.insert(commands.end(), std::begin(COMMANDS), std::end(COMMANDS));
+        } else if (isCommand(arg)) {
+            commands.push_back(arg);
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (amplitudes.empty()) {
+        amplitudes.push_back(0.0);
+    }
+    if (commands.empty() || consecutiveMonthsThreshold < 1 || maxDuration < 1 || resampling.replicates < 2 ||
+        !(rolling.window > 0.0) || !(rolling.stride > 0.0) || rolling.alignTo < 0.0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Load once for every requested analysis; malformed rows are skipped and reported
+    ClimateTable table;
+    IngestReport report;
+    std::string error;
+    ThreadPool pool(threads);
+    if (!loadClimateTable(filename, pool, IngestOptions(), table, report, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (report.errorCount > 0) {
+        const RowError& first = report.errors.front();
+        std::cerr << filename << ": skipped " << report.errorCount << " malformed rows (first at line "
+                  << first.line << ": " << first.message << ")" << std::endl;
+    }
+    if (!errorsCsv.empty()) {
+        std::ofstream errorsFile(errorsCsv);
+        writeIngestReport(report, errorsFile);
+        if (!errorsFile.flush()) {
+            std::cerr << "Error writing file: " << errorsCsv << std::endl;
+            return 1;
+        }
+    }
+
+    if (recomputeAggregates) {
+        computeAggregates(table, aggregation);
+    }
+
+    // Intermediates shared between the analyses are built at most once
+    AnalysisPipeline pipeline(table, resampling, &pool);
+
+    for (size_t i = 0; i < commands.size(); ++i) {
+        const std::string& command = commands[i];
+        if (commands.size() > 1) {
+            std::cout << (i > 0 ? "\n" : "") << "== " << command << " ==\n";
+        }
+
+        if (command == "gaps") {
+            printRecordGaps(pipeline.records(), std::cout);
+        } else if (command == "regression") {
+            printGapRegressions(pipeline, std::cout);
+        } else if (command == "warmcool") {
+            printWarmCoolAnalysis(pipeline, std::cout);
+        } else if (command == "trends") {
+            if (!printTrendAnalysis(pipeline, trendCsv, std::cout, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        } else if (command == "seasonal") {
+            printSeasonalAnalysis(pipeline, std::cout);
+        } else if (command == "extremes") {
+            if (percentileEvents) {
+                MonthThresholds thresholds = percentileThresholds(table, percentiles);
+                printPercentileThresholds(thresholds, percentiles, std::cout);
+                analyzeEventFrequencyDuration(table, consecutiveMonthsThreshold, thresholds, std::cout);
+            } else {
+                analyzeEventFrequencyDuration(table, consecutiveMonthsThreshold, amplitudes[0], std::cout);
+            }
+        } else if (command == "sweep") {
+            printThresholdSweep(table, amplitudes, maxDuration, std::cout);
+        } else if (command == "stationarity") {
+            printStationarityAnalysis(pipeline, std::cout);
+        } else if (command == "changepoints") {
+            printChangepointAnalysis(pipeline, std::cout);
+        } else if (command == "spectrum") {
+            printSpectralAnalysis(pipeline, std::cout);
+        } else if (command == "robust") {
+            printRobustTrendAnalysis(pipeline, std::cout);
+        } else if (command == "rolling") {
+            if (!printRollingTrendAnalysis(table, rolling, rollingMonthly, rollingCsv, std::cout, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,158 @@
+#include "climate_analysis.h"
+
+#include <algorithm>
+
+#include "regression.h"
+#include "rolling_trend.h"
+
+std::vector<DecadeTrend> computeDecadeTrends(const std::vector<double>& years, const std::vector<double>& temps) {
+    RollingTrendOptions options;
+    options.window = 10.0;
+    options.stride = 10.0;
+    options.alignTo = 10.0;
+    options.partialWindows = true;
+
+    std::vector<DecadeTrend> trends;
+    for (const WindowTrend& window : computeRollingTrends(years, temps, options)) {
+        // Decades without data (e.g. a gap in the record) are left out
+        if (window.first == window.last) continue;
+        trends.push_back({static_cast<int>(window.start), window.fit.slope, window.fit.intercept});
+    }
+    return trends;
+}
+
+void computeDecadeIntervals(const std::vector<double>& years, const std::vector<double>& temps,
+                            const ResamplingOptions& options, std::uint64_t firstStream, ThreadPool* pool,
+                            std::vector<DecadeTrend>& trends) {
+    for (size_t i = 0; i < trends.size(); ++i) {
+        DecadeTrend& trend = trends[i];
+        const auto first = std::lower_bound(years.begin(), years.end(), trend.startYear);
+        const auto last = std::lower_bound(first, years.end(), trend.startYear + 10);
+        const size_t offset = first - years.begin();
+
+        SlopeInterval interval = bootstrapSlope(years.data() + offset, temps.data() + offset, last - first, options,
+                                                firstStream + i, pool);
+        trend.lower = interval.lower;
+        trend.upper = interval.upper;
+    }
+}
+
+std::vector<RobustDecadeTrend> computeRobustDecadeTrends(const std::vector<double>& years,
+                                                         const std::vector<double>& temps, double confidence) {
+    std::vector<RobustDecadeTrend> trends;
+    for (size_t first = 0, last = 0; first < years.size(); first = last) {
+        const double start = 10.0 * std::floor(years[first] / 10.0);
+        while (last < years.size() && years[last] < start + 10.0) ++last;
+        trends.push_back({static_cast<int>(start),
+                          theilSen(years.data() + first, temps.data() + first, last - first, 1, confidence)});
+    }
+    return trends;
+}
+
+void computeMonthlyDeviationStats(const ClimateTable& table, MonthDeviationStats stats[MONTHS_PER_YEAR]) {
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const double* monthly = table.month(month).data();
+        const double* seasonal = table.aggregate(static_cast<AggregateColumn>(AGG_DJF + month / 3)).data();
+
+        // Years missing the month or its season (the first DJF of a derived table) are skipped
+        double sum = 0.0;
+        size_t count = 0;
+        double maxDeviation = NAN, minDeviation = NAN;
+        for (size_t i = 0; i < table.size(); ++i) {
+            double deviation = monthly[i] - seasonal[i];
+            if (isMissing(deviation)) continue;
+            sum += deviation;
+            if (count == 0 || deviation > maxDeviation) maxDeviation = deviation;
+            if (count == 0 || deviation < minDeviation) minDeviation = deviation;
+            ++count;
+        }
+
+        stats[month].mean = count > 0 ? sum / count : NAN;
+        stats[month].max = maxDeviation;
+        stats[month].min = minDeviation;
+    }
+}
+
+std::vector<YearExtremes> computeYearExtremes(const ClimateTable& table) {
+    std::vector<YearExtremes> extremes(table.size());
+
+    for (size_t row = 0; row < table.size(); ++row) {
+        YearExtremes& e = extremes[row];
+        e.year = table.years[row];
+        e.hottestMonth = e.coldestMonth = -1;
+        e.maxTemp = e.minTemp = NAN;
+
+        for (int i = 0; i < MONTHS_PER_YEAR; ++i) {
+            double value = table.month(i)[row];
+            if (isMissing(value)) continue;
+            if (e.hottestMonth < 0 || value > e.maxTemp) {
+                e.maxTemp = value;
+                e.hottestMonth = i;
+            }
+            if (e.coldestMonth < 0 || value < e.minTemp) {
+                e.minTemp = value;
+                e.coldestMonth = i;
+            }
+        }
+    }
+    return extremes;
+}
+
+void computeWarmCoolSlopes(const ClimateTable& table, const RecordSet& records,
+                           const RegressionResult monthlyTrends[MONTHS_PER_YEAR],
+                           WarmCoolSlopes slopes[MONTHS_PER_YEAR]) {
+    std::vector<int> years_with_data;
+    std::vector<double> stationary_distribution_by_month;
+
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const double* column = table.month(month).data();
+        const std::vector<double>& running_max = records.months[month].runningMax;
+        years_with_data.clear();
+        stationary_distribution_by_month.clear();
+
+        for (size_t year = 0; year < table.size(); ++year) {
+            if (!isMissing(column[year])) {
+                years_with_data.push_back(table.years[year]);
+                stationary_distribution_by_month.push_back(running_max[year]);
+            }
+        }
+
+        slopes[month].yearlyIncrease = 0.0;
+        slopes[month].stationaryDistribution = 0.0;
+        if (years_with_data.size() > 1) {
+            slopes[month].yearlyIncrease = monthlyTrends[month].slope;
+            slopes[month].stationaryDistribution = linearRegression(years_with_data, stationary_distribution_by_month).slope;
+        }
+    }
+}
+
+void computeWarmCoolIntervals(const ClimateTable& table, const RecordSet& records, const ResamplingOptions& options,
+                              ThreadPool* pool, WarmCoolSlopes slopes[MONTHS_PER_YEAR]) {
+    std::vector<double> years(table.years.begin(), table.years.end());
+    std::vector<double> excess(table.size());
+
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const double* column = table.month(month).data();
+        const std::vector<double>& running_max = records.months[month].runningMax;
+        for (size_t year = 0; year < table.size(); ++year) {
+            excess[year] = column[year] - running_max[year]; // NaN where the month is missing
+        }
+
+        SlopeInterval interval = bootstrapSlope(years.data(), excess.data(), excess.size(), options, month, pool);
+        slopes[month].differenceLower = interval.lower;
+        slopes[month].differenceUpper = interval.upper;
+    }
+}
+
+WarmCoolTrend classifyWarmCool(const WarmCoolSlopes& slopes) {
+    if (!std::isnan(slopes.differenceLower)) {
+        if (slopes.differenceLower > 0.0) return TREND_WARMING;
+        if (slopes.differenceUpper < 0.0) return TREND_COOLING;
+        return TREND_STATIONARY;
+    }
+
+    const double difference = slopes.yearlyIncrease - slopes.stationaryDistribution;
+    if (difference > 0.0) return TREND_WARMING;
+    if (difference < 0.0) return TREND_COOLING;
+    return TREND_STATIONARY;
+}
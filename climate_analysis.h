@@ -0,0 +1,110 @@
+#ifndef CLIMATE_ANALYSIS_H
+#define CLIMATE_ANALYSIS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "climate_table.h"
+#include "record_engine.h"
+#include "regression.h"
+#include "resampling.h"
+#include "robust_trend.h"
+
+// Trend of one block of the decade analysis
+struct DecadeTrend {
+    int startYear;
+    double slope;
+    double intercept;
+    double lower = NAN; // bootstrap interval of the slope (computeDecadeIntervals)
+    double upper = NAN;
+};
+
+// Function to fit a line to each calendar decade (1880-1889, 1890-1899, ...)
+// of an annual series, as decadeTrendAnalysis does
+std::vector<DecadeTrend> computeDecadeTrends(const std::vector<double>& years, const std::vector<double>& temps);
+
+// Function to bootstrap the slope of every decade; decade i uses resampling
+// stream firstStream + i
+void computeDecadeIntervals(const std::vector<double>& years, const std::vector<double>& temps,
+                            const ResamplingOptions& options, std::uint64_t firstStream, ThreadPool* pool,
+                            std::vector<DecadeTrend>& trends);
+
+// Theil-Sen line and Mann-Kendall test of one calendar decade
+struct RobustDecadeTrend {
+    int startYear;
+    RobustTrend trend;
+};
+
+// Function to fit each calendar decade of an annual series (years ascending)
+// robustly, over the same decades as computeDecadeTrends
+std::vector<RobustDecadeTrend> computeRobustDecadeTrends(const std::vector<double>& years,
+                                                         const std::vector<double>& temps, double confidence);
+
+
+// Deviation of one month from its season column, over the years that have
+// both (NaN when none do)
+struct MonthDeviationStats {
+    double mean;
+    double max;
+    double min;
+};
+
+// Function to compute the per-month deviation statistics of monthlyAnalysis
+void computeMonthlyDeviationStats(const ClimateTable& table, MonthDeviationStats stats[MONTHS_PER_YEAR]);
+
+// Hottest and coldest month of one year (months are 0-based), over its valid
+// months; -1 and NaN when the year has none
+struct YearExtremes {
+    int year;
+    int hottestMonth;
+    double maxTemp;
+    int coldestMonth;
+    double minTemp;
+};
+
+// Function to find the hottest and coldest month of every year (yearlyAnalysis)
+std::vector<YearExtremes> computeYearExtremes(const ClimateTable& table);
+
+// Slopes compared by the global warming / cooling analysis of one month
+struct WarmCoolSlopes {
+    double yearlyIncrease;         // trend of the month's anomalies
+    double stationaryDistribution; // trend of the month's running maximum
+    // Bootstrap interval of yearlyIncrease - stationaryDistribution. It is
+    // conditional on the observed records: blocks of the fixed series
+    // anomaly - running maximum are resampled, and the running maximum is not
+    // recomputed for each resampled series, so the interval leaves out the
+    // sampling variability of the record path itself and is narrower than a
+    // full resample of the anomalies would give.
+    double differenceLower = NAN;
+    double differenceUpper = NAN;
+};
+
+enum WarmCoolTrend {
+    TREND_STATIONARY,
+    TREND_WARMING,
+    TREND_COOLING
+};
+
+// Function to compute both slopes for each month; months with fewer than two
+// values keep slopes of 0. The yearly increase is the month's trend, taken
+// from monthlyTrends (one regression of each month's anomalies on the year).
+void computeWarmCoolSlopes(const ClimateTable& table, const RecordSet& records,
+                           const RegressionResult monthlyTrends[MONTHS_PER_YEAR],
+                           WarmCoolSlopes slopes[MONTHS_PER_YEAR]);
+
+// Function to bootstrap the difference of the two slopes of each month. Both
+// series share the same years, so the difference is the slope of the
+// anomaly minus its running maximum (taken once from records, not per
+// resample; see WarmCoolSlopes); month m uses resampling stream m.
+void computeWarmCoolIntervals(const ClimateTable& table, const RecordSet& records, const ResamplingOptions& options,
+                              ThreadPool* pool, WarmCoolSlopes slopes[MONTHS_PER_YEAR]);
+
+// Function to interpret a month's slopes: warming when the anomalies rise
+// faster than the running maximum of a stationary climate would. With an
+// interval the difference must be significant (the interval excludes 0) and
+// anything else is stationary; without one only its sign is used.
+WarmCoolTrend classifyWarmCool(const WarmCoolSlopes& slopes);
+
+#endif // CLIMATE_ANALYSIS_H
@@ -0,0 +1,542 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <cstdlib>
+#include <cstdio>
+#include <filesystem>
+#include <sstream>
+#include <sys/resource.h>
+
+#include "adf_test.h"
+#include "aggregation.h"
+#include "analysis_pipeline.h"
+#include "area_means.h"
+#include "changepoint.h"
+#include "climate_table.h"
+#include "climate_analysis.h"
+#include "climate_reports.h"
+#include "extreme_events.h"
+#include "record_engine.h"
+#include "regression.h"
+#include "resampling.h"
+#include "robust_trend.h"
+#include "spectrum.h"
+#include "rolling_trend.h"
+#include "stream_state.h"
+#include "gridded_field.h"
+#include "grid_analysis.h"
+#include "packed_anomaly.h"
+#include "parallel_ingest.h"
+#include "period_analysis.h"
+#include "range_index.h"
+#include "synthetic_data.h"
+#include "table_cache.h"
+#include "thread_pool.h"
+
+// One measured stage at one input size
+struct BenchResult {
+    std::string shape;  // "table" or "grid"
+    size_t rows;        // table rows, or grid cells x years
+    size_t series;      // independent series in the input
+    std::string stage;
+    double seconds;     // best of the repeats
+    double bytes;       // input bytes the stage reads
+    long peakRssKb;
+};
+
+// Keeps the optimizer from discarding results
+volatile double benchSink = 0.0;
+
+// Whether resetPeakRss works here; otherwise peaks are the process high-water mark
+bool perStagePeaks = true;
+
+// Function to start a new peak RSS measurement by resetting the kernel's
+// high-water mark (VmHWM) to the current resident set (Linux 4.0 and later)
+void resetPeakRss() {
+    if (!perStagePeaks) return;
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    if (!clearRefs.flush()) {
+        perStagePeaks = false;
+        std::cerr << "Cannot reset the peak RSS; peak_rss_kb is the high-water mark of the whole run" << std::endl;
+    }
+}
+
+// Function to return the peak RSS since the last resetPeakRss, in kilobytes
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) return std::atol(line.c_str() + 6);
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // kilobytes on Linux
+}
+
+// Function to time a stage and keep the fastest of repeat runs. The peak RSS
+// is reset first, so peakRssKb() right after covers this stage alone
+// (including whatever was resident when it started).
+double timeStage(int repeat, const std::function<void()>& stage) {
+    resetPeakRss();
+    double best = 0.0;
+    for (int r = 0; r < repeat; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        stage();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (r == 0 || seconds < best) best = seconds;
+    }
+    return best;
+}
+
+void benchTable(size_t rows, int repeat, ThreadPool& pool, std::vector<BenchResult>& results) {
+    const std::string csv = generateSyntheticCsv(rows, 1880u + static_cast<unsigned>(rows));
+    const double columnBytes = static_cast<double>(rows) * sizeof(double);
+
+    auto record = [&](const std::string& stage, double seconds, double bytes) {
+        results.push_back({"table", rows, 1, stage, seconds, bytes, peakRssKb()});
+    };
+
+    ClimateTable table;
+    std::string error;
+    record("parse", timeStage(repeat, [&] {
+        if (!parseClimateTable(csv.data(), csv.size(), table, error)) {
+            std::cerr << "Synthetic data failed to parse: " << error << std::endl;
+            std::exit(1);
+        }
+    }), static_cast<double>(csv.size()));
+
+    IngestReport report;
+    record("parallel_parse", timeStage(repeat, [&] {
+        ClimateTable parallel;
+        parseClimateTableParallel(csv.data(), csv.size(), pool, IngestOptions(), parallel, report);
+        benchSink = benchSink + parallel.size();
+    }), static_cast<double>(csv.size()));
+
+    // Reopening the same table through its mapped cache, as every later run does
+    const std::string cacheFilename = (std::filesystem::temp_directory_path()
+                                       / ("climate_bench_" + std::to_string(rows) + ".clcache")).string();
+    SourceStamp stamp;
+    stamp.size = csv.size();
+    if (writeTableCache(table, stamp, cacheFilename, error)) {
+        ClimateTable cached;
+        record("cache_open", timeStage(repeat, [&] {
+            if (openTableCache(cacheFilename, stamp, false, cached, nullptr, error) != CACHE_OK) {
+                std::cerr << "Cache failed to open: " << error << std::endl;
+                std::exit(1);
+            }
+            benchSink = benchSink + cached.years.back();
+        }), static_cast<double>(csv.size()));
+        std::remove(cacheFilename.c_str());
+    }
+
+    RecordSet records;
+    record("running_records", timeStage(repeat, [&] {
+        computeRecords(table, records);
+    }), columnBytes * MONTHS_PER_YEAR);
+
+    size_t gapCount = 0;
+    for (const SeriesRecords& month : records.months) gapCount += month.gapyears.size();
+    record("gap_regression", timeStage(repeat, [&] {
+        for (const SeriesRecords& month : records.months) {
+            RegressionResult fit = linearRegression(month.gapyears, month.gapsizes);
+            benchSink = benchSink + fit.slope;
+        }
+    }), static_cast<double>(gapCount) * 2 * sizeof(int));
+
+    std::vector<double> years, jd;
+    record("decade_trends", timeStage(repeat, [&] {
+        years.clear();
+        jd.clear();
+        const Column<double>& column = table.aggregate(AGG_JD);
+        for (size_t i = 0; i < table.size(); ++i) {
+            if (!isMissing(column[i])) {
+                years.push_back(table.years[i]);
+                jd.push_back(column[i]);
+            }
+        }
+        std::vector<DecadeTrend> trends = computeDecadeTrends(years, jd);
+        benchSink = benchSink + trends.back().slope;
+    }), columnBytes * 2);
+
+    std::vector<double> monthTime, monthValues;
+    monthlyTimeSeries(table, monthTime, monthValues);
+    record("rolling_trends", timeStage(repeat, [&] {
+        // 30-year windows sliding by one year over the monthly series
+        RollingTrendOptions options;
+        options.window = 30.0;
+        options.stride = 1.0;
+        std::vector<WindowTrend> trends = computeRollingTrends(monthTime, monthValues, options);
+        benchSink = benchSink + (trends.empty() ? 0.0 : trends.back().fit.slope);
+    }), columnBytes * MONTHS_PER_YEAR * 2);
+
+    record("aggregation", timeStage(repeat, [&] {
+        // J-D, D-N and the four seasons from the monthly columns
+        computeAggregates(table, AggregationRules());
+        benchSink = benchSink + table.aggregate(AGG_JD).back();
+    }), columnBytes * VALUE_COLUMNS);
+
+    record("seasonal_monthly_yearly", timeStage(repeat, [&] {
+        MonthDeviationStats stats[MONTHS_PER_YEAR];
+        computeMonthlyDeviationStats(table, stats);
+        std::vector<YearExtremes> extremes = computeYearExtremes(table);
+        benchSink = benchSink + stats[0].mean + extremes.back().maxTemp;
+    }), columnBytes * (MONTHS_PER_YEAR + 4));
+
+    // ADF (constant, AIC lags) of every month. The lag search grows as n^(1/4),
+    // so the fits cost O(n^(3/2)); tables past 1e5 rows are left out
+    if (rows <= 100000) {
+        record("stationarity", timeStage(repeat, [&] {
+            for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+                AdfResult adf = adfTest(table.month(month).data(), table.size(), AdfOptions());
+                benchSink = benchSink + adf.statistic;
+            }
+        }), columnBytes * MONTHS_PER_YEAR);
+
+        // Every record and trend report on one fresh pipeline, 100 resamples
+        // per series: each shared stage runs once for the whole suite
+        ResamplingOptions resampling;
+        resampling.replicates = 100;
+        record("report_suite", timeStage(repeat, [&] {
+            AnalysisPipeline pipeline(table, resampling, &pool);
+            std::ostringstream out;
+            printRecordGaps(pipeline.records(), out);
+            printGapRegressions(pipeline, out);
+            printWarmCoolAnalysis(pipeline, out);
+            printTrendAnalysis(pipeline, "", out, error);
+            printSeasonalAnalysis(pipeline, out);
+            benchSink = benchSink + out.str().size() + pipeline.stagesRun();
+        }), columnBytes * VALUE_COLUMNS);
+    }
+
+    // Index build, then 100000 random year-range queries over the month and aggregate columns
+    RangeIndex index;
+    record("range_index_build", timeStage(repeat, [&] {
+        if (!index.build(table, error)) {
+            std::cerr << "Range index failed to build: " << error << std::endl;
+            std::exit(1);
+        }
+    }), columnBytes * (VALUE_COLUMNS + MONTHS_PER_YEAR));
+
+    const int queries = 100000;
+    record("range_queries", timeStage(repeat, [&] {
+        std::uint32_t state = 12345;
+        auto next = [&state]() { return state = state * 1664525u + 1013904223u; };
+        const int firstYear = table.years[0];
+        for (int q = 0; q < queries; ++q) {
+            int a = firstYear + static_cast<int>((next() >> 8) % table.size());
+            int b = firstYear + static_cast<int>((next() >> 8) % table.size());
+            if (a > b) std::swap(a, b);
+            RangeStats stats = index.query(static_cast<int>((next() >> 8) % VALUE_COLUMNS), a, b);
+            benchSink = benchSink + stats.max;
+        }
+    }), static_cast<double>(queries) * sizeof(RangeStats));
+
+    record("extreme_events", timeStage(repeat, [&] {
+        // Four amplitudes by durations 1..24 in one pass
+        ThresholdSweep sweep = sweepExtremeEvents(table, {0.0, 0.25, 0.5, 1.0}, 24);
+        benchSink = benchSink + sweep.warmEvents[sweep.index(0, 3)];
+    }), columnBytes * MONTHS_PER_YEAR);
+
+    record("changepoints", timeStage(repeat, [&] {
+        // Trend changepoints of the whole monthly series, PELT unless pruning fails
+        ChangepointResult changes = detectChangepoints(monthTime.data(), monthValues.data(), monthTime.size(), 1,
+                                                       ChangepointOptions());
+        benchSink = benchSink + changes.cost + changes.changepoints();
+    }), columnBytes * MONTHS_PER_YEAR * 2);
+
+    // Theil-Sen slope, interval and Mann-Kendall test of the whole monthly
+    // series: O(n log n), but a dozen merge sorts of the series per call, so
+    // tables past 1e5 rows are left out
+    if (rows <= 100000) {
+        record("theil_sen", timeStage(repeat, [&] {
+            RobustTrend trend = theilSen(monthTime.data(), monthValues.data(), monthTime.size());
+            benchSink = benchSink + trend.slope + trend.pValue;
+        }), columnBytes * MONTHS_PER_YEAR * 2);
+    }
+
+    // Periodogram of the whole monthly series; missing months become the trend
+    std::vector<double> density;
+    record("spectrum", timeStage(repeat, [&] {
+        SpectrumPlan plan(monthValues.size(), SpectrumOptions());
+        density.resize(plan.bins());
+        plan.compute(monthValues.data(), 0, 1, 1, density.data());
+        benchSink = benchSink + density[1];
+    }), columnBytes * MONTHS_PER_YEAR);
+}
+
+void benchGrid(int nlat, int nlon, int years, int repeat, ThreadPool& pool, std::vector<BenchResult>& results) {
+    GriddedField field;
+    generateSyntheticField(nlat, nlon, 1880, years, 1880u, field, pool);
+
+    const size_t rows = field.cells() * static_cast<size_t>(years);
+    const double bytes = static_cast<double>(field.values.size()) * sizeof(float);
+
+    std::vector<CellResult> cells;
+    double seconds = timeStage(repeat, [&] {
+        analyzeGrid(field, GridAnalysisOptions(), pool, cells);
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_analysis", seconds, bytes, peakRssKb()});
+
+    // The same analysis on int16 values, and the packed kernels alone
+    PackedField packed;
+    packGriddedField(field, packed);
+    const double packedBytes = static_cast<double>(packed.values.size()) * sizeof(std::int16_t);
+    seconds = timeStage(repeat, [&] {
+        analyzeGrid(packed, GridAnalysisOptions(), pool, cells);
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_analysis_packed", seconds, packedBytes, peakRssKb()});
+
+    std::vector<int> recordCounts(field.cells() * MONTHS_PER_YEAR);
+    std::vector<PackedMoments> moments(field.cells());
+    std::vector<PackedRunCounts> runs(field.cells());
+    seconds = timeStage(repeat, [&] {
+        pool.parallelFor(0, field.cells(), 64, [&](size_t first, size_t last) {
+            const std::int16_t* values = packed.series(first);
+            const size_t count = last - first;
+            packedMomentsBatch(values, packed.months, packed.months, 1, count, &moments[first]);
+            packedRunsBatch(values, packed.months, packed.months, 1, count, 0, 3, &runs[first]);
+            for (size_t cell = first; cell < last; ++cell) {
+                packedRecordsBatch(packed.series(cell), years, 1, 12, MONTHS_PER_YEAR, nullptr,
+                                   &recordCounts[cell * MONTHS_PER_YEAR]);
+            }
+        });
+        benchSink = benchSink + moments.back().sum + runs.back().heatwaveCount + recordCounts.back();
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_packed_kernels", seconds, packedBytes, peakRssKb()});
+
+    // Monthly-only grid: derive every cell's annual and seasonal means
+    std::vector<float> aggregates;
+    seconds = timeStage(repeat, [&] {
+        aggregateField(field, AggregationRules(), pool, aggregates);
+        benchSink = benchSink + aggregates.back();
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_aggregation", seconds, bytes, peakRssKb()});
+
+    // Area-weighted global, hemispheric and zonal means of every month
+    const std::vector<MeanRegion> regions = standardRegions();
+    std::vector<ClimateTable> means;
+    seconds = timeStage(repeat, [&] {
+        areaMeans(field, regions, AreaMeanOptions(), pool, means);
+        benchSink = benchSink + means[0].month(0).back();
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_area_means", seconds, bytes, peakRssKb()});
+
+    // 90th / 10th percentile of each month over the field, from sketches
+    // merged across blocks of cells, and each cell's own thresholds
+    seconds = timeStage(repeat, [&] {
+        MonthThresholds thresholds = fieldThresholds(field, PercentileOptions(), pool);
+        benchSink = benchSink + thresholds.upper[0];
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_field_percentiles", seconds, bytes, peakRssKb()});
+    std::vector<MonthThresholds> cellPercentiles(field.cells());
+    seconds = timeStage(repeat, [&] {
+        pool.parallelFor(0, field.cells(), 16, [&](size_t first, size_t last) {
+            for (size_t cell = first; cell < last; ++cell) {
+                cellPercentiles[cell] = cellThresholds(field.series(cell), field.months, field.startYear,
+                                                       PercentileOptions());
+            }
+        });
+        benchSink = benchSink + cellPercentiles.back().upper[0];
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_cell_percentiles", seconds, bytes, peakRssKb()});
+
+    // Block-bootstrap interval of every cell's January trend, 1000 resamples each
+    std::vector<double> yearAxis(years);
+    for (int y = 0; y < years; ++y) yearAxis[y] = field.startYear + y;
+    ResamplingOptions resampling;
+    resampling.replicates = 1000;
+    std::vector<SlopeInterval> intervals(field.cells());
+    seconds = timeStage(repeat, [&] {
+        bootstrapSlopeBatch(yearAxis.data(), years, field.values.data(), field.months, 12, field.cells(), resampling,
+                            0, &pool, intervals.data());
+        benchSink = benchSink + intervals.back().lower;
+    });
+    results.push_back({"grid", rows / MONTHS_PER_YEAR, field.cells(), "grid_bootstrap", seconds,
+                       bytes / MONTHS_PER_YEAR, peakRssKb()});
+
+    // Trend changepoints of every cell's January series
+    std::vector<double> cellCosts(field.cells());
+    seconds = timeStage(repeat, [&] {
+        pool.parallelFor(0, field.cells(), 16, [&](size_t first, size_t last) {
+            for (size_t cell = first; cell < last; ++cell) {
+                cellCosts[cell] = detectChangepoints(yearAxis.data(), field.series(cell), years, 12,
+                                                     ChangepointOptions()).cost;
+            }
+        });
+        benchSink = benchSink + cellCosts.back();
+    });
+    results.push_back({"grid", rows / MONTHS_PER_YEAR, field.cells(), "grid_changepoints", seconds,
+                       bytes / MONTHS_PER_YEAR, peakRssKb()});
+
+    // Theil-Sen slope and Mann-Kendall test of every cell's January series
+    std::vector<RobustTrend> cellTrends(field.cells());
+    seconds = timeStage(repeat, [&] {
+        theilSenBatch(yearAxis.data(), years, field.values.data(), field.months, 12, field.cells(), cellTrends.data(),
+                      &pool);
+        benchSink = benchSink + cellTrends.back().slope;
+    });
+    results.push_back({"grid", rows / MONTHS_PER_YEAR, field.cells(), "grid_theil_sen", seconds,
+                       bytes / MONTHS_PER_YEAR, peakRssKb()});
+
+    // Welch spectra of every cell over 20-year segments, one shared plan
+    SpectrumOptions spectrumOptions;
+    spectrumOptions.segment = 240;
+    const SpectrumPlan spectra(field.months, spectrumOptions);
+    std::vector<double> cellPower(field.cells() * spectra.bins());
+    seconds = timeStage(repeat, [&] {
+        spectra.compute(field.values.data(), field.months, 1, field.cells(), cellPower.data(), &pool);
+        benchSink = benchSink + cellPower.back();
+    });
+    results.push_back({"grid", rows, field.cells(), "grid_spectra", seconds, bytes, peakRssKb()});
+}
+
+void benchDaily(size_t years, int repeat, std::vector<BenchResult>& results) {
+    const std::string csv = generateSyntheticDailyCsv(years, 1880u + static_cast<unsigned>(years));
+    const std::string filename = (std::filesystem::temp_directory_path()
+                                  / ("climate_bench_daily_" + std::to_string(years) + ".csv")).string();
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << csv;
+    }
+    const size_t rows = years * DailyCalendar::periods;
+    const double bytes = static_cast<double>(rows) * sizeof(double);
+
+    auto record = [&](const std::string& stage, double seconds, double stageBytes) {
+        results.push_back({"daily", rows, 1, stage, seconds, stageBytes, peakRssKb()});
+    };
+
+    PeriodTable<DailyCalendar> table;
+    std::string error;
+    record("daily_parse", timeStage(repeat, [&] {
+        if (!readPeriodCsv(filename, table, error)) {
+            std::cerr << "Synthetic daily data failed to parse: " << error << std::endl;
+            std::exit(1);
+        }
+    }), static_cast<double>(csv.size()));
+    std::remove(filename.c_str());
+    std::vector<int> emptyPeriods;
+    if (!subtractClimatology(table, 1951, 1980, emptyPeriods, error)) {
+        std::cerr << "Synthetic daily data: " << error << std::endl;
+        std::exit(1);
+    }
+
+    auto records = std::make_unique<PeriodRecords<DailyCalendar>>();
+    record("daily_records", timeStage(repeat, [&] {
+        computePeriodRecords(table, *records);
+        benchSink = benchSink + records->recordCount[0];
+    }), bytes);
+
+    auto trends = std::make_unique<PeriodTrends<DailyCalendar>>();
+    record("daily_trends", timeStage(repeat, [&] {
+        computePeriodTrends(table, *trends);
+        benchSink = benchSink + trends->periods[0].slope;
+    }), bytes);
+
+    PeriodSeasons seasons;
+    record("daily_seasons", timeStage(repeat, [&] {
+        computePeriodSeasons(table, 0.8, seasons);
+        benchSink = benchSink + seasons.annual.back();
+    }), bytes);
+
+    record("daily_events", timeStage(repeat, [&] {
+        PeriodEventSummary events = countPeriodEvents(table, 3, 2.0);
+        benchSink = benchSink + events.heatwaveCount;
+    }), bytes);
+}
+
+void writeCsv(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "shape,rows,series,stage,seconds,rows_per_s,mb_per_s,peak_rss_kb\n";
+    for (const BenchResult& r : results) {
+        out << r.shape << "," << r.rows << "," << r.series << "," << r.stage << "," << r.seconds << ","
+            << r.rows / r.seconds << "," << r.bytes / r.seconds / 1e6 << "," << r.peakRssKb << "\n";
+    }
+}
+
+void writeJson(std::ostream& out, const std::vector<BenchResult>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << "  {\"shape\": \"" << r.shape << "\", \"rows\": " << r.rows << ", \"series\": " << r.series
+            << ", \"stage\": \"" << r.stage << "\", \"seconds\": " << r.seconds
+            << ", \"rows_per_s\": " << r.rows / r.seconds << ", \"mb_per_s\": " << r.bytes / r.seconds / 1e6
+            << ", \"peak_rss_kb\": " << r.peakRssKb << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t maxRows = 1000000;
+    int repeat = 3;
+    unsigned threads = 0;
+    bool json = false;
+    bool grid = true;
+    std::string outputFilename;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-rows" && i + 1 < argc) {
+            maxRows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--format" && i + 1 < argc) {
+            json = std::string(argv[++i]) == "json";
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFilename = argv[++i];
+        } else if (arg == "--no-grid") {
+            grid = false;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max-rows N] [--repeat R] [--threads T]"
+                      << " [--format csv|json] [--output file] [--no-grid]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    ThreadPool pool(threads);
+
+    // Global.csv has 145 lines; grow by decades up to maxRows
+    const size_t sizes[] = {145, 1000, 10000, 100000, 1000000, 10000000};
+    for (size_t rows : sizes) {
+        if (rows > maxRows) break;
+        std::cerr << "table " << rows << " rows" << std::endl;
+        benchTable(rows, repeat, pool, results);
+    }
+
+    // Daily station series: one and ten GISTEMP periods of days
+    for (size_t years : {144, 1440}) {
+        if (years * DailyCalendar::periods > maxRows * MONTHS_PER_YEAR) break;
+        std::cerr << "daily " << years << " years" << std::endl;
+        benchDaily(years, repeat, results);
+    }
+
+    if (grid) {
+        // 10, 5 and 2 degree grids over the GISTEMP period
+        const int shapes[][2] = {{18, 36}, {36, 72}, {90, 180}};
+        for (const auto& shape : shapes) {
+            // Stay within the memory of the largest table benchmarked
+            size_t gridBytes = static_cast<size_t>(shape[0]) * shape[1] * 144 * MONTHS_PER_YEAR * sizeof(float);
+            if (gridBytes > maxRows * (VALUE_COLUMNS + 1) * sizeof(double)) break;
+            std::cerr << "grid " << shape[0] << "x" << shape[1] << std::endl;
+            benchGrid(shape[0], shape[1], 144, repeat, pool, results);
+        }
+    }
+
+    if (outputFilename.empty()) {
+        json ? writeJson(std::cout, results) : writeCsv(std::cout, results);
+    } else {
+        std::ofstream out(outputFilename);
+        if (!out) {
+            std::cerr << "Error opening file: " << outputFilename << std::endl;
+            return 1;
+        }
+        json ? writeJson(out, results) : writeCsv(out, results);
+    }
+    return 0;
+}
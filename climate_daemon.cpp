@@ -0,0 +1,383 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "analysis_service.h"
+#include "thread_pool.h"
+
+// Wire format, one exchange per request line on a persistent connection:
+//   request:  "<request>\n" (see AnalysisService for the requests)
+//   response: "OK <bytes>\n" followed by exactly <bytes> bytes of text, or
+//             "ERR <message>\n"
+// Clients may pipeline requests; responses come back in request order.
+
+const size_t MAX_REQUEST_BYTES = 4096;
+
+// Self-pipe written by the signal handlers: 'q' to stop, 'r' to reload now
+int wakePipe[2] = {-1, -1};
+
+void onSignal(int signal) {
+    const char command = signal == SIGHUP ? 'r' : 'q';
+    ssize_t ignored = ::write(wakePipe[1], &command, 1);
+    (void)ignored;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage:\n"
+              << "  " << program << " [options]                 serve requests on a Unix socket\n"
+              << "  " << program << " -s SOCKET --send [REQUEST...]  send one request, or one per stdin line\n"
+              << "Options:\n"
+              << "  -s, --socket PATH      socket to listen on (default climate.sock)\n"
+              << "  -d, --dataset NAME=FILE  dataset to keep loaded; repeat for more (default global=Global.csv)\n"
+              << "  -j, --threads N        analysis workers (default: all cores)\n"
+              << "  --poll SECONDS         how often to check the files for changes (default 2); SIGHUP checks now\n"
+              << "  --max-clients N        concurrent connections (default 64)\n"
+              << "  --resamples N          bootstrap resamples and permutations per series (default 10000)\n"
+              << "  --seed N               seed of the resampling streams (default 1880)\n";
+}
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// Buffered reads of lines and fixed-size payloads from a socket
+struct SocketReader {
+    int fd;
+    std::string buffer;
+
+    bool fill() {
+        char chunk[4096];
+        for (;;) {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(n));
+            return true;
+        }
+    }
+
+    // Function to read one line without its newline; fails past maxBytes
+    bool readLine(std::string& line, size_t maxBytes) {
+        size_t newline;
+        while ((newline = buffer.find('\n')) == std::string::npos) {
+            if (buffer.size() > maxBytes || !fill()) return false;
+        }
+        line.assign(buffer, 0, newline);
+        buffer.erase(0, newline + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+    }
+
+    bool readBytes(size_t count, std::string& data) {
+        while (buffer.size() < count) {
+            if (!fill()) return false;
+        }
+        data.assign(buffer, 0, count);
+        buffer.erase(0, count);
+        return true;
+    }
+};
+
+// Open connections, so shutdown can unblock their reads and wait for them
+struct ClientRegistry {
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::set<int> fds;
+};
+
+void serveClient(int fd, AnalysisService& service, ClientRegistry& clients) {
+    SocketReader reader{fd, std::string()};
+    std::string request, response;
+    while (reader.readLine(request, MAX_REQUEST_BYTES)) {
+        bool ok;
+        try {
+            ok = service.handle(request, response);
+        } catch (const std::exception& e) {
+            ok = false;
+            response = e.what();
+        }
+
+        std::string frame;
+        if (ok) {
+            frame = "OK " + std::to_string(response.size()) + "\n" + response;
+        } else {
+            for (char& ch : response) {
+                if (ch == '\n' || ch == '\r') ch = ' ';
+            }
+            frame = "ERR " + response + "\n";
+        }
+        if (!sendAll(fd, frame)) break;
+    }
+    if (reader.buffer.size() > MAX_REQUEST_BYTES) {
+        sendAll(fd, "ERR request longer than " + std::to_string(MAX_REQUEST_BYTES) + " bytes\n");
+    }
+
+    std::lock_guard<std::mutex> lock(clients.mutex);
+    ::close(fd);
+    clients.fds.erase(fd);
+    clients.idle.notify_all();
+}
+
+bool socketAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) return false;
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+int connectSocket(const std::string& path) {
+    sockaddr_un address;
+    if (!socketAddress(path, address)) return -1;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    return fd;
+}
+
+// Function to listen on path, replacing a socket left behind by a daemon that
+// is no longer running (but never another kind of file or a live daemon)
+int listenSocket(const std::string& path, std::string& error) {
+    sockaddr_un address;
+    if (!socketAddress(path, address)) {
+        error = "Invalid socket path: " + path;
+        return -1;
+    }
+
+    struct stat info;
+    if (::lstat(path.c_str(), &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            error = path + " exists and is not a socket";
+            return -1;
+        }
+        int live = connectSocket(path);
+        if (live >= 0) {
+            ::close(live);
+            error = "A daemon is already listening on " + path;
+            return -1;
+        }
+        ::unlink(path.c_str());
+    }
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 128) != 0) {
+        error = "Error listening on " + path + ": " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Function to send requests and print the payloads; returns the exit status
+int runClient(const std::string& path, const std::vector<std::string>& requests) {
+    int fd = connectSocket(path);
+    if (fd < 0) {
+        std::cerr << "Error connecting to " << path << ": " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    SocketReader reader{fd, std::string()};
+    int status = 0;
+    auto exchange = [&](const std::string& request) {
+        std::string header, payload;
+        if (!sendAll(fd, request + "\n") || !reader.readLine(header, MAX_REQUEST_BYTES + 64)) {
+            std::cerr << "Connection closed" << std::endl;
+            return false;
+        }
+        if (header.compare(0, 3, "OK ") == 0) {
+            if (!reader.readBytes(std::strtoull(header.c_str() + 3, nullptr, 10), payload)) {
+                std::cerr << "Connection closed" << std::endl;
+                return false;
+            }
+            std::cout << payload;
+        } else {
+            std::cerr << header << std::endl;
+            status = 1;
+        }
+        return true;
+    };
+
+    if (!requests.empty()) {
+        std::string request;
+        for (const std::string& word : requests) request += (request.empty() ? "" : " ") + word;
+        if (!exchange(request)) status = 1;
+    } else {
+        std::string line;
+        while (std::getline(std::cin, line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+            if (!exchange(line)) {
+                status = 1;
+                break;
+            }
+        }
+    }
+    ::close(fd);
+    return status;
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = "climate.sock";
+    std::vector<std::pair<std::string, std::string>> datasets;
+    unsigned threads = 0;
+    int pollSeconds = 2;
+    size_t maxClients = 64;
+    ResamplingOptions resampling;
+    bool client = false;
+    std::vector<std::string> requests;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (client) {
+            requests.push_back(arg);
+        } else if ((arg == "-s" || arg == "--socket") && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if ((arg == "-d" || arg == "--dataset") && i + 1 < argc) {
+            std::string spec = argv[++i];
+            size_t equals = spec.find('=');
+            if (equals == 0 || equals == std::string::npos || equals + 1 == spec.size()) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            datasets.emplace_back(spec.substr(0, equals), spec.substr(equals + 1));
+        } else if ((arg == "-j" || arg == "--threads") && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--poll" && i + 1 < argc) {
+            pollSeconds = std::atoi(argv[++i]);
+        } else if (arg == "--max-clients" && i + 1 < argc) {
+            maxClients = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--resamples" && i + 1 < argc) {
+            resampling.replicates = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            resampling.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--send") {
+            client = true;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (client) {
+        return runClient(socketPath, requests);
+    }
+    if (pollSeconds < 1 || maxClients < 1 || resampling.replicates < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (datasets.empty()) {
+        datasets.emplace_back("global", "Global.csv");
+    }
+
+    ThreadPool pool(threads);
+    AnalysisService service(pool, resampling);
+    std::string error;
+    for (const auto& dataset : datasets) {
+        if (!service.addDataset(dataset.first, dataset.second, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+
+    int listenFd = listenSocket(socketPath, error);
+    if (listenFd < 0 || ::pipe(wakePipe) != 0) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    sigaction(SIGHUP, &action, nullptr);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // Reloads run beside the accept loop so a large file never stalls clients
+    std::mutex watchMutex;
+    std::condition_variable watchWake;
+    bool stopping = false, reloadNow = false;
+    std::thread watcher([&] {
+        std::unique_lock<std::mutex> lock(watchMutex);
+        while (!stopping) {
+            watchWake.wait_for(lock, std::chrono::seconds(pollSeconds), [&] { return stopping || reloadNow; });
+            if (stopping) break;
+            reloadNow = false;
+            lock.unlock();
+            std::ostringstream log;
+            service.reloadChanged(log);
+            std::cerr << log.str();
+            lock.lock();
+        }
+    });
+
+    std::cerr << "Serving " << datasets.size() << " dataset(s) on " << socketPath << " with " << pool.size()
+              << " workers\n";
+
+    ClientRegistry clients;
+    for (;;) {
+        pollfd fds[2] = {{listenFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents & POLLIN) {
+            char command;
+            if (::read(wakePipe[0], &command, 1) == 1 && command == 'q') break;
+            std::lock_guard<std::mutex> lock(watchMutex);
+            reloadNow = true;
+            watchWake.notify_all();
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::lock_guard<std::mutex> lock(clients.mutex);
+        if (clients.fds.size() >= maxClients) {
+            sendAll(fd, "ERR too many clients\n");
+            ::close(fd);
+            continue;
+        }
+        clients.fds.insert(fd);
+        std::thread(serveClient, fd, std::ref(service), std::ref(clients)).detach();
+    }
+
+    // Stop accepting, wake every client blocked in a read and wait for them
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+    {
+        std::lock_guard<std::mutex> lock(watchMutex);
+        stopping = true;
+        watchWake.notify_all();
+    }
+    watcher.join();
+    {
+        std::unique_lock<std::mutex> lock(clients.mutex);
+        for (int fd : clients.fds) ::shutdown(fd, SHUT_RDWR);
+        clients.idle.wait(lock, [&] { return clients.fds.empty(); });
+    }
+    std::cerr << "Stopped\n";
+    return 0;
+}
@@ -0,0 +1,284 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include "area_means.h"
+#include "climate_reports.h"
+#include "gridded_field.h"
+#include "grid_analysis.h"
+#include "spectrum.h"
+#include "thread_pool.h"
+
+void printUsage(const char* program) {
+    std::cerr << "Usage:\n"
+              << "  " << program << " generate <out.grid> [nlat] [nlon] [years] [seed]\n"
+              << "  " << program << " analyze <in.grid> <out.csv> [threads] [consecutiveMonthsThreshold] [--adf]\n"
+              << "                [--changepoints] [--significance] [--robust] [--resamples N] [--packed] [--percentiles U,L] [--base FIRST,LAST]\n"
+              << "  " << program << " pack <in.grid> <out.grid>\n"
+              << "  " << program << " thresholds <in.grid> [U,L] [FIRST,LAST]\n"
+              << "  " << program << " means <in.grid> <out-prefix> [threads] [--min-coverage F] [--packed]\n"
+              << "  " << program << " spectra <in.grid> <out.csv> [threads] [--segment MONTHS]\n"
+              << "--percentiles counts each cell's events against its own U-th / L-th monthly percentiles;\n"
+              << "--significance adds the AR(1)-adjusted standard error and p-value of each cell's trend;\n"
+              << "--changepoints adds each cell's trend changepoints and last-segment slope of its annual means;\n"
+              << "--robust adds the Theil-Sen slope and Mann-Kendall p-value of each cell's annual means and the\n"
+              << "Theil-Sen slope of its record gaps;\n"
+              << "thresholds prints the percentiles of each month over the whole field (default 90,10);\n"
+              << "means writes cos(latitude)-weighted global, hemispheric and zonal means as Global.csv-style\n"
+              << "tables <out-prefix><region>.csv, a month missing where under F of the region has values;\n"
+              << "spectra writes each cell's variance, peak period and ENSO (2-7 yr) and solar (9-13 yr) band\n"
+              << "shares from Welch spectra over MONTHS-long segments (default 240, 0 for one periodogram).\n";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    const std::string command = argv[1];
+    std::string error;
+
+    if (command == "generate") {
+        // Defaults match GISTEMP's 2 degree grid from 1880
+        int nlat = argc > 3 ? std::atoi(argv[3]) : 90;
+        int nlon = argc > 4 ? std::atoi(argv[4]) : 180;
+        int years = argc > 5 ? std::atoi(argv[5]) : 144;
+        unsigned seed = argc > 6 ? static_cast<unsigned>(std::strtoul(argv[6], nullptr, 10)) : 1880u;
+        if (nlat <= 0 || nlon <= 0 || years <= 0) {
+            std::cerr << "Grid dimensions and years must be positive" << std::endl;
+            return 1;
+        }
+
+        ThreadPool pool;
+        GriddedField field;
+        generateSyntheticField(nlat, nlon, 1880, years, seed, field, pool);
+        if (!writeGriddedField(field, argv[2], error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << field.cells() << " cells x " << field.months << " months to " << argv[2] << "\n";
+        return 0;
+    }
+
+    if (command == "analyze" && argc >= 4) {
+        // --adf, --changepoints, --significance, --robust, --packed, --resamples N, --percentiles U,L and
+        // --base F,L may follow the positional arguments
+        GridAnalysisOptions options;
+        bool packed = false;
+        while (argc > 4) {
+            if (std::string(argv[argc - 1]) == "--adf") {
+                options.stationarityTest = true;
+                --argc;
+            } else if (std::string(argv[argc - 1]) == "--changepoints") {
+                options.changepoints = true;
+                --argc;
+            } else if (std::string(argv[argc - 1]) == "--significance") {
+                options.significance = true;
+                --argc;
+            } else if (std::string(argv[argc - 1]) == "--robust") {
+                options.robustTrend = true;
+                --argc;
+            } else if (std::string(argv[argc - 1]) == "--packed") {
+                packed = true;
+                --argc;
+            } else if (std::string(argv[argc - 2]) == "--resamples") {
+                options.warmCoolResamples = std::strtoul(argv[argc - 1], nullptr, 10);
+                argc -= 2;
+            } else if (std::string(argv[argc - 2]) == "--percentiles") {
+                if (!parsePercentiles(argv[argc - 1], options.percentiles)) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                options.percentileEvents = true;
+                argc -= 2;
+            } else if (std::string(argv[argc - 2]) == "--base") {
+                if (!parseBaseYears(argv[argc - 1], options.percentiles)) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                argc -= 2;
+            } else {
+                break;
+            }
+        }
+        unsigned threads = argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 0;
+        if (argc > 5) options.consecutiveMonthsThreshold = std::atoi(argv[5]);
+
+        ThreadPool pool(threads);
+        std::vector<CellResult> results;
+        auto analyze = [&](const auto& field) {
+            auto start = std::chrono::steady_clock::now();
+            analyzeGrid(field, options, pool, results);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if (!writeGridResults(field, results, options, argv[3], error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            std::cout << "Analyzed " << field.cells() << " cells x " << field.months << " months on "
+                      << pool.size() << " threads in " << seconds << " s ("
+                      << field.values.size() * sizeof(field.values[0]) / 1e6 << " MB of values)\n";
+            return 0;
+        };
+
+        // Either file version can be analyzed either way
+        if (packed) {
+            PackedField field;
+            if (!readPackedField(argv[2], field, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            return analyze(field);
+        }
+        GriddedField field;
+        if (!readGriddedField(argv[2], field, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        return analyze(field);
+    }
+
+    if (command == "pack" && argc == 4) {
+        GriddedField field;
+        PackedField packed;
+        if (!readGriddedField(argv[2], field, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        const size_t changed = packGriddedField(field, packed);
+        if (!writePackedField(packed, argv[3], error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::cout << "Packed " << packed.values.size() << " values to " << argv[3] << "; " << changed
+                  << " rounded to two decimals or clamped\n";
+        return 0;
+    }
+
+    if (command == "thresholds" && argc <= 5) {
+        PercentileOptions options;
+        if ((argc > 3 && !parsePercentiles(argv[3], options)) || (argc > 4 && !parseBaseYears(argv[4], options))) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        GriddedField field;
+        if (!readGriddedField(argv[2], field, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        ThreadPool pool;
+        printPercentileThresholds(fieldThresholds(field, options, pool), options, std::cout);
+        return 0;
+    }
+
+    if (command == "means" && argc >= 4) {
+        AreaMeanOptions options;
+        bool packed = false;
+        while (argc > 4) {
+            if (std::string(argv[argc - 1]) == "--packed") {
+                packed = true;
+                --argc;
+            } else if (std::string(argv[argc - 2]) == "--min-coverage") {
+                options.minCoverage = std::atof(argv[argc - 1]);
+                argc -= 2;
+            } else {
+                break;
+            }
+        }
+        ThreadPool pool(argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 0);
+        const std::vector<MeanRegion> regions = standardRegions();
+        std::vector<ClimateTable> tables;
+        auto reduce = [&](const auto& field) {
+            auto start = std::chrono::steady_clock::now();
+            areaMeans(field, regions, options, pool, tables);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            for (size_t r = 0; r < regions.size(); ++r) {
+                const std::string filename = std::string(argv[3]) + regions[r].name + ".csv";
+                if (!writeClimateCsv(tables[r], regions[r].name + ": Area-weighted Means", filename, error)) {
+                    std::cerr << error << std::endl;
+                    return 1;
+                }
+            }
+            std::cout << "Reduced " << field.cells() << " cells x " << field.months << " months to "
+                      << regions.size() << " regional means on " << pool.size() << " threads in " << seconds
+                      << " s\n";
+            return 0;
+        };
+
+        if (packed) {
+            PackedField field;
+            if (!readPackedField(argv[2], field, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            return reduce(field);
+        }
+        GriddedField field;
+        if (!readGriddedField(argv[2], field, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        return reduce(field);
+    }
+
+    if (command == "spectra" && argc >= 4) {
+        SpectrumOptions options;
+        options.segment = 240;
+        if (argc > 5 && std::string(argv[argc - 2]) == "--segment") {
+            options.segment = std::strtoul(argv[argc - 1], nullptr, 10);
+            argc -= 2;
+        }
+        ThreadPool pool(argc > 4 ? static_cast<unsigned>(std::atoi(argv[4])) : 0);
+        GriddedField field;
+        if (!readGriddedField(argv[2], field, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+        std::ofstream output_file(argv[3]);
+        if (!output_file) {
+            std::cerr << "Error opening file: " << argv[3] << std::endl;
+            return 1;
+        }
+
+        // One plan for every cell; spectra are computed a chunk of cells at a time
+        auto start = std::chrono::steady_clock::now();
+        const SpectrumPlan plan(field.months, options);
+        const size_t chunk = 1024;
+        std::vector<double> power(chunk * plan.bins());
+        output_file << "Lat,Lon,Variance,PeakPeriod,EnsoFraction,SolarFraction\n";
+        for (size_t first = 0; first < field.cells(); first += chunk) {
+            const size_t count = std::min(chunk, field.cells() - first);
+            plan.compute(field.series(first), field.months, 1, count, power.data(), &pool);
+            for (size_t c = 0; c < count; ++c) {
+                const double* spectrum = &power[c * plan.bins()];
+                const double variance = bandPower(plan, spectrum, 0.0, options.sampleRate / 2.0);
+                const size_t peak = peakBin(plan, spectrum, 1.0 / 30.0, options.sampleRate / 2.0);
+                const int lat = static_cast<int>((first + c) / field.nlon);
+                const int lon = static_cast<int>((first + c) % field.nlon);
+                output_file << field.latitude(lat) << "," << field.longitude(lon) << "," << variance << ","
+                            << (peak > 0 ? 1.0 / plan.frequency(peak) : NAN) << ","
+                            << bandPower(plan, spectrum, 1.0 / 7.0, 1.0 / 2.0) / variance << ","
+                            << bandPower(plan, spectrum, 1.0 / 13.0, 1.0 / 9.0) / variance << "\n";
+            }
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!output_file.flush()) {
+            std::cerr << "Error writing file: " << argv[3] << std::endl;
+            return 1;
+        }
+        std::cout << "Spectra of " << field.cells() << " cells x " << field.months << " months ("
+                  << plan.segments() << " segments of " << plan.segmentLength() << ") on " << pool.size()
+                  << " threads in " << seconds << " s\n";
+        return 0;
+    }
+
+    printUsage(argv[0]);
+    return 1;
+}
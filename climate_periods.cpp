@@ -0,0 +1,216 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "changepoint.h"
+#include "climate_reports.h"
+#include "climate_table.h"
+#include "period_analysis.h"
+#include "resampling.h"
+#include "synthetic_data.h"
+
+struct PeriodOptions {
+    std::string calendar = "monthly";
+    std::string filename = "Global.csv";
+    int threshold = 3;
+    double amplitude = 0.0;
+    double minValidFraction = 0.8;
+    int baseFirst = 0; // climatology base years; 0 keeps the values as read
+    int baseLast = 0;
+    bool perPeriod = false;
+    bool changepoints = false;
+};
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [-c monthly|seasonal|weekly|daily] [-i FILE] [-t threshold] [-a amplitude]\n"
+              << "       [--base FIRST LAST] [--min-valid FRACTION] [--periods] [--changepoints]\n"
+              << "       " << program << " --generate-daily YEARS FILE\n"
+              << "Runs the record, trend, seasonal and extreme-event analyses on a series of the given\n"
+              << "calendar. FILE holds YYYY-MM-DD,value or Year,Period,Value lines; a GISTEMP table is\n"
+              << "also accepted as monthly or seasonal. --base turns values into anomalies against the\n"
+              << "mean of each period over those years. --periods lists every period. --changepoints splits\n"
+              << "the annual means into segments of constant trend.\n";
+}
+
+// Function to name a period for the listing
+std::string periodLabel(MonthlyCalendar, int period) {
+    return monthName(period);
+}
+std::string periodLabel(SeasonalCalendar, int period) {
+    return aggregateName(static_cast<AggregateColumn>(AGG_DJF + period));
+}
+std::string periodLabel(WeeklyCalendar, int period) {
+    char label[16];
+    std::snprintf(label, sizeof(label), "W%02d", period + 1);
+    return label;
+}
+std::string periodLabel(DailyCalendar, int period) {
+    const int month = calendar_detail::monthOfSlot(period);
+    char label[16];
+    std::snprintf(label, sizeof(label), "%02d-%02d", month + 1, period - calendar_detail::LEAP_MONTH_START[month] + 1);
+    return label;
+}
+
+template <typename Calendar>
+bool loadPeriods(const PeriodOptions& options, PeriodTable<Calendar>& table, std::string& error) {
+    return readPeriodCsv(options.filename, table, error);
+}
+
+// GISTEMP tables carry the monthly and seasonal columns directly. Only a file
+// with the Year,Jan..Dec header goes through the table loader (and its cache);
+// any other layout is read as a period CSV and leaves no cache behind.
+template <typename Calendar>
+bool loadTablePeriods(const PeriodOptions& options, PeriodTable<Calendar>& table, std::string& error) {
+    if (!hasClimateHeader(options.filename)) {
+        return readPeriodCsv(options.filename, table, error);
+    }
+    ClimateTable climate;
+    if (!readClimateTable(options.filename, climate, error)) {
+        return false;
+    }
+    toPeriodTable(climate, table);
+    return true;
+}
+
+template <>
+bool loadPeriods(const PeriodOptions& options, PeriodTable<MonthlyCalendar>& table, std::string& error) {
+    return loadTablePeriods(options, table, error);
+}
+
+template <>
+bool loadPeriods(const PeriodOptions& options, PeriodTable<SeasonalCalendar>& table, std::string& error) {
+    return loadTablePeriods(options, table, error);
+}
+
+template <typename Calendar>
+int runPeriods(const PeriodOptions& options) {
+    constexpr int P = Calendar::periods;
+    PeriodTable<Calendar> table;
+    std::string error;
+    if (!loadPeriods(options, table, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    if (options.baseFirst != 0) {
+        std::vector<int> emptyPeriods;
+        if (!subtractClimatology(table, options.baseFirst, options.baseLast, emptyPeriods, error)) {
+            std::cerr << options.filename << ": " << error << std::endl;
+            return 1;
+        }
+        for (int period : emptyPeriods) {
+            std::cerr << "Warning: no base value for " << periodLabel(Calendar(), period)
+                      << "; its anomalies are missing" << std::endl;
+        }
+    }
+
+    PeriodRecords<Calendar> records;
+    PeriodTrends<Calendar> trends;
+    PeriodSeasons seasons;
+    computePeriodRecords(table, records);
+    computePeriodTrends(table, trends);
+    computePeriodSeasons(table, options.minValidFraction, seasons);
+    PeriodEventSummary events = countPeriodEvents(table, options.threshold, options.amplitude);
+
+    std::cout << "Calendar: " << Calendar::name << " (" << P << " periods), " << table.years.front() << "-"
+              << table.years.back() << "\n";
+
+    // Records against the stationary expectation, summed over the periods
+    int highs = 0, lows = 0, usedPeriods = 0;
+    double expected = 0.0, slopeSum = 0.0;
+    for (int p = 0; p < P; ++p) {
+        if (trends.periods[p].n == 0) continue;
+        ++usedPeriods;
+        highs += records.recordCount[p];
+        lows += records.lowRecordCount[p];
+        expected += expectedRecordCount(trends.periods[p].n);
+        if (trends.periods[p].valid()) slopeSum += trends.periods[p].slope;
+    }
+    std::cout << "Record highs: " << highs << ", record lows: " << lows << " over " << usedPeriods
+              << " periods (stationary expectation " << expected << ")\n";
+    std::cout << "Mean per-period trend: " << (usedPeriods ? slopeSum / usedPeriods * 10.0 : 0.0) << " per decade\n";
+
+    static const char* const SEASONS[4] = {"DJF", "MAM", "JJA", "SON"};
+    for (int s = 0; s < 4; ++s) {
+        RegressionResult fit = linearRegression(seasons.years, seasons.seasons[s]);
+        std::cout << SEASONS[s] << " mean trend: " << fit.slope * 10.0 << " per decade (" << fit.n << " seasons)\n";
+    }
+    RegressionResult annual = linearRegression(seasons.years, seasons.annual);
+    std::cout << "Annual mean trend: " << annual.slope * 10.0 << " per decade (" << annual.n << " years)\n";
+
+    std::cout << "Heatwaves (" << options.threshold << "+ periods above " << options.amplitude
+              << "): " << events.heatwaveCount << ", longest " << events.longestHeatwave << "\n";
+    std::cout << "Cold snaps (" << options.threshold << "+ periods below " << 0.0 - options.amplitude
+              << "): " << events.coldSnapCount << ", longest " << events.longestColdSnap << "\n";
+
+    if (options.changepoints) {
+        // Period to period persistence would pass for shifts in the raw
+        // series, so the segments are those of the annual means
+        const std::vector<double> years(seasons.years.begin(), seasons.years.end());
+        printChangeSegments("Annual mean", detectChangepoints(years.data(), seasons.annual.data(), years.size(), 1,
+                                                              ChangepointOptions()),
+                            std::cout);
+    }
+
+    if (options.perPeriod) {
+        std::cout << "Period, Records, Low Records, Max, Max Year, Min, Min Year, Slope, Gap Slope\n";
+        for (int p = 0; p < P; ++p) {
+            std::cout << periodLabel(Calendar(), p) << ", " << records.recordCount[p] << ", "
+                      << records.lowRecordCount[p] << ", " << records.maxValue[p] << ", " << records.maxYear[p]
+                      << ", " << records.minValue[p] << ", " << records.minYear[p] << ", "
+                      << trends.periods[p].slope << ", " << records.gapRegression[p].slope << "\n";
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    PeriodOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--generate-daily" && i + 2 < argc) {
+            const size_t years = std::strtoul(argv[i + 1], nullptr, 10);
+            std::ofstream out(argv[i + 2], std::ios::binary);
+            if (years == 0 || !out) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            out << generateSyntheticDailyCsv(years, 1880u);
+            return out ? 0 : 1;
+        } else if ((arg == "-c" || arg == "--calendar") && i + 1 < argc) {
+            options.calendar = argv[++i];
+        } else if ((arg == "-i" || arg == "--input") && i + 1 < argc) {
+            options.filename = argv[++i];
+        } else if (arg == "-t" && i + 1 < argc) {
+            options.threshold = std::atoi(argv[++i]);
+        } else if (arg == "-a" && i + 1 < argc) {
+            options.amplitude = std::atof(argv[++i]);
+        } else if (arg == "--base" && i + 2 < argc) {
+            options.baseFirst = std::atoi(argv[++i]);
+            options.baseLast = std::atoi(argv[++i]);
+        } else if (arg == "--min-valid" && i + 1 < argc) {
+            options.minValidFraction = std::atof(argv[++i]);
+        } else if (arg == "--periods") {
+            options.perPeriod = true;
+        } else if (arg == "--changepoints") {
+            options.changepoints = true;
+        } else {
+            printUsage(argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+    if (options.threshold < 1 || options.baseFirst > options.baseLast) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.calendar == "monthly") return runPeriods<MonthlyCalendar>(options);
+    if (options.calendar == "seasonal") return runPeriods<SeasonalCalendar>(options);
+    if (options.calendar == "weekly") return runPeriods<WeeklyCalendar>(options);
+    if (options.calendar == "daily") return runPeriods<DailyCalendar>(options);
+    printUsage(argv[0]);
+    return 1;
+}
@@ -0,0 +1,60 @@
+#include <iostream>
+#include <string>
+
+#include "climate_table.h"
+#include "range_index.h"
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [-i FILE] [COLUMN FIRST [LAST]]\n"
+              << "Summarizes COLUMN over the years FIRST..LAST (default FIRST): count of valid values,\n"
+              << "mean, sum, and the maximum and minimum with the year that holds them.\n"
+              << "COLUMN is a header name (Jan..Dec, J-D, D-N, DJF, MAM, JJA, SON) or Monthly for every\n"
+              << "month in time order, whose bounds may be YYYY-MM. Without a query on the command\n"
+              << "line, one query per line is read from standard input.\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string filename = "Global.csv";
+    std::string query;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if ((arg == "-i" || arg == "--input") && i + 1 < argc) {
+            filename = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            query += (query.empty() ? "" : " ") + arg;
+        }
+    }
+
+    ClimateTable table;
+    RangeIndex index;
+    std::string error;
+    if (!readClimateTable(filename, table, error) || !index.build(table, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    if (!query.empty()) {
+        if (!runRangeQuery(index, query, std::cout)) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return 0;
+    }
+
+    // Batch mode: a malformed line is reported and the rest still answered
+    std::ios::sync_with_stdio(false);
+    std::string line;
+    int status = 0;
+    while (std::getline(std::cin, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!runRangeQuery(index, line, std::cout)) {
+            std::cerr << "Invalid query: " << line << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
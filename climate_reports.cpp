@@ -0,0 +1,472 @@
+#include "climate_reports.h"
+
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+
+#include "adf_test.h"
+#include "extreme_events.h"
+#include "regression.h"
+#include "spectrum.h"
+
+void printRecordGaps(const RecordSet& records, std::ostream& out) {
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const SeriesRecords& r = records.months[month];
+        out << "Month: " << month + 1 << "\n";
+        for (size_t i = 0; i < r.gapyears.size(); ++i) {
+            out << "Gap Start Year: " << r.gapyears[i]
+                << ", Gap Size: " << r.gapsizes[i] << " years\n";
+        }
+    }
+}
+
+void printGapRegressions(const AnalysisPipeline& pipeline, std::ostream& out) {
+    const ClimateTable& table = pipeline.table();
+    const ResamplingOptions& options = pipeline.resampling();
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const RegressionResult& fit = pipeline.gapRegressions()[month];
+        RecordSignificance test = permutationRecordTest(table.years.data(), table.month(month).data(), table.size(),
+                                                        options, month, pipeline.pool());
+
+        out << "Month: " << month + 1 << "\n";
+        out << "Linear Regression Results:\n";
+        out << "Slope (m): " << fit.slope << "\nIntercept (b): " << fit.intercept << "\n";
+        out << "Slope permutation p-value: " << test.gapSlopePValue << "\n";
+        out << "Record highs: " << test.records << " (stationary expectation " << test.expectedRecords
+            << ", permutation p-value " << test.recordsPValue << ")\n";
+    }
+}
+
+void printWarmCoolAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    const std::array<WarmCoolSlopes, MONTHS_PER_YEAR>& slopes = pipeline.warmCoolSlopes();
+    const ResamplingOptions& options = pipeline.resampling();
+
+    // Compare the slopes for each month and interpret the results
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        out << "Month: " << month + 1 << "\n";
+        out << "Yearly Increase Slope: " << slopes[month].yearlyIncrease << "\n";
+        out << "Stationary Distribution Slope: " << slopes[month].stationaryDistribution << "\n";
+        out << "Slope Difference " << options.confidence * 100 << "% CI: [" << slopes[month].differenceLower << ", "
+            << slopes[month].differenceUpper << "]\n";
+
+        switch (classifyWarmCool(slopes[month])) {
+        case TREND_STATIONARY:
+            out << "Interpretation: Stationary climate change in this month.\n";
+            break;
+        case TREND_WARMING:
+            out << "Interpretation: Potential global warming in this month.\n";
+            break;
+        case TREND_COOLING:
+            out << "Interpretation: Potential global cooling in this month.\n";
+            break;
+        }
+
+        out << "\n";
+    }
+}
+
+void decadeTrendAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    for (const DecadeTrend& trend : pipeline.decadeTrends()) {
+        out << "Decade " << trend.startYear << "s: "
+            << "Trend Slope (m) = " << trend.slope << ", "
+            << "Intercept (b) = " << trend.intercept << ", "
+            << pipeline.resampling().confidence * 100 << "% CI = [" << trend.lower << ", " << trend.upper << "]\n";
+    }
+}
+
+bool printTrendAnalysis(const AnalysisPipeline& pipeline, const std::string& csvFilename, std::ostream& out,
+                        std::string& error) {
+    // Calculate overall trend
+    const RegressionResult& overall = pipeline.overallTrend();
+    const SlopeInterval& overallInterval = pipeline.overallInterval();
+    out << "Overall Trend: Slope (m) = " << overall.slope << ", Intercept (b) = " << overall.intercept << ", "
+        << pipeline.resampling().confidence * 100 << "% CI = [" << overallInterval.lower << ", "
+        << overallInterval.upper << "]\n";
+
+    // Decade-wise trend analysis
+    decadeTrendAnalysis(pipeline, out);
+    if (csvFilename.empty()) {
+        return true;
+    }
+
+    std::ofstream output_file(csvFilename);
+    if (!output_file) {
+        error = "Error opening file: " + csvFilename;
+        return false;
+    }
+    output_file << "Decade, Slope, Intercept, Lower, Upper\n";
+    output_file << "Overall," << overall.slope << "," << overall.intercept << "," << overallInterval.lower << ","
+                << overallInterval.upper << "\n";
+    for (const DecadeTrend& trend : pipeline.decadeTrends()) {
+        output_file << trend.startYear << "s," << trend.slope << "," << trend.intercept << "," << trend.lower << ","
+                    << trend.upper << "\n";
+    }
+    return true;
+}
+
+namespace {
+
+// Function to find the calendar years a window covers, inclusive as in the
+// decade and changepoint reports: those of the first and last point inside
+// [start, end), or the years the bounds fall in when no point is
+void windowYears(const std::vector<double>& x, const WindowTrend& window, int& first, int& last) {
+    if (window.last > window.first) {
+        first = static_cast<int>(std::floor(x[window.first]));
+        last = static_cast<int>(std::floor(x[window.last - 1]));
+    } else {
+        first = static_cast<int>(std::floor(window.start));
+        last = static_cast<int>(std::ceil(window.end)) - 1;
+    }
+}
+
+} // namespace
+
+bool printRollingTrendAnalysis(const ClimateTable& table, const RollingTrendOptions& options, bool monthly,
+                               const std::string& csvFilename, std::ostream& out, std::string& error) {
+    std::vector<double> x, y;
+    if (monthly) {
+        monthlyTimeSeries(table, x, y);
+    } else {
+        const Column<double>& jd = table.aggregate(AGG_JD);
+        x.assign(table.years.begin(), table.years.end());
+        y.assign(jd.begin(), jd.end());
+    }
+    const std::vector<WindowTrend> windows = computeRollingTrends(x, y, options);
+
+    out << (monthly ? "Monthly" : "J-D") << " trends in " << options.window << "-year windows every "
+        << options.stride << " years:\n";
+    if (windows.empty()) {
+        out << "  No complete " << options.window << "-year window fits the data";
+        if (!x.empty()) out << " (" << x.front() << " to " << x.back() << ")";
+        out << "; partial windows (--partial) keep the windows that run past its end\n";
+    }
+    int first, last;
+    for (const WindowTrend& window : windows) {
+        windowYears(x, window, first, last);
+        out << "  " << first << "-" << last << ": slope " << window.fit.slope * 10.0 << " per decade, intercept "
+            << window.fit.intercept << " (" << window.fit.n << " values)\n";
+    }
+    if (csvFilename.empty()) {
+        return true;
+    }
+
+    std::ofstream output_file(csvFilename);
+    if (!output_file) {
+        error = "Error opening file: " + csvFilename;
+        return false;
+    }
+    output_file << "First, Last, Slope, Intercept, SlopeStdError, N\n";
+    for (const WindowTrend& window : windows) {
+        windowYears(x, window, first, last);
+        output_file << first << "," << last << "," << window.fit.slope << "," << window.fit.intercept << ","
+                    << window.fit.slopeStdError << "," << window.fit.n << "\n";
+    }
+    if (!output_file.flush()) {
+        error = "Error writing file: " + csvFilename;
+        return false;
+    }
+    return true;
+}
+
+void printChangeSegments(const std::string& name, const ChangepointResult& result, std::ostream& out) {
+    out << name << ": " << result.changepoints() << " changepoints ("
+        << (result.method == CHANGE_PELT ? "PELT" : "binary segmentation") << ", penalty " << result.penalty
+        << ")\n";
+    for (const ChangeSegment& segment : result.segments) {
+        out << "  " << segment.start << "-" << segment.end << ": slope " << segment.fit.slope * 10.0
+            << " per decade, mean " << segment.mean << " (" << segment.fit.n << " values)\n";
+    }
+}
+
+void printChangepointAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    printChangeSegments("J-D", pipeline.jdChangepoints(), out);
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        printChangeSegments(monthName(month), pipeline.monthlyChangepoints()[month], out);
+    }
+}
+
+namespace {
+
+// Function to print one robust trend, slopes multiplied by scale
+void printRobustTrend(const std::string& name, const RobustTrend& trend, double leastSquaresSlope, double scale,
+                      const char* unit, std::ostream& out) {
+    out << "  " << name << ": Sen slope " << trend.slope * scale << " [" << trend.slopeLower * scale << ", "
+        << trend.slopeUpper * scale << "] " << unit << " (least squares " << leastSquaresSlope * scale
+        << "), tau " << trend.kendallTau << ", p = " << trend.pValue << " (" << trend.n << " values)\n";
+}
+
+} // namespace
+
+void printRobustTrendAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    out << "Theil-Sen slopes with " << pipeline.resampling().confidence * 100
+        << "% intervals, Mann-Kendall tau and two-sided p-values\n";
+    out << "Record gap size vs gap start year:\n";
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        printRobustTrend(monthName(month), pipeline.robustGapTrends()[month], pipeline.gapRegressions()[month].slope,
+                         1.0, "years per year", out);
+    }
+    out << "Monthly anomalies:\n";
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        printRobustTrend(monthName(month), pipeline.robustMonthlyTrends()[month],
+                         pipeline.monthlyTrends()[month].slope, 10.0, "per decade", out);
+    }
+
+    const AnnualSeries& series = pipeline.jdSeries();
+    if (series.years.empty()) {
+        return;
+    }
+    out << "J-D:\n";
+    printRobustTrend(std::to_string(static_cast<int>(series.years.front())) + "-" +
+                         std::to_string(static_cast<int>(series.years.back())),
+                     pipeline.robustOverallTrend(), pipeline.overallTrend().slope, 10.0, "per decade", out);
+
+    // Least squares fits of the same decades, without the bootstrap of decadeTrends
+    const std::vector<DecadeTrend> leastSquares = computeDecadeTrends(series.years, series.values);
+    out << "J-D decades:\n";
+    for (const RobustDecadeTrend& decade : pipeline.robustDecadeTrends()) {
+        double slope = NAN;
+        for (const DecadeTrend& fit : leastSquares) {
+            if (fit.startYear == decade.startYear) slope = fit.slope;
+        }
+        printRobustTrend(std::to_string(decade.startYear) + "s", decade.trend, slope, 10.0, "per decade", out);
+    }
+}
+
+void printSpectralAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    const ClimateTable& table = pipeline.table();
+    std::vector<double> time, values;
+    monthlyTimeSeries(table, time, values);
+    // Months not yet published end the series
+    while (!values.empty() && isMissing(values.back())) values.pop_back();
+    if (values.size() < 2 * 240) {
+        out << "Spectral analysis needs at least 40 years of months\n";
+        return;
+    }
+
+    // Periodogram of the whole series for the band variances
+    SpectrumPlan periodogram(values.size(), SpectrumOptions());
+    std::vector<double> power(periodogram.bins());
+    periodogram.compute(values.data(), 0, 1, 1, power.data(), pipeline.pool());
+    const double total = bandPower(periodogram, power.data(), 0.0, 6.0);
+    out << "Monthly series " << table.years[0] << "-" << table.years.back() << ": " << values.size()
+        << " months, detrended variance " << total << "\n";
+    static const struct { const char* name; double shortest, longest; } BANDS[] = {
+        {"2-7 years (ENSO)", 2.0, 7.0}, {"9-13 years (solar cycle)", 9.0, 13.0}, {"longer than 13 years", 13.0, 1e9}};
+    for (const auto& band : BANDS) {
+        const double variance = bandPower(periodogram, power.data(), 1.0 / band.longest, 1.0 / band.shortest);
+        out << "  " << band.name << ": " << variance << " (" << 100.0 * variance / total << "% of variance)\n";
+    }
+
+    // Welch spectrum at periods of 20 / k years
+    SpectrumOptions welchOptions;
+    welchOptions.segment = 240;
+    SpectrumPlan welch(values.size(), welchOptions);
+    std::vector<double> density(welch.bins());
+    welch.compute(values.data(), 0, 1, 1, density.data(), pipeline.pool());
+    out << "Welch spectrum, 20-year segments (" << welch.segments() << " segments):\n";
+    for (size_t k = 1; k < welch.bins() && welch.frequency(k) <= 1.0; ++k) {
+        out << "  Period " << 1.0 / welch.frequency(k) << " years: density " << density[k] << "\n";
+    }
+
+    // Each calendar month's annual series, all twelve in one batch
+    const size_t years = values.size() / MONTHS_PER_YEAR;
+    SpectrumOptions annualOptions;
+    annualOptions.sampleRate = 1.0;
+    SpectrumPlan annual(years, annualOptions);
+    std::vector<double> monthPower(MONTHS_PER_YEAR * annual.bins());
+    annual.compute(values.data(), 1, MONTHS_PER_YEAR, MONTHS_PER_YEAR, monthPower.data(), pipeline.pool());
+    out << "Calendar months (" << years << " years each):\n";
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const double* spectrum = &monthPower[month * annual.bins()];
+        const double variance = bandPower(annual, spectrum, 0.0, 0.5);
+        // Periods past 30 years mostly hold what the line left of the warming
+        out << "  " << monthName(month) << ": 2-7 year band "
+            << 100.0 * bandPower(annual, spectrum, 1.0 / 7.0, 0.5) / variance << "% of variance, peak at "
+            << 1.0 / annual.frequency(peakBin(annual, spectrum, 1.0 / 30.0, 0.5)) << " years\n";
+    }
+}
+
+void monthlyAnalysis(const ClimateTable& temperatureData, std::ostream& out) {
+    MonthDeviationStats stats[MONTHS_PER_YEAR];
+    computeMonthlyDeviationStats(temperatureData, stats);
+
+    // Identify months with the greatest positive and negative deviations
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        out << "Month " << month + 1 << " Deviations:\n";
+        out << "  Mean Deviation: " << stats[month].mean << "\n";
+        out << "  Max Deviation: " << stats[month].max << "\n";
+        out << "  Min Deviation: " << stats[month].min << "\n";
+    }
+}
+
+void yearlyAnalysis(const ClimateTable& temperatureData, std::ostream& out) {
+    for (const YearExtremes& data : computeYearExtremes(temperatureData)) {
+        out << "Year " << data.year << "\n";
+        if (data.hottestMonth < 0) {
+            out << "  No valid months\n";
+            continue;
+        }
+        out << "  Hottest Month: " << data.hottestMonth + 1 << " with anomaly of " << data.maxTemp << "\n";
+        out << "  Coldest Month: " << data.coldestMonth + 1 << " with anomaly of " << data.minTemp << "\n";
+    }
+}
+
+void printSeasonalAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    const RegressionResult& overall = pipeline.overallTrend();
+    out << "Overall Trend: Slope (m) = " << overall.slope << ", Intercept (b) = " << overall.intercept << "\n";
+
+    monthlyAnalysis(pipeline.table(), out);
+    yearlyAnalysis(pipeline.table(), out);
+}
+
+namespace {
+
+// Function to print a month of the stream as YYYY-MM
+void printYearMonth(std::ostream& out, int year, int month) {
+    out << year << "-" << (month < 9 ? "0" : "") << month + 1;
+}
+
+} // namespace
+
+void analyzeEventFrequencyDuration(const ClimateTable& data, int consecutiveMonthsThreshold, double amplitude,
+                                   std::ostream& out) {
+    analyzeEventFrequencyDuration(data, consecutiveMonthsThreshold, amplitudeThresholds(amplitude), out);
+}
+
+void analyzeEventFrequencyDuration(const ClimateTable& data, int consecutiveMonthsThreshold,
+                                   const MonthThresholds& thresholds, std::ostream& out) {
+    int heatwaveCount = 0, coldSnapCount = 0;
+
+    for (const AnomalyRun& run : detectAnomalyRuns(data, thresholds)) {
+        if (run.length < consecutiveMonthsThreshold) continue;
+        (run.warm ? heatwaveCount : coldSnapCount)++;
+
+        if (run.ongoing) {
+            out << "Ongoing " << (run.warm ? "heatwave" : "cold snap") << " since ";
+            printYearMonth(out, run.startYear, run.startMonth);
+        } else {
+            out << (run.warm ? "Heatwave" : "Cold snap") << " from ";
+            printYearMonth(out, run.startYear, run.startMonth);
+            out << " to ";
+            printYearMonth(out, run.endYear, run.endMonth);
+        }
+        out << " with a duration of " << run.length << " months, peak anomaly " << run.peak
+            << " and intensity " << run.intensity << " degree-months.\n";
+    }
+
+    out << "Total Heatwaves: " << heatwaveCount << "\n";
+    out << "Total Cold Snaps: " << coldSnapCount << "\n";
+}
+
+void printPercentileThresholds(const MonthThresholds& thresholds, const PercentileOptions& options,
+                               std::ostream& out) {
+    out << "Thresholds: " << options.upperPercentile << "th / " << options.lowerPercentile
+        << "th percentile of each month over ";
+    if (options.baseFirst == 0) {
+        out << "all years\n";
+    } else {
+        out << options.baseFirst << "-" << options.baseLast << "\n";
+    }
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        out << "  " << monthName(month) << ": heatwave above " << thresholds.upper[month] << ", cold snap below "
+            << thresholds.lower[month] << "\n";
+    }
+}
+
+void printThresholdSweep(const ClimateTable& data, const std::vector<double>& amplitudes, int maxDuration,
+                         std::ostream& out) {
+    ThresholdSweep sweep = sweepExtremeEvents(data, amplitudes, maxDuration);
+
+    out << "Amplitude,MinMonths,Heatwaves,ColdSnaps,HeatwaveMonths,ColdSnapMonths,HeatwaveIntensity,ColdSnapIntensity\n";
+    for (size_t a = 0; a < sweep.amplitudes.size(); ++a) {
+        for (int duration = 1; duration <= sweep.maxDuration; ++duration) {
+            const size_t i = sweep.index(a, duration);
+            out << sweep.amplitudes[a] << "," << duration << ","
+                << sweep.warmEvents[i] << "," << sweep.coldEvents[i] << ","
+                << sweep.warmMonths[i] << "," << sweep.coldMonths[i] << ","
+                << sweep.warmIntensity[i] << "," << sweep.coldIntensity[i] << "\n";
+        }
+    }
+}
+
+void printStationarityAnalysis(const AnalysisPipeline& pipeline, std::ostream& out) {
+    const ClimateTable& table = pipeline.table();
+
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const Column<double>& column = table.month(month);
+        out << "Month: " << monthName(month) << "\n";
+
+        const RegressionResult& fit = pipeline.monthlyTrends()[month];
+        if (!fit.valid()) {
+            out << "  No data available\n";
+            continue;
+        }
+        RegressionTests tests = regressionTests(fit);
+        out << "  Intercept: " << fit.intercept << " (t = " << tests.interceptT << ", p = " << tests.interceptPValue << ")\n";
+        out << "  Slope: " << fit.slope << " (t = " << tests.slopeT << ", p = " << tests.slopePValue << ")\n";
+        out << "  R-squared: " << fit.rSquared << "\n";
+        out << "  AR(1)-adjusted slope std error: " << fit.adjustedSlopeStdError << " (t = " << tests.adjustedSlopeT
+            << ", p = " << tests.adjustedSlopePValue << "; residual lag-1 autocorrelation "
+            << fit.lag1Autocorrelation << ", effective n " << fit.effectiveN << ")\n";
+
+        AdfResult adf = adfTest(column.data(), table.size(), AdfOptions());
+        if (!adf.valid()) {
+            out << "  ADF test: series too short or constant\n";
+            continue;
+        }
+        out << "  ADF test statistic: " << adf.statistic << "\n";
+        out << "  p-value: " << adf.pValue << "\n";
+        out << "  # lags used: " << adf.usedLag << "\n";
+        out << "  # observations: " << adf.nobs << "\n";
+        out << "  critical value (1%): " << adf.criticalValues[0] << "\n";
+        out << "  critical value (5%): " << adf.criticalValues[1] << "\n";
+        out << "  critical value (10%): " << adf.criticalValues[2] << "\n";
+    }
+}
+
+bool parseAmplitudes(const std::string& list, std::vector<double>& amplitudes) {
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        char* end;
+        double value = std::strtod(item.c_str(), &end);
+        if (item.empty() || *end != '\0' || !(value >= 0)) {
+            return false;
+        }
+        amplitudes.push_back(value);
+    }
+    return true;
+}
+
+bool parsePercentiles(const std::string& pair, PercentileOptions& options) {
+    char* end;
+    const double upper = std::strtod(pair.c_str(), &end);
+    if (end == pair.c_str() || *end != ',') {
+        return false;
+    }
+    const char* second = end + 1;
+    const double lower = std::strtod(second, &end);
+    if (end == second || *end != '\0' || !(lower >= 0 && lower < upper && upper <= 100)) {
+        return false;
+    }
+    options.upperPercentile = upper;
+    options.lowerPercentile = lower;
+    return true;
+}
+
+bool parseBaseYears(const std::string& pair, PercentileOptions& options) {
+    char* end;
+    const long first = std::strtol(pair.c_str(), &end, 10);
+    if (end == pair.c_str() || *end != ',') {
+        return false;
+    }
+    const char* second = end + 1;
+    const long last = std::strtol(second, &end, 10);
+    if (end == second || *end != '\0' || first < 1 || last < first) {
+        return false;
+    }
+    options.baseFirst = static_cast<int>(first);
+    options.baseLast = static_cast<int>(last);
+    return true;
+}
@@ -0,0 +1,105 @@
+#ifndef CLIMATE_REPORTS_H
+#define CLIMATE_REPORTS_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "analysis_pipeline.h"
+#include "climate_analysis.h"
+#include "climate_table.h"
+#include "extreme_events.h"
+#include "record_engine.h"
+#include "resampling.h"
+#include "rolling_trend.h"
+
+// Text reports of the original analysis programs. Each writes exactly what
+// the corresponding program printed, so the standalone programs and the
+// climate driver share one implementation. Reports take their intermediates
+// from an AnalysisPipeline, so reports run on one pipeline share them.
+
+// Gap start years and sizes between monthly records (parse_data)
+void printRecordGaps(const RecordSet& records, std::ostream& out);
+
+// Linear regression of gap size on gap start year per month, with the record
+// count and gap slope tested against a permutation null (linear_regression)
+void printGapRegressions(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Yearly increase vs stationary distribution slopes per month, classified by
+// a bootstrap interval of their difference (global_warm_cool)
+void printWarmCoolAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Function to print the linear trend for each calendar decade
+void decadeTrendAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Overall and decade J-D trends, also written to csvFilename unless it is
+// empty (decade_trend_analysis)
+bool printTrendAnalysis(const AnalysisPipeline& pipeline, const std::string& csvFilename, std::ostream& out,
+                        std::string& error);
+
+// Trends of the J-D series (or, with monthly, of the monthly series) in
+// windows of options.window years every options.stride years, also written
+// to csvFilename unless it is empty; both come from one computation and
+// label each window by the first and last year inside it (rolling)
+bool printRollingTrendAnalysis(const ClimateTable& table, const RollingTrendOptions& options, bool monthly,
+                               const std::string& csvFilename, std::ostream& out, std::string& error);
+
+// Segments of constant trend of the J-D series and of each month, found by
+// PELT, with each segment's slope (changepoints)
+void printChangepointAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Periodic variability of the monthly series: the variance in the ENSO (2-7
+// year), solar cycle (9-13 year) and longer bands, a Welch spectrum over
+// 20-year segments, and the ENSO band share of each calendar month (spectrum)
+void printSpectralAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Outlier-resistant trends: Theil-Sen slopes with their intervals and
+// Mann-Kendall tests of the record gaps and the anomalies of each month, of
+// J-D and of each J-D decade, beside the least squares slopes (robust)
+void printRobustTrendAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Function to print the segments of one changepoint result
+void printChangeSegments(const std::string& name, const ChangepointResult& result, std::ostream& out);
+
+// Function to analyze monthly deviations and identify months with the greatest deviations
+void monthlyAnalysis(const ClimateTable& temperatureData, std::ostream& out);
+
+// Function to analyze yearly mean deviations and identify the warmest and coldest years
+void yearlyAnalysis(const ClimateTable& temperatureData, std::ostream& out);
+
+// Overall trend, monthly and yearly analysis (seasional_analysis)
+void printSeasonalAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+// Heatwave and cold snap frequency and duration (extreme_event_frequency):
+// every run of at least consecutiveMonthsThreshold months beyond +/-amplitude,
+// following the monthly stream across year boundaries
+void analyzeEventFrequencyDuration(const ClimateTable& data, int consecutiveMonthsThreshold, double amplitude,
+                                   std::ostream& out);
+
+// The same against per-month thresholds, e.g. percentileThresholds
+void analyzeEventFrequencyDuration(const ClimateTable& data, int consecutiveMonthsThreshold,
+                                   const MonthThresholds& thresholds, std::ostream& out);
+
+// Warm and cold threshold of each month, with the percentiles and baseline they came from
+void printPercentileThresholds(const MonthThresholds& thresholds, const PercentileOptions& options,
+                               std::ostream& out);
+
+// Event counts, months and degree-month intensity for every amplitude and
+// minimum duration 1..maxDuration, as CSV
+void printThresholdSweep(const ClimateTable& data, const std::vector<double>& amplitudes, int maxDuration,
+                         std::ostream& out);
+
+// Function to parse a comma-separated list of non-negative anomaly thresholds
+bool parseAmplitudes(const std::string& list, std::vector<double>& amplitudes);
+
+// Function to parse "UPPER,LOWER" percentiles (0-100, lower below upper)
+bool parsePercentiles(const std::string& pair, PercentileOptions& options);
+
+// Function to parse a "FIRST,LAST" baseline of years
+bool parseBaseYears(const std::string& pair, PercentileOptions& options);
+
+// OLS fit with t statistics and p-values, and the Augmented Dickey-Fuller test
+// (constant, AIC lag selection) of each month (stats_test)
+void printStationarityAnalysis(const AnalysisPipeline& pipeline, std::ostream& out);
+
+#endif // CLIMATE_REPORTS_H
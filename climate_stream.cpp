@@ -0,0 +1,143 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <sstream>
+
+#include "climate_table.h"
+#include "stream_state.h"
+
+// Function to print the current analysis state
+void printSummary(const StreamState& state) {
+    std::cout << "Last month ingested: " << state.lastYear << "-" << state.lastMonth + 1 << "\n";
+
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const RecordTracker& r = state.records[month];
+        std::cout << "Month: " << month + 1
+                  << " Record High: " << r.maxValue << " (" << r.maxYear << ")"
+                  << " Record Low: " << r.minValue << " (" << r.minYear << ")"
+                  << " Records: " << r.recordCount;
+        RegressionResult gapFit = state.gapRegression[month].result();
+        if (gapFit.valid()) {
+            std::cout << " Gap Slope (m): " << gapFit.slope;
+        }
+        std::cout << "\n";
+    }
+
+    RegressionResult overall = state.overallTrend.result();
+    if (overall.valid()) {
+        std::cout << "Overall Trend: Slope (m) = " << overall.slope << ", Intercept (b) = " << overall.intercept
+                  << ", Std Error = " << overall.slopeStdError << " (AR(1)-adjusted " << overall.adjustedSlopeStdError
+                  << "), R^2 = " << overall.rSquared << "\n";
+    }
+    RegressionResult decade = state.decadeTrend.result();
+    if (decade.valid()) {
+        std::cout << "Decade " << state.decadeStart << "s: Trend Slope (m) = " << decade.slope
+                  << ", Intercept (b) = " << decade.intercept << "\n";
+    }
+
+    const EventCounter& e = state.events;
+    std::cout << "Total Heatwaves: " << e.heatwaveCount << " (longest " << e.longestHeatwave << " months"
+              << (e.inHeatwave() ? ", ongoing for " + std::to_string(e.run.length) + " months" : "") << ")\n";
+    std::cout << "Total Cold Snaps: " << e.coldSnapCount << " (longest " << e.longestColdSnap << " months"
+              << (e.inColdSnap() ? ", ongoing for " + std::to_string(e.run.length) + " months" : "") << ")\n";
+}
+
+// Function to ingest every complete line available on the stream. A trailing
+// line without a newline is kept in pending until the rest of it arrives.
+int ingestLines(std::istream& in, StreamState& state, std::string& pending) {
+    int added = 0;
+    std::string line, error;
+    int year;
+    double values[VALUE_COLUMNS];
+
+    while (std::getline(in, line)) {
+        if (in.eof()) {
+            pending += line;
+            break;
+        }
+        line = pending + line;
+        pending.clear();
+
+        RowStatus status = parseClimateRow(line.data(), line.data() + line.size(), year, values, error);
+        if (status == ROW_INVALID) {
+            std::cerr << "Skipping row: " << error << ": " << line << "\n";
+        } else if (status == ROW_OK) {
+            added += ingestRow(state, year, values);
+        }
+    }
+    return added;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <state-file> [input.csv] [--follow]\n"
+                  << "Reads new GISTEMP rows from input.csv (or stdin) and updates the checkpointed analysis state.\n";
+        return 1;
+    }
+
+    const std::string stateFilename = argv[1];
+    std::string inputFilename;
+    bool follow = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--follow") {
+            follow = true;
+        } else {
+            inputFilename = arg;
+        }
+    }
+    if (follow && inputFilename.empty()) {
+        std::cerr << "--follow needs an input file" << std::endl;
+        return 1;
+    }
+
+    StreamState state;
+    std::string error;
+    bool exists;
+    if (!loadStreamState(state, stateFilename, exists, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::ifstream file;
+    if (!inputFilename.empty()) {
+        file.open(inputFilename);
+        if (!file) {
+            std::cerr << "Error opening file: " << inputFilename << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = inputFilename.empty() ? std::cin : file;
+
+    std::string pending;
+    do {
+        // When stdin is closed the last line may lack its newline
+        int added = ingestLines(in, state, pending);
+        if (!follow && !pending.empty()) {
+            std::string last = pending + "\n";
+            std::istringstream tail(last);
+            pending.clear();
+            added += ingestLines(tail, state, pending);
+        }
+
+        if (added > 0 || !exists) {
+            if (!saveStreamState(state, stateFilename, error)) {
+                std::cerr << error << std::endl;
+                return 1;
+            }
+            exists = true;
+            printSummary(state);
+            std::cout.flush();
+        }
+
+        if (follow) {
+            // Wait for the file to grow, like tail -f
+            in.clear();
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    } while (follow);
+
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "climate_table.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "aggregation.h"
+
+namespace {
+
+const char* const MONTH_NAMES[MONTHS_PER_YEAR] = {
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+};
+
+const char* const AGGREGATE_NAMES[AGG_COUNT] = {
+    "J-D", "D-N", "DJF", "MAM", "JJA", "SON"
+};
+
+const double MISSING = std::numeric_limits<double>::quiet_NaN();
+
+// Function to parse one numeric cell; "***" and empty cells are missing
+bool parseCell(const char* begin, const char* end, double& value) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+
+    if (begin == end || (end - begin == 3 && std::memcmp(begin, "***", 3) == 0)) {
+        value = MISSING;
+        return true;
+    }
+
+    // from_chars rejects a leading '+', which some exports use
+    if (*begin == '+') ++begin;
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// Function to check that a line starts with the Year,Jan..Dec header cells
+bool isHeaderLine(const char* begin, const char* end) {
+    if (end > begin && end[-1] == '\r') --end;
+    const char* p = begin;
+    for (int column = -1; column < MONTHS_PER_YEAR; ++column) {
+        const char* fieldEnd = static_cast<const char*>(std::memchr(p, ',', end - p));
+        if (!fieldEnd) fieldEnd = end;
+        const char* cell = p;
+        const char* cellEnd = fieldEnd;
+        while (cell < cellEnd && (*cell == ' ' || *cell == '\t')) ++cell;
+        while (cellEnd > cell && (cellEnd[-1] == ' ' || cellEnd[-1] == '\t')) --cellEnd;
+        const char* name = column < 0 ? "Year" : MONTH_NAMES[column];
+        const size_t length = std::strlen(name);
+        if (static_cast<size_t>(cellEnd - cell) != length || std::memcmp(cell, name, length) != 0) return false;
+        if (fieldEnd == end) return column + 1 == MONTHS_PER_YEAR;
+        p = fieldEnd + 1;
+    }
+    return true;
+}
+
+} // namespace
+
+void ClimateTable::clear() {
+    years.clear();
+    for (auto& column : monthly) column.clear();
+    for (auto& column : aggregates) column.clear();
+    mapping.reset();
+}
+
+void ClimateTable::reserve(size_t rows) {
+    years.reserve(rows);
+    for (auto& column : monthly) column.reserve(rows);
+    for (auto& column : aggregates) column.reserve(rows);
+}
+
+const char* monthName(int m) {
+    return (m >= 0 && m < MONTHS_PER_YEAR) ? MONTH_NAMES[m] : "?";
+}
+
+const char* aggregateName(AggregateColumn c) {
+    return (c >= 0 && c < AGG_COUNT) ? AGGREGATE_NAMES[c] : "?";
+}
+
+RowStatus parseClimateRow(const char* begin, const char* end, int& year, double values[VALUE_COLUMNS], std::string& error) {
+    if (end > begin && end[-1] == '\r') --end;
+
+    const char* p = begin;
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+
+    // Title ("Land-Ocean: Global Means"), header ("Year,...") and blank lines
+    if (p == end || *p < '0' || *p > '9') {
+        return ROW_SKIPPED;
+    }
+
+    auto yearResult = std::from_chars(p, end, year);
+    if (yearResult.ec != std::errc() || (yearResult.ptr != end && *yearResult.ptr != ',')) {
+        error = "invalid year";
+        return ROW_INVALID;
+    }
+    p = yearResult.ptr;
+
+    for (int column = 0; column < VALUE_COLUMNS; ++column) {
+        values[column] = MISSING;
+        if (p >= end) continue;
+
+        const char* fieldBegin = p + 1; // skip the separating comma
+        const char* fieldEnd = static_cast<const char*>(std::memchr(fieldBegin, ',', end - fieldBegin));
+        if (!fieldEnd) fieldEnd = end;
+
+        if (!parseCell(fieldBegin, fieldEnd, values[column])) {
+            const char* name = column < MONTHS_PER_YEAR
+                ? monthName(column)
+                : aggregateName(static_cast<AggregateColumn>(column - MONTHS_PER_YEAR));
+            error = "invalid value '" + std::string(fieldBegin, fieldEnd) + "' in column " + name;
+            return ROW_INVALID;
+        }
+        p = fieldEnd;
+    }
+
+    return ROW_OK;
+}
+
+bool parseClimateTable(const char* data, size_t length, ClimateTable& table, std::string& error) {
+    table.clear();
+
+    // One row per line is a safe upper bound and avoids regrowing every column
+    size_t lineCount = 1;
+    for (const char* p = data; (p = static_cast<const char*>(std::memchr(p, '\n', data + length - p))) != nullptr; ++p) {
+        ++lineCount;
+    }
+    table.reserve(lineCount);
+
+    const char* cursor = data;
+    const char* const bufferEnd = data + length;
+    size_t lineNumber = 0;
+    int year = 0;
+    double values[VALUE_COLUMNS];
+
+    while (cursor < bufferEnd) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', bufferEnd - cursor));
+        const char* next = lineEnd ? lineEnd + 1 : bufferEnd;
+        if (!lineEnd) lineEnd = bufferEnd;
+        ++lineNumber;
+
+        RowStatus status = parseClimateRow(cursor, lineEnd, year, values, error);
+        if (status == ROW_INVALID) {
+            error = "line " + std::to_string(lineNumber) + ": " + error;
+            return false;
+        }
+        if (status == ROW_OK) {
+            table.years.push_back(year);
+            for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+                table.monthly[m].push_back(values[m]);
+            }
+            for (int a = 0; a < AGG_COUNT; ++a) {
+                table.aggregates[a].push_back(values[MONTHS_PER_YEAR + a]);
+            }
+        }
+
+        cursor = next;
+    }
+
+    return true;
+}
+
+bool hasClimateHeader(const std::string& filename) {
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        const char* begin = line.data();
+        const char* end = begin + line.size();
+        if (isHeaderLine(begin, end)) return true;
+        const char* p = begin;
+        while (p < end && (*p == ' ' || *p == '\t')) ++p;
+        if (p < end && *p >= '0' && *p <= '9') return false; // data before any header
+    }
+    return false;
+}
+
+bool readClimateCsv(const std::string& filename, ClimateTable& table, std::string& error) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        error = "Error opening file: " + filename;
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::string buffer(static_cast<size_t>(size), '\0');
+    if (size > 0 && !file.read(&buffer[0], size)) {
+        error = "Error reading file: " + filename;
+        return false;
+    }
+
+    if (!parseClimateTable(buffer.data(), buffer.size(), table, error)) {
+        error = filename + ": " + error;
+        return false;
+    }
+    deriveMissingAggregates(table);
+    return true;
+}
+
+void monthlyTimeSeries(const ClimateTable& table, std::vector<double>& time, std::vector<double>& values) {
+    time.resize(table.size() * MONTHS_PER_YEAR);
+    values.resize(table.size() * MONTHS_PER_YEAR);
+
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const Column<double>& column = table.month(month);
+        const double offset = (month + 0.5) / MONTHS_PER_YEAR;
+        for (size_t row = 0; row < table.size(); ++row) {
+            time[row * MONTHS_PER_YEAR + month] = table.years[row] + offset;
+            values[row * MONTHS_PER_YEAR + month] = column[row];
+        }
+    }
+}
@@ -0,0 +1,154 @@
+#ifndef CLIMATE_TABLE_H
+#define CLIMATE_TABLE_H
+
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Number of monthly columns (Jan..Dec) in a GISTEMP table
+const int MONTHS_PER_YEAR = 12;
+
+// Aggregate columns that follow the monthly columns in a GISTEMP table
+enum AggregateColumn {
+    AGG_JD = 0, // January-December mean
+    AGG_DN,     // December-November mean
+    AGG_DJF,    // Winter (previous December, January, February)
+    AGG_MAM,    // Spring
+    AGG_JJA,    // Summer
+    AGG_SON,    // Autumn
+    AGG_COUNT
+};
+
+// One column of a ClimateTable. A column either owns its values or borrows
+// them from a read-only mapping of a table cache (see table_cache.h), so that
+// a cached dataset is used in place without copying. Any modification first
+// copies borrowed values into owned storage.
+template <typename T>
+class Column {
+public:
+    size_t size() const { return borrowed_ ? borrowedSize_ : owned_.size(); }
+    bool empty() const { return size() == 0; }
+    const T* data() const { return borrowed_ ? borrowed_ : owned_.data(); }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+    const T& operator[](size_t i) const { return data()[i]; }
+    const T& back() const { return data()[size() - 1]; }
+
+    // Function to point the column at values owned by someone else
+    void borrow(const T* values, size_t count) {
+        owned_.clear();
+        owned_.shrink_to_fit();
+        borrowed_ = values;
+        borrowedSize_ = count;
+    }
+
+    // Function to get writable values, copying borrowed ones first
+    T* mutableData() {
+        detach();
+        return owned_.data();
+    }
+
+    void push_back(T value) {
+        detach();
+        owned_.push_back(value);
+    }
+    void reserve(size_t count) {
+        detach();
+        owned_.reserve(count);
+    }
+    void resize(size_t count) {
+        detach();
+        owned_.resize(count);
+    }
+    void clear() {
+        borrowed_ = nullptr;
+        borrowedSize_ = 0;
+        owned_.clear();
+    }
+
+private:
+    void detach() {
+        if (borrowed_) {
+            owned_.assign(borrowed_, borrowed_ + borrowedSize_);
+            borrowed_ = nullptr;
+            borrowedSize_ = 0;
+        }
+    }
+
+    std::vector<T> owned_;
+    const T* borrowed_ = nullptr;
+    size_t borrowedSize_ = 0;
+};
+
+// Structure-of-arrays view of a GISTEMP dataset. Every field is stored as its
+// own contiguous column so analyses can walk one month (or aggregate) at a
+// time without touching the rest of the row. Missing values ("***") are NaN.
+struct ClimateTable {
+    Column<int> years;
+    Column<double> monthly[MONTHS_PER_YEAR];
+    Column<double> aggregates[AGG_COUNT];
+
+    // Keeps a mapped cache alive while any column borrows from it
+    std::shared_ptr<const void> mapping;
+
+    size_t size() const { return years.size(); }
+    bool empty() const { return years.empty(); }
+
+    // Column accessors; month is 0-based (0 = January)
+    const Column<double>& month(int m) const { return monthly[m]; }
+    const Column<double>& aggregate(AggregateColumn c) const { return aggregates[c]; }
+
+    void clear();
+    void reserve(size_t rows);
+};
+
+// Returns true if the value was read from a "***" (or empty) cell
+inline bool isMissing(double value) {
+    return std::isnan(value);
+}
+
+// Column header names, in file order after "Year"
+const char* monthName(int m);
+const char* aggregateName(AggregateColumn c);
+
+// Number of value columns that follow "Year" on a data row
+const int VALUE_COLUMNS = MONTHS_PER_YEAR + AGG_COUNT;
+
+// Outcome of parsing a single CSV line
+enum RowStatus {
+    ROW_OK,      // data row parsed into year and values
+    ROW_SKIPPED, // title, header or blank line
+    ROW_INVALID  // malformed data row; error describes the problem
+};
+
+// Function to parse one CSV line (without its newline) into a year and the
+// twelve monthly plus six aggregate values, in file column order.
+RowStatus parseClimateRow(const char* begin, const char* end, int& year, double values[VALUE_COLUMNS], std::string& error);
+
+// Function to parse a GISTEMP CSV held in memory. Title and header lines are
+// skipped, "***" cells become NaN and short rows are padded with NaN.
+// Returns false and fills error on the first malformed data row.
+bool parseClimateTable(const char* data, size_t length, ClimateTable& table, std::string& error);
+
+// Function to read a whole GISTEMP CSV file into a ClimateTable, without
+// consulting or writing the binary cache. A monthly-only file (Year,Jan..Dec)
+// gets its aggregate columns derived from the months (see aggregation.h).
+bool readClimateCsv(const std::string& filename, ClimateTable& table, std::string& error);
+
+// Function to tell a GISTEMP table from other CSV layouts: true when a
+// "Year,Jan,...,Dec" header comes before the first data line. Files that
+// cannot be opened are not tables.
+bool hasClimateHeader(const std::string& filename);
+
+// Function to load a GISTEMP CSV through its binary cache: a valid cache
+// beside the file is mapped in place, otherwise the CSV is parsed and the
+// cache rebuilt for the next run (see table_cache.h)
+bool readClimateTable(const std::string& filename, ClimateTable& table, std::string& error);
+
+// Function to flatten the monthly columns into one time-ordered series with
+// time = year + (month + 0.5) / 12, i.e. the middle of each month in years
+void monthlyTimeSeries(const ClimateTable& table, std::vector<double>& time, std::vector<double>& values);
+
+#endif // CLIMATE_TABLE_H
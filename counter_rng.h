@@ -0,0 +1,82 @@
+#ifndef COUNTER_RNG_H
+#define COUNTER_RNG_H
+
+#include <cstdint>
+
+// Counter-based random numbers (Philox4x32-10, Salmon et al. 2011). Every
+// output is a pure function of (seed, stream, replicate, position), so a
+// resample draws the same numbers whichever thread computes it and in
+// whatever order: results do not depend on the number of threads. Resampling
+// code uses one stream per series and one replicate per resample.
+class CounterRng {
+public:
+    CounterRng(std::uint64_t seed, std::uint64_t stream, std::uint32_t replicate)
+        : key0_(static_cast<std::uint32_t>(seed)),
+          key1_(static_cast<std::uint32_t>(seed >> 32)),
+          replicate_(replicate),
+          stream0_(static_cast<std::uint32_t>(stream)),
+          stream1_(static_cast<std::uint32_t>(stream >> 32)) {
+    }
+
+    // Function to return the next 32 random bits
+    std::uint32_t next() {
+        if (used_ == 4) {
+            refill();
+        }
+        return block_[used_++];
+    }
+
+    // Function to return a uniform integer in [0, bound), bound > 0, without
+    // modulo bias (Lemire's multiply-and-reject)
+    std::uint32_t below(std::uint32_t bound) {
+        std::uint64_t product = static_cast<std::uint64_t>(next()) * bound;
+        std::uint32_t low = static_cast<std::uint32_t>(product);
+        if (low < bound) {
+            const std::uint32_t floor = static_cast<std::uint32_t>(-bound) % bound;
+            while (low < floor) {
+                product = static_cast<std::uint64_t>(next()) * bound;
+                low = static_cast<std::uint32_t>(product);
+            }
+        }
+        return static_cast<std::uint32_t>(product >> 32);
+    }
+
+    // Function to return a uniform double in [0, 1) with 53 random bits
+    double uniform() {
+        const std::uint64_t high = next() >> 5;
+        const std::uint64_t low = next() >> 6;
+        return static_cast<double>((high << 26) | low) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    void refill() {
+        std::uint32_t c0 = position_++, c1 = replicate_, c2 = stream0_, c3 = stream1_;
+        std::uint32_t k0 = key0_, k1 = key1_;
+        for (int round = 0; round < 10; ++round) {
+            const std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * c0;
+            const std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * c2;
+            const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<std::uint32_t>(p1);
+            c3 = static_cast<std::uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        block_[0] = c0;
+        block_[1] = c1;
+        block_[2] = c2;
+        block_[3] = c3;
+        used_ = 0;
+    }
+
+    std::uint32_t key0_, key1_;
+    std::uint32_t replicate_;
+    std::uint32_t stream0_, stream1_;
+    std::uint32_t position_ = 0;
+    std::uint32_t block_[4] = {0, 0, 0, 0};
+    int used_ = 4;
+};
+
+#endif // COUNTER_RNG_H
@@ -0,0 +1,95 @@
+#include "distributions.h"
+
+#include <cmath>
+
+namespace {
+
+// Continued fraction of the incomplete beta function (modified Lentz method)
+double betaContinuedFraction(double a, double b, double x) {
+    const double TINY = 1e-300;
+    const double EPSILON = 1e-15;
+    const int MAX_ITERATIONS = 500;
+
+    auto clamp = [&](double v) { return std::fabs(v) < TINY ? TINY : v; };
+
+    double c = 1.0;
+    double d = 1.0 / clamp(1.0 - (a + b) * x / (a + 1.0));
+    double h = d;
+    for (int m = 1; m <= MAX_ITERATIONS; ++m) {
+        const double m2 = 2.0 * m;
+
+        // Even step
+        double term = m * (b - m) * x / ((a - 1.0 + m2) * (a + m2));
+        d = 1.0 / clamp(1.0 + term * d);
+        c = clamp(1.0 + term / c);
+        h *= d * c;
+
+        // Odd step
+        term = -(a + m) * (a + b + m) * x / ((a + m2) * (a + 1.0 + m2));
+        d = 1.0 / clamp(1.0 + term * d);
+        c = clamp(1.0 + term / c);
+        const double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.0) < EPSILON) break;
+    }
+    return h;
+}
+
+} // namespace
+
+double normalCdf(double x) {
+    return 0.5 * std::erfc(-x / std::sqrt(2.0));
+}
+
+double normalQuantile(double p) {
+    if (!(p > 0.0 && p < 1.0)) return p == 0.0 ? -INFINITY : (p == 1.0 ? INFINITY : NAN);
+
+    // Acklam's rational approximation (relative error 1.15e-9)
+    static const double A[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double B[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double C[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double D[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double LOW = 0.02425;
+
+    double x;
+    if (p < LOW || p > 1.0 - LOW) {
+        const double q = std::sqrt(-2.0 * std::log(p < LOW ? p : 1.0 - p));
+        x = (((((C[0] * q + C[1]) * q + C[2]) * q + C[3]) * q + C[4]) * q + C[5]) /
+            ((((D[0] * q + D[1]) * q + D[2]) * q + D[3]) * q + 1.0);
+        if (p > LOW) x = -x;
+    } else {
+        const double q = p - 0.5;
+        const double r = q * q;
+        x = (((((A[0] * r + A[1]) * r + A[2]) * r + A[3]) * r + A[4]) * r + A[5]) * q /
+            (((((B[0] * r + B[1]) * r + B[2]) * r + B[3]) * r + B[4]) * r + 1.0);
+    }
+
+    // One Halley step brings it to full double precision
+    const double error = normalCdf(x) - p;
+    const double u = error * std::sqrt(2.0 * M_PI) * std::exp(0.5 * x * x);
+    return x - u / (1.0 + 0.5 * x * u);
+}
+
+double incompleteBeta(double a, double b, double x) {
+    if (!(x > 0.0)) return x == 0.0 ? 0.0 : NAN;
+    if (!(x < 1.0)) return x == 1.0 ? 1.0 : NAN;
+
+    const double logFront = std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b)
+                          + a * std::log(x) + b * std::log1p(-x);
+
+    // The continued fraction converges quickly on the side of the mean
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return std::exp(logFront) * betaContinuedFraction(a, b, x) / a;
+    }
+    return 1.0 - std::exp(logFront) * betaContinuedFraction(b, a, 1.0 - x) / b;
+}
+
+double studentTTwoSidedPValue(double t, double df) {
+    if (std::isnan(t) || !(df > 0.0)) return NAN;
+    if (std::isinf(t)) return 0.0;
+    return incompleteBeta(0.5 * df, 0.5, df / (df + t * t));
+}
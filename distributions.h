@@ -0,0 +1,20 @@
+#ifndef DISTRIBUTIONS_H
+#define DISTRIBUTIONS_H
+
+// Distribution functions needed for p-values of the statistical tests
+
+// Function to evaluate the standard normal distribution function
+double normalCdf(double x);
+
+// Function to invert the standard normal distribution function; NaN outside
+// (0, 1)
+double normalQuantile(double p);
+
+// Function to evaluate the regularized incomplete beta function I_x(a, b)
+double incompleteBeta(double a, double b, double x);
+
+// Function to compute the two-sided p-value of a t statistic with df degrees
+// of freedom; NaN when either is undefined
+double studentTTwoSidedPValue(double t, double df);
+
+#endif // DISTRIBUTIONS_H
@@ -0,0 +1,169 @@
+#include "extreme_events.h"
+
+#include <algorithm>
+
+namespace {
+
+// Function to call visit(year, month, value) for each month of the table in
+// time order, stopping at the last published month so that the "***" cells of
+// the current year do not close a run that is still ongoing
+template <typename Visit>
+void forEachMonth(const ClimateTable& table, Visit visit) {
+    size_t rows = table.size();
+    int lastMonth = MONTHS_PER_YEAR - 1;
+    while (rows > 0) {
+        while (lastMonth >= 0 && isMissing(table.month(lastMonth)[rows - 1])) --lastMonth;
+        if (lastMonth >= 0) break;
+        --rows;
+        lastMonth = MONTHS_PER_YEAR - 1;
+    }
+
+    for (size_t row = 0; row < rows; ++row) {
+        const int months = row + 1 == rows ? lastMonth + 1 : MONTHS_PER_YEAR;
+        for (int month = 0; month < months; ++month) {
+            visit(table.years[row], month, table.month(month)[row]);
+        }
+    }
+}
+
+// Per-length bins of one amplitude threshold
+struct LengthBins {
+    std::vector<int> events;
+    std::vector<int> months;
+    std::vector<double> intensity;
+
+    explicit LengthBins(int maxDuration) : events(maxDuration), months(maxDuration), intensity(maxDuration) {}
+
+    void add(const AnomalyRun& run) {
+        const size_t bin = std::min<size_t>(run.length, events.size()) - 1;
+        ++events[bin];
+        months[bin] += run.length;
+        intensity[bin] += run.intensity;
+    }
+
+    // Function to turn the bins into "at least d months" totals
+    void accumulate(int* eventsOut, int* monthsOut, double* intensityOut) const {
+        int eventTotal = 0, monthTotal = 0;
+        double intensityTotal = 0.0;
+        for (size_t bin = events.size(); bin-- > 0;) {
+            eventTotal += events[bin];
+            monthTotal += months[bin];
+            intensityTotal += intensity[bin];
+            eventsOut[bin] = eventTotal;
+            monthsOut[bin] = monthTotal;
+            intensityOut[bin] = intensityTotal;
+        }
+    }
+};
+
+} // namespace
+
+bool RunState::current(AnomalyRun& run) const {
+    if (sign == 0) {
+        return false;
+    }
+    run = {sign > 0, true, startYear, startMonth, lastYear, lastMonth, length, peak, intensity};
+    return true;
+}
+
+MonthThresholds amplitudeThresholds(double amplitude) {
+    MonthThresholds thresholds;
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        thresholds.upper[month] = amplitude;
+        thresholds.lower[month] = -amplitude;
+    }
+    return thresholds;
+}
+
+template <typename T>
+void sketchMonths(const T* series, size_t months, int startYear, const PercentileOptions& options,
+                  QuantileSketch sketches[MONTHS_PER_YEAR]) {
+    for (size_t t = 0; t < months; ++t) {
+        if (options.inBase(startYear + static_cast<int>(t / MONTHS_PER_YEAR))) {
+            sketches[t % MONTHS_PER_YEAR].add(series[t]);
+        }
+    }
+}
+
+MonthThresholds sketchThresholds(const QuantileSketch sketches[MONTHS_PER_YEAR], const PercentileOptions& options) {
+    MonthThresholds thresholds;
+    const double levels[2] = {options.upperPercentile / 100.0, options.lowerPercentile / 100.0};
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        double values[2];
+        sketches[month].quantiles(levels, 2, values);
+        thresholds.upper[month] = values[0];
+        thresholds.lower[month] = values[1];
+    }
+    return thresholds;
+}
+
+MonthThresholds percentileThresholds(const ClimateTable& table, const PercentileOptions& options) {
+    std::vector<QuantileSketch> sketches(MONTHS_PER_YEAR, QuantileSketch(options.sketchSize));
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const Column<double>& column = table.month(month);
+        for (size_t row = 0; row < table.size(); ++row) {
+            if (options.inBase(table.years[row])) sketches[month].add(column[row]);
+        }
+    }
+    return sketchThresholds(sketches.data(), options);
+}
+
+std::vector<AnomalyRun> detectAnomalyRuns(const ClimateTable& table, double amplitude) {
+    return detectAnomalyRuns(table, amplitudeThresholds(amplitude));
+}
+
+std::vector<AnomalyRun> detectAnomalyRuns(const ClimateTable& table, const MonthThresholds& thresholds) {
+    std::vector<AnomalyRun> runs;
+    RunState state;
+
+    AnomalyRun run;
+    forEachMonth(table, [&](int year, int month, double value) {
+        if (state.add(year, month, value, thresholds.upper[month], thresholds.lower[month], run)) runs.push_back(run);
+    });
+    if (state.current(run)) runs.push_back(run);
+    return runs;
+}
+
+ThresholdSweep sweepExtremeEvents(const ClimateTable& table, const std::vector<double>& amplitudes, int maxDuration) {
+    ThresholdSweep sweep;
+    sweep.amplitudes = amplitudes;
+    sweep.maxDuration = maxDuration;
+    if (amplitudes.empty() || maxDuration < 1) {
+        return sweep;
+    }
+
+    std::vector<RunState> states(amplitudes.size());
+    for (size_t a = 0; a < amplitudes.size(); ++a) {
+        states[a].amplitude = amplitudes[a];
+    }
+    std::vector<LengthBins> warm(amplitudes.size(), LengthBins(maxDuration));
+    std::vector<LengthBins> cold(amplitudes.size(), LengthBins(maxDuration));
+
+    AnomalyRun run;
+    forEachMonth(table, [&](int year, int month, double value) {
+        for (size_t a = 0; a < states.size(); ++a) {
+            if (states[a].add(year, month, value, run)) (run.warm ? warm : cold)[a].add(run);
+        }
+    });
+
+    const size_t cells = amplitudes.size() * maxDuration;
+    sweep.warmEvents.resize(cells);
+    sweep.coldEvents.resize(cells);
+    sweep.warmIntensity.resize(cells);
+    sweep.coldIntensity.resize(cells);
+    sweep.warmMonths.resize(cells);
+    sweep.coldMonths.resize(cells);
+
+    for (size_t a = 0; a < states.size(); ++a) {
+        if (states[a].current(run)) (run.warm ? warm : cold)[a].add(run);
+
+        const size_t first = sweep.index(a, 1);
+        warm[a].accumulate(&sweep.warmEvents[first], &sweep.warmMonths[first], &sweep.warmIntensity[first]);
+        cold[a].accumulate(&sweep.coldEvents[first], &sweep.coldMonths[first], &sweep.coldIntensity[first]);
+    }
+    return sweep;
+}
+
+template void sketchMonths<float>(const float*, size_t, int, const PercentileOptions&, QuantileSketch[MONTHS_PER_YEAR]);
+template void sketchMonths<double>(const double*, size_t, int, const PercentileOptions&,
+                                   QuantileSketch[MONTHS_PER_YEAR]);
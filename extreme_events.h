@@ -0,0 +1,203 @@
+#ifndef EXTREME_EVENTS_H
+#define EXTREME_EVENTS_H
+
+#include <cstddef>
+#include <vector>
+
+#include "climate_table.h"
+#include "period_calendar.h"
+#include "quantile_sketch.h"
+
+// One maximal run of consecutive warm (anomaly > +amplitude) or cold
+// (anomaly < -amplitude) months. Runs follow the continuous monthly stream, so
+// a run that starts in November and ends in February is one run. Missing
+// months, and gaps between table years, end a run. Months are 0-based; for a
+// series of another calendar they hold periods and lengths count periods.
+struct AnomalyRun {
+    bool warm;
+    bool ongoing;     // still open at the end of the data
+    int startYear;
+    int startMonth;
+    int endYear;      // last month that is part of the run
+    int endMonth;
+    int length;       // in months
+    double peak;      // most extreme anomaly of the run (signed)
+    double intensity; // cumulative degree-months: sum of the run's anomalies
+};
+
+// Run-length state machine for one amplitude threshold, fed one month at a
+// time. Plain data so that it can be checkpointed byte for byte.
+struct RunState {
+    double amplitude = 0.0;
+    int sign = 0;         // +1 inside a warm run, -1 inside a cold run, 0 outside
+    int length = 0;
+    int startYear = 0;
+    int startMonth = 0;
+    int lastYear = -1;    // last month added, to detect gaps in the stream
+    int lastMonth = -1;
+    double peak = 0.0;
+    double intensity = 0.0;
+
+    // Function to add the next month, or the next period of another calendar
+    // (see period_calendar.h). Returns true and fills ended when the period
+    // (or a gap before it) closes the current run; the period may then start
+    // a run of the opposite sign.
+    template <typename Calendar = MonthlyCalendar>
+    bool add(int year, int month, double anomaly, AnomalyRun& ended);
+
+    // Function to add the next period against its own thresholds instead of
+    // +/-amplitude: warm above upper, cold below lower. NaN thresholds make
+    // the period neither.
+    template <typename Calendar = MonthlyCalendar>
+    bool add(int year, int month, double anomaly, double upper, double lower, AnomalyRun& ended);
+
+    // Function to describe the open run, if any, with ongoing set
+    bool current(AnomalyRun& run) const;
+};
+
+// Heatwave / cold snap counts at one duration threshold, fed one month at a
+// time: an event is a run of at least threshold months and is counted as soon
+// as it reaches that length.
+struct EventCounter {
+    int threshold = 3;
+    RunState run;
+    int heatwaveCount = 0;
+    int coldSnapCount = 0;
+    int longestHeatwave = 0; // in months, including an ongoing event
+    int longestColdSnap = 0;
+
+    // Function to add the next month (0 = January), or period of Calendar
+    template <typename Calendar = MonthlyCalendar>
+    void add(int year, int month, double anomaly);
+
+    // Function to add the next month against its own thresholds
+    template <typename Calendar = MonthlyCalendar>
+    void add(int year, int month, double anomaly, double upper, double lower);
+
+    bool inHeatwave() const { return run.sign > 0 && run.length >= threshold; }
+    bool inColdSnap() const { return run.sign < 0 && run.length >= threshold; }
+};
+
+template <typename Calendar>
+bool RunState::add(int year, int month, double anomaly, AnomalyRun& ended) {
+    return add<Calendar>(year, month, anomaly, amplitude, -amplitude, ended);
+}
+
+template <typename Calendar>
+bool RunState::add(int year, int month, double anomaly, double upper, double lower, AnomalyRun& ended) {
+    bool closed = false;
+    const bool contiguous = Calendar::sequence(year, month) == Calendar::sequence(lastYear, lastMonth) + 1;
+
+    // NaN compares false both ways, so a missing month is neither warm nor cold
+    const int direction = anomaly > upper ? 1 : (anomaly < lower ? -1 : 0);
+    if (sign != 0 && (direction != sign || !contiguous)) {
+        closed = current(ended);
+        ended.ongoing = false;
+        sign = 0;
+        length = 0;
+    }
+    lastYear = year;
+    lastMonth = month;
+
+    if (direction != 0) {
+        if (sign == 0) {
+            sign = direction;
+            startYear = year;
+            startMonth = month;
+            peak = anomaly;
+            intensity = 0.0;
+        }
+        ++length;
+        intensity += anomaly;
+        if (direction * anomaly > direction * peak) peak = anomaly;
+    }
+    return closed;
+}
+
+template <typename Calendar>
+void EventCounter::add(int year, int month, double anomaly) {
+    add<Calendar>(year, month, anomaly, run.amplitude, -run.amplitude);
+}
+
+template <typename Calendar>
+void EventCounter::add(int year, int month, double anomaly, double upper, double lower) {
+    AnomalyRun ended;
+    run.add<Calendar>(year, month, anomaly, upper, lower, ended);
+
+    if (run.length < threshold) {
+        return;
+    }
+    if (run.sign > 0) {
+        if (run.length == threshold) ++heatwaveCount;
+        if (run.length > longestHeatwave) longestHeatwave = run.length;
+    } else {
+        if (run.length == threshold) ++coldSnapCount;
+        if (run.length > longestColdSnap) longestColdSnap = run.length;
+    }
+}
+
+// Event statistics for every pair of amplitude threshold and minimum duration
+// 1..maxDuration, built from one pass over the data. Each run is binned by
+// length (runs longer than maxDuration share the last bin); the totals for
+// "at least d months" are suffix sums over the bins.
+struct ThresholdSweep {
+    std::vector<double> amplitudes;
+    int maxDuration = 24;
+
+    // Indexed [amplitude * maxDuration + duration - 1]
+    std::vector<int> warmEvents;
+    std::vector<int> coldEvents;
+    std::vector<double> warmIntensity;
+    std::vector<double> coldIntensity;
+    std::vector<int> warmMonths; // months spent in qualifying events
+    std::vector<int> coldMonths;
+
+    size_t index(size_t amplitude, int duration) const {
+        return amplitude * maxDuration + (duration - 1);
+    }
+};
+
+// Warm and cold thresholds of each calendar month: month m is warm above
+// upper[m] and cold below lower[m]
+struct MonthThresholds {
+    double upper[MONTHS_PER_YEAR];
+    double lower[MONTHS_PER_YEAR];
+};
+
+// Function to return +/-amplitude for every month, the fixed thresholds
+MonthThresholds amplitudeThresholds(double amplitude);
+
+// Percentile thresholds of each calendar month over a baseline of years
+struct PercentileOptions {
+    double upperPercentile = 90.0;
+    double lowerPercentile = 10.0;
+    int baseFirst = 0; // baseline years; 0 and 0 use every year
+    int baseLast = 0;
+    int sketchSize = 200; // k of the quantile sketches (see quantile_sketch.h)
+
+    bool inBase(int year) const { return baseFirst == 0 || (year >= baseFirst && year <= baseLast); }
+};
+
+// Function to add the baseline values of a monthly stream (value t is month
+// t % 12 of year startYear + t / 12) to one sketch per calendar month
+template <typename T>
+void sketchMonths(const T* series, size_t months, int startYear, const PercentileOptions& options,
+                  QuantileSketch sketches[MONTHS_PER_YEAR]);
+
+// Function to read the thresholds off one sketch per calendar month; months
+// whose sketch is empty get NaN thresholds and are never warm or cold
+MonthThresholds sketchThresholds(const QuantileSketch sketches[MONTHS_PER_YEAR], const PercentileOptions& options);
+
+// Function to compute percentile thresholds of every calendar month of the
+// table in one pass over its baseline rows
+MonthThresholds percentileThresholds(const ClimateTable& table, const PercentileOptions& options);
+
+// Function to find every warm and cold run of the table's monthly stream
+std::vector<AnomalyRun> detectAnomalyRuns(const ClimateTable& table, double amplitude);
+std::vector<AnomalyRun> detectAnomalyRuns(const ClimateTable& table, const MonthThresholds& thresholds);
+
+// Function to sweep amplitude thresholds and durations 1..maxDuration in one
+// pass over the table's monthly stream
+ThresholdSweep sweepExtremeEvents(const ClimateTable& table, const std::vector<double>& amplitudes, int maxDuration);
+
+#endif // EXTREME_EVENTS_H
@@ -0,0 +1,375 @@
+#include "grid_analysis.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+#include "adf_test.h"
+#include "changepoint.h"
+#include "climate_analysis.h"
+#include "record_engine.h"
+#include "regression.h"
+#include "resampling.h"
+#include "robust_trend.h"
+#include "extreme_events.h"
+#include "packed_anomaly.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Function to finish a cell from its year-padded series and the running
+// maximum of each calendar month: the warm/cool classification of every
+// month and the optional stationarity test
+void classifyCellMonths(const float* padded, const float* runningMax, const double* yearAxis, int years,
+                        const GridAnalysisOptions& options, size_t cell, CellResult& result) {
+    // Yearly increase vs stationary distribution slope of all twelve months in one batch each
+    RegressionResult yearlyIncrease[MONTHS_PER_YEAR], stationaryDistribution[MONTHS_PER_YEAR];
+    regressBatch(yearAxis, years, padded, 1, 12, MONTHS_PER_YEAR, yearlyIncrease);
+    regressBatch(yearAxis, years, runningMax, 1, 12, MONTHS_PER_YEAR, stationaryDistribution);
+
+    SlopeInterval difference[MONTHS_PER_YEAR];
+    if (options.warmCoolResamples > 0) {
+        // The slope difference is the slope of each month's excess over its running maximum
+        thread_local std::vector<float> excess;
+        const size_t length = static_cast<size_t>(years) * 12;
+        excess.resize(length);
+        for (size_t t = 0; t < length; ++t) excess[t] = padded[t] - runningMax[t];
+
+        ResamplingOptions resampling;
+        resampling.replicates = options.warmCoolResamples;
+        resampling.seed = options.seed;
+        bootstrapSlopeBatch(yearAxis, years, excess.data(), 1, 12, MONTHS_PER_YEAR, resampling,
+                            cell * MONTHS_PER_YEAR, nullptr, difference);
+    }
+
+    for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+        WarmCoolSlopes slopes = {yearlyIncrease[m].slope, stationaryDistribution[m].slope};
+        if (std::isnan(slopes.yearlyIncrease) || std::isnan(slopes.stationaryDistribution)) continue;
+        slopes.differenceLower = difference[m].lower;
+        slopes.differenceUpper = difference[m].upper;
+
+        const WarmCoolTrend trend = classifyWarmCool(slopes);
+        if (trend == TREND_WARMING) ++result.warmingMonths;
+        if (trend == TREND_COOLING) ++result.coolingMonths;
+    }
+
+    if (options.stationarityTest) {
+        AdfResult adf[MONTHS_PER_YEAR];
+        adfTestBatch(padded, years, 1, 12, MONTHS_PER_YEAR, AdfOptions(), adf);
+        result.stationaryMonths = 0;
+        for (const AdfResult& test : adf) {
+            if (test.pValue < 0.05) ++result.stationaryMonths;
+        }
+    }
+}
+
+// Function to fit the trend of a cell's annual means and, when asked, its
+// significance allowing for autocorrelated residuals
+void fitCellTrend(const double* yearAxis, const double* annualMean, int years, const GridAnalysisOptions& options,
+                  CellResult& result) {
+    const RegressionResult fit = linearRegression(yearAxis, annualMean, years);
+    result.trendSlope = static_cast<float>(fit.slope);
+    if (options.significance) {
+        result.trendStdError = static_cast<float>(fit.adjustedSlopeStdError);
+        result.trendPValue = static_cast<float>(regressionTests(fit).adjustedSlopePValue);
+    }
+}
+
+// Function to find the trend changepoints of a cell's annual means
+void detectCellChangepoints(const double* yearAxis, const double* annualMean, int years,
+                            const GridAnalysisOptions& options, CellResult& result) {
+    if (!options.changepoints) {
+        return;
+    }
+    const ChangepointResult changes = detectChangepoints(yearAxis, annualMean, years, 1, ChangepointOptions());
+    result.changepoints = static_cast<int>(changes.changepoints());
+    if (!changes.segments.empty()) {
+        result.recentSlope = static_cast<float>(changes.segments.back().fit.slope);
+    }
+}
+
+// Function to fit Theil-Sen lines to a cell's annual means and to its pooled
+// record gaps, whose least squares slope a few long gaps can dominate
+void fitCellRobustTrends(const double* yearAxis, const double* annualMean, int years,
+                         const std::vector<double>& gapStarts, const std::vector<double>& gapSizes,
+                         const GridAnalysisOptions& options, CellResult& result) {
+    if (!options.robustTrend) {
+        return;
+    }
+    const RobustTrend trend = theilSen(yearAxis, annualMean, years);
+    result.senSlope = static_cast<float>(trend.slope);
+    result.kendallPValue = static_cast<float>(trend.pValue);
+    result.robustGapSlope = static_cast<float>(theilSen(gapStarts, gapSizes).slope);
+}
+
+// Function to count a cell's heatwaves and cold snaps against its own
+// percentile thresholds
+template <typename T>
+void countPercentileEvents(const T* series, int months, int startYear, const GridAnalysisOptions& options,
+                           CellResult& result) {
+    const MonthThresholds thresholds = cellThresholds(series, months, startYear, options.percentiles);
+    EventCounter events;
+    events.threshold = options.consecutiveMonthsThreshold;
+    for (int t = 0; t < months; ++t) {
+        const int month = t % 12;
+        events.add(startYear + t / 12, month, series[t], thresholds.upper[month], thresholds.lower[month]);
+    }
+    result.heatwaveCount = events.heatwaveCount;
+    result.coldSnapCount = events.coldSnapCount;
+}
+
+} // namespace
+
+template <typename T>
+MonthThresholds cellThresholds(const T* series, int months, int startYear, const PercentileOptions& options) {
+    // Per-thread sketches, emptied but not freed between cells
+    thread_local std::vector<QuantileSketch> sketches;
+    if (sketches.empty() || sketches[0].k() != options.sketchSize) {
+        sketches.assign(MONTHS_PER_YEAR, QuantileSketch(options.sketchSize));
+    }
+    for (QuantileSketch& sketch : sketches) sketch.clear();
+    sketchMonths(series, months, startYear, options, sketches.data());
+    return sketchThresholds(sketches.data(), options);
+}
+
+MonthThresholds fieldThresholds(const GriddedField& field, const PercentileOptions& options, ThreadPool& pool) {
+    const size_t BLOCK_CELLS = 64;
+    const size_t blocks = (field.cells() + BLOCK_CELLS - 1) / BLOCK_CELLS;
+    std::vector<QuantileSketch> sketches(blocks * MONTHS_PER_YEAR, QuantileSketch(options.sketchSize));
+    pool.parallelFor(0, blocks, 1, [&](size_t first, size_t last) {
+        for (size_t block = first; block < last; ++block) {
+            const size_t end = std::min(field.cells(), (block + 1) * BLOCK_CELLS);
+            for (size_t cell = block * BLOCK_CELLS; cell < end; ++cell) {
+                sketchMonths(field.series(cell), field.months, field.startYear, options,
+                             &sketches[block * MONTHS_PER_YEAR]);
+            }
+        }
+    });
+
+    std::vector<QuantileSketch> merged(MONTHS_PER_YEAR, QuantileSketch(options.sketchSize));
+    for (size_t block = 0; block < blocks; ++block) {
+        for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+            merged[month].merge(sketches[block * MONTHS_PER_YEAR + month]);
+        }
+    }
+    return sketchThresholds(merged.data(), options);
+}
+
+void analyzeCell(const float* series, int months, int startYear, const GridAnalysisOptions& options, size_t cell,
+                 CellResult& result) {
+    result = CellResult();
+    const int years = (months + 11) / 12;
+    const float missing = std::numeric_limits<float>::quiet_NaN();
+
+    // Per-thread scratch, padded to whole years so every calendar month has the same length
+    thread_local std::vector<float> padded, runningMax;
+    thread_local std::vector<double> yearAxis, annualMean;
+    padded.assign(series, series + months);
+    padded.resize(static_cast<size_t>(years) * 12, missing);
+    runningMax.assign(padded.size(), missing);
+    yearAxis.resize(years);
+    annualMean.assign(years, std::numeric_limits<double>::quiet_NaN());
+
+    // Annual means of complete years
+    for (int y = 0; y < years; ++y) {
+        yearAxis[y] = startYear + y;
+        const float* row = &padded[y * 12];
+        double sum = 0.0;
+        int valid = 0;
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            if (!std::isnan(row[m])) {
+                sum += row[m];
+                ++valid;
+            }
+        }
+        if (valid == MONTHS_PER_YEAR) {
+            annualMean[y] = sum / MONTHS_PER_YEAR;
+        }
+    }
+    fitCellTrend(yearAxis.data(), annualMean.data(), years, options, result);
+    detectCellChangepoints(yearAxis.data(), annualMean.data(), years, options, result);
+
+    // Records, pooled record gaps and the running maximum of every calendar month
+    RecordTracker trackers[MONTHS_PER_YEAR];
+    RegressionAccumulator gapRegression;
+    thread_local std::vector<double> gapStarts, gapSizes;
+    gapStarts.clear();
+    gapSizes.clear();
+    bool isHigh, isLow;
+    int highGap, lowGap;
+    for (size_t t = 0; t < padded.size(); ++t) {
+        const int month = static_cast<int>(t % 12);
+        const int year = startYear + static_cast<int>(t / 12);
+        RecordTracker& tracker = trackers[month];
+
+        tracker.update(year, padded[t], isHigh, isLow, highGap, lowGap);
+        if (highGap >= 0) {
+            gapRegression.add(year - highGap, highGap);
+            if (options.robustTrend) {
+                gapStarts.push_back(year - highGap);
+                gapSizes.push_back(highGap);
+            }
+        }
+        if (!std::isnan(padded[t])) {
+            runningMax[t] = static_cast<float>(tracker.maxValue);
+        }
+    }
+    for (const RecordTracker& tracker : trackers) {
+        result.recordCount += tracker.recordCount;
+    }
+    result.recordGapSlope = static_cast<float>(gapRegression.result().slope);
+    fitCellRobustTrends(yearAxis.data(), annualMean.data(), years, gapStarts, gapSizes, options, result);
+
+    // Heatwaves and cold snaps over the continuous monthly series
+    if (options.percentileEvents) {
+        countPercentileEvents(series, months, startYear, options, result);
+    } else {
+        EventCounter events;
+        events.threshold = options.consecutiveMonthsThreshold;
+        for (int t = 0; t < months; ++t) {
+            events.add(startYear + t / 12, t % 12, series[t]);
+        }
+        result.heatwaveCount = events.heatwaveCount;
+        result.coldSnapCount = events.coldSnapCount;
+    }
+
+    classifyCellMonths(padded.data(), runningMax.data(), yearAxis.data(), years, options, cell, result);
+}
+
+void analyzeCell(const std::int16_t* series, int months, int startYear, const GridAnalysisOptions& options,
+                 size_t cell, CellResult& result) {
+    result = CellResult();
+    const int years = (months + 11) / 12;
+
+    thread_local std::vector<std::int16_t> padded, runningMax;
+    thread_local std::vector<float> unpacked, unpackedMax;
+    thread_local std::vector<double> yearAxis, annualMean;
+    padded.assign(series, series + months);
+    padded.resize(static_cast<size_t>(years) * 12, PACKED_MISSING);
+    runningMax.resize(padded.size());
+    yearAxis.resize(years);
+    annualMean.assign(years, std::numeric_limits<double>::quiet_NaN());
+
+    // Annual means of complete years, each year one series summed exactly in packed units
+    thread_local std::vector<PackedMoments> annual;
+    annual.resize(years);
+    packedMomentsBatch(padded.data(), MONTHS_PER_YEAR, 12, 1, years, annual.data());
+    for (int y = 0; y < years; ++y) {
+        yearAxis[y] = startYear + y;
+        if (annual[y].count == MONTHS_PER_YEAR) annualMean[y] = annual[y].mean();
+    }
+    fitCellTrend(yearAxis.data(), annualMean.data(), years, options, result);
+    detectCellChangepoints(yearAxis.data(), annualMean.data(), years, options, result);
+
+    // Records and running maxima of the twelve calendar months side by side
+    int recordCounts[MONTHS_PER_YEAR];
+    packedRecordsBatch(padded.data(), years, 1, 12, MONTHS_PER_YEAR, runningMax.data(), recordCounts);
+    for (int count : recordCounts) result.recordCount += count;
+
+    // A value equal to its running maximum set or tied the record
+    RegressionAccumulator gapRegression;
+    thread_local std::vector<double> gapStarts, gapSizes;
+    gapStarts.clear();
+    gapSizes.clear();
+    int lastRecord[MONTHS_PER_YEAR];
+    std::fill(lastRecord, lastRecord + MONTHS_PER_YEAR, -1);
+    for (size_t t = 0; t < padded.size(); ++t) {
+        if (padded[t] == PACKED_MISSING || padded[t] != runningMax[t]) continue;
+        const int month = static_cast<int>(t % 12);
+        const int year = startYear + static_cast<int>(t / 12);
+        if (lastRecord[month] >= 0) {
+            gapRegression.add(lastRecord[month], year - lastRecord[month]);
+            if (options.robustTrend) {
+                gapStarts.push_back(lastRecord[month]);
+                gapSizes.push_back(year - lastRecord[month]);
+            }
+        }
+        lastRecord[month] = year;
+    }
+    result.recordGapSlope = static_cast<float>(gapRegression.result().slope);
+    fitCellRobustTrends(yearAxis.data(), annualMean.data(), years, gapStarts, gapSizes, options, result);
+
+    unpacked.resize(padded.size());
+    unpackedMax.resize(padded.size());
+    unpackAnomalies(padded.data(), padded.size(), unpacked.data());
+    unpackAnomalies(runningMax.data(), runningMax.size(), unpackedMax.data());
+
+    // The packed run kernel compares against one symmetric amplitude; per-month
+    // percentiles take the unpacked values
+    if (options.percentileEvents) {
+        countPercentileEvents(unpacked.data(), months, startYear, options, result);
+    } else {
+        PackedRunCounts events;
+        packedRunsBatch(series, months, 0, 1, 1, 0, options.consecutiveMonthsThreshold, &events);
+        result.heatwaveCount = events.heatwaveCount;
+        result.coldSnapCount = events.coldSnapCount;
+    }
+    classifyCellMonths(unpacked.data(), unpackedMax.data(), yearAxis.data(), years, options, cell, result);
+}
+
+void analyzeGrid(const GriddedField& field, const GridAnalysisOptions& options, ThreadPool& pool,
+                 std::vector<CellResult>& results) {
+    results.assign(field.cells(), CellResult());
+    pool.parallelFor(0, field.cells(), 16, [&](size_t first, size_t last) {
+        for (size_t cell = first; cell < last; ++cell) {
+            analyzeCell(field.series(cell), field.months, field.startYear, options, cell, results[cell]);
+        }
+    });
+}
+
+void analyzeGrid(const PackedField& field, const GridAnalysisOptions& options, ThreadPool& pool,
+                 std::vector<CellResult>& results) {
+    results.assign(field.cells(), CellResult());
+    pool.parallelFor(0, field.cells(), 16, [&](size_t first, size_t last) {
+        for (size_t cell = first; cell < last; ++cell) {
+            analyzeCell(field.series(cell), field.months, field.startYear, options, cell, results[cell]);
+        }
+    });
+}
+
+template <typename Field>
+bool writeGridResults(const Field& field, const std::vector<CellResult>& results,
+                      const GridAnalysisOptions& options, const std::string& filename, std::string& error) {
+    std::ofstream output_file(filename);
+    if (!output_file) {
+        error = "Error opening file: " + filename;
+        return false;
+    }
+
+    output_file << "Lat,Lon,TrendSlope,RecordGapSlope,Records,WarmingMonths,CoolingMonths,Heatwaves,ColdSnaps"
+                << (options.stationarityTest ? ",StationaryMonths" : "")
+                << (options.changepoints ? ",Changepoints,RecentSlope" : "")
+                << (options.significance ? ",TrendStdError,TrendPValue" : "")
+                << (options.robustTrend ? ",SenSlope,KendallPValue,RobustGapSlope\n" : "\n");
+    for (int lat = 0; lat < field.nlat; ++lat) {
+        for (int lon = 0; lon < field.nlon; ++lon) {
+            const CellResult& r = results[static_cast<size_t>(lat) * field.nlon + lon];
+            output_file << field.latitude(lat) << "," << field.longitude(lon) << ","
+                        << r.trendSlope << "," << r.recordGapSlope << "," << r.recordCount << ","
+                        << r.warmingMonths << "," << r.coolingMonths << ","
+                        << r.heatwaveCount << "," << r.coldSnapCount;
+            if (options.stationarityTest) output_file << "," << r.stationaryMonths;
+            if (options.changepoints) output_file << "," << r.changepoints << "," << r.recentSlope;
+            if (options.significance) output_file << "," << r.trendStdError << "," << r.trendPValue;
+            if (options.robustTrend) {
+                output_file << "," << r.senSlope << "," << r.kendallPValue << "," << r.robustGapSlope;
+            }
+            output_file << "\n";
+        }
+    }
+
+    if (!output_file.flush()) {
+        error = "Error writing file: " + filename;
+        return false;
+    }
+    return true;
+}
+
+template bool writeGridResults<GriddedField>(const GriddedField&, const std::vector<CellResult>&,
+                                             const GridAnalysisOptions&, const std::string&, std::string&);
+template bool writeGridResults<PackedField>(const PackedField&, const std::vector<CellResult>&,
+                                            const GridAnalysisOptions&, const std::string&, std::string&);
+
+template MonthThresholds cellThresholds<float>(const float*, int, int, const PercentileOptions&);
+template MonthThresholds cellThresholds<double>(const double*, int, int, const PercentileOptions&);
@@ -0,0 +1,92 @@
+#ifndef GRID_ANALYSIS_H
+#define GRID_ANALYSIS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "extreme_events.h"
+#include "gridded_field.h"
+
+class ThreadPool;
+
+struct GridAnalysisOptions {
+    int consecutiveMonthsThreshold = 3;
+    bool stationarityTest = false; // ADF test of every calendar month (stats_test)
+    size_t warmCoolResamples = 0;  // bootstrap the warm/cool decision; 0 uses the sign of the slope difference
+                                   // (conditional on the cell's observed records, as computeWarmCoolIntervals)
+    std::uint64_t seed = 1880;     // seed of the resampling streams
+    bool changepoints = false;     // PELT segments of the annual means (see changepoint.h)
+    bool significance = false;     // AR(1)-adjusted standard error and p-value of the trend
+    bool robustTrend = false;      // Theil-Sen slopes and Mann-Kendall test (see robust_trend.h)
+    bool percentileEvents = false; // events against each cell's own monthly percentiles, not the sign
+    PercentileOptions percentiles;
+};
+
+// Results of the single-series analyses for one grid cell. Slopes are NaN
+// when the cell has too little data for a fit.
+struct CellResult {
+    float trendSlope = 0.0f;     // J-D (annual mean) anomaly trend, degrees per year
+    float recordGapSlope = 0.0f; // gap start year vs gap size, pooled over all months
+    int recordCount = 0;         // record highs over all months
+    int warmingMonths = 0;       // months classified as potential warming (global_warm_cool rule)
+    int coolingMonths = 0;       // months classified as potential cooling
+    int heatwaveCount = 0;       // events as counted by analyzeEventFrequencyDuration (or against percentiles)
+    int coldSnapCount = 0;
+    int stationaryMonths = -1;   // months whose ADF test rejects a unit root at 5%; -1 if not run
+    int changepoints = -1;       // trend changepoints of the annual means; -1 if not run
+    float recentSlope = NAN;     // trend of the last segment, degrees per year
+    float trendStdError = NAN;   // AR(1)-adjusted standard error of trendSlope; NaN if not run
+    float trendPValue = NAN;     // its two-sided p-value against no trend
+    float senSlope = NAN;        // Theil-Sen slope of the annual means; NaN if not run
+    float kendallPValue = NAN;   // their Mann-Kendall two-sided p-value
+    float robustGapSlope = NAN;  // Theil-Sen slope of the pooled record gaps
+};
+
+// Function to run the trend, record gap, warm/cool and extreme event
+// analyses on one cell's monthly series. Calendar month m of cell resamples
+// with stream 12 * cell + m, so a cell's result does not depend on the
+// threads or the order in which cells are analyzed.
+void analyzeCell(const float* series, int months, int startYear, const GridAnalysisOptions& options, size_t cell,
+                 CellResult& result);
+
+// Function to run the same analyses on a packed series (see packed_anomaly.h).
+// Records, record gaps, annual means and events are computed on the packed
+// values directly. On a field that packs exactly, counts, records, gaps and
+// events match the float version's and slopes match it to rounding. Rank
+// statistics need not: annual means summed in exact hundredths can tie where
+// the float sums differ in the last bit, so the tie-corrected Mann-Kendall
+// p-value (kendallPValue), and Sen slopes decided by such ties, may differ.
+void analyzeCell(const std::int16_t* series, int months, int startYear, const GridAnalysisOptions& options,
+                 size_t cell, CellResult& result);
+
+// Function to compute the percentile thresholds of one cell's monthly series
+// from one quantile sketch per calendar month
+template <typename T>
+MonthThresholds cellThresholds(const T* series, int months, int startYear, const PercentileOptions& options);
+
+// Function to compute percentile thresholds of each calendar month over every
+// cell of the field: sketches built in parallel over blocks of cells are
+// merged in block order, so the result does not depend on the threads
+MonthThresholds fieldThresholds(const GriddedField& field, const PercentileOptions& options, ThreadPool& pool);
+
+// Function to analyze every cell of the field in parallel; results are
+// indexed like the field's cells (lat * nlon + lon)
+void analyzeGrid(const GriddedField& field, const GridAnalysisOptions& options, ThreadPool& pool,
+                 std::vector<CellResult>& results);
+void analyzeGrid(const PackedField& field, const GridAnalysisOptions& options, ThreadPool& pool,
+                 std::vector<CellResult>& results);
+
+// Function to write one CSV line per cell with its latitude and longitude;
+// StationaryMonths is included when options ran the stationarity test,
+// Changepoints and RecentSlope when they ran the changepoint detection,
+// TrendStdError and TrendPValue when they asked for the trend's significance,
+// and SenSlope, KendallPValue and RobustGapSlope for the robust trends.
+// Field is GriddedField or PackedField.
+template <typename Field>
+bool writeGridResults(const Field& field, const std::vector<CellResult>& results,
+                      const GridAnalysisOptions& options, const std::string& filename, std::string& error);
+
+#endif // GRID_ANALYSIS_H
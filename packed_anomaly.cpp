@@ -0,0 +1,152 @@
+#include "packed_anomaly.h"
+
+#include <algorithm>
+
+namespace {
+
+// Series processed side by side: sixteen int16 lanes fill a 256-bit vector
+const size_t BLOCK = 16;
+
+} // namespace
+
+double PackedMoments::variance() const {
+    if (count < 2) return NAN;
+    // Exact integers up to the final division
+    const double n = static_cast<double>(count);
+    const double centered = static_cast<double>(sumSquares) - static_cast<double>(sum) * static_cast<double>(sum) / n;
+    return centered / (n - 1.0) / (PACKED_SCALE * PACKED_SCALE);
+}
+
+template <typename T>
+size_t packAnomalies(const T* values, size_t n, std::int16_t* packed) {
+    size_t changed = 0;
+    for (size_t i = 0; i < n; ++i) {
+        packed[i] = packAnomaly(values[i]);
+        // Compare in the input's own precision, so a float that came from a
+        // two-decimal value is not counted as changed
+        if (packed[i] != PACKED_MISSING && static_cast<T>(packed[i] / PACKED_SCALE) != values[i]) ++changed;
+    }
+    return changed;
+}
+
+template <typename T>
+void unpackAnomalies(const std::int16_t* packed, size_t n, T* values) {
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = static_cast<T>(unpackAnomaly(packed[i]));
+    }
+}
+
+void packedMomentsBatch(const std::int16_t* values, size_t steps, size_t seriesStride, size_t timeStride,
+                        size_t series, PackedMoments* moments) {
+    // Counts and sums stay in 32 bits for chunks of 65536 steps, which
+    // |v| <= 32767 cannot overflow; squares go straight to 64 bits
+    const size_t SUM_CHUNK = 65536;
+
+    for (size_t first = 0; first < series; first += BLOCK) {
+        const size_t lanes = std::min(BLOCK, series - first);
+        const std::int16_t* base = values + first * seriesStride;
+        std::int64_t count[BLOCK] = {}, sum[BLOCK] = {}, sumSquares[BLOCK] = {};
+
+        for (size_t chunk = 0; chunk < steps; chunk += SUM_CHUNK) {
+            const size_t end = std::min(steps, chunk + SUM_CHUNK);
+            std::int32_t partialCount[BLOCK] = {}, partialSum[BLOCK] = {};
+            for (size_t t = chunk; t < end; ++t) {
+                const std::int16_t* row = base + t * timeStride;
+                for (size_t l = 0; l < lanes; ++l) {
+                    const std::int32_t v = row[l * seriesStride];
+                    const bool valid = v != PACKED_MISSING;
+                    const std::int32_t w = valid ? v : 0;
+                    partialCount[l] += valid;
+                    partialSum[l] += w;
+                    sumSquares[l] += static_cast<std::int64_t>(w * w);
+                }
+            }
+            for (size_t l = 0; l < lanes; ++l) {
+                count[l] += partialCount[l];
+                sum[l] += partialSum[l];
+            }
+        }
+
+        for (size_t l = 0; l < lanes; ++l) {
+            moments[first + l].count = count[l];
+            moments[first + l].sum = sum[l];
+            moments[first + l].sumSquares = sumSquares[l];
+        }
+    }
+}
+
+void packedRecordsBatch(const std::int16_t* values, size_t steps, size_t seriesStride, size_t timeStride,
+                        size_t series, std::int16_t* runningMax, int* recordCounts) {
+    for (size_t first = 0; first < series; first += BLOCK) {
+        const size_t lanes = std::min(BLOCK, series - first);
+        const std::int16_t* base = values + first * seriesStride;
+        std::int16_t* maxBase = runningMax ? runningMax + first * seriesStride : nullptr;
+
+        // PACKED_MISSING is the smallest int16, so it doubles as "no record
+        // yet": the first valid value is always >= it
+        std::int16_t best[BLOCK];
+        int count[BLOCK] = {};
+        std::fill(best, best + BLOCK, PACKED_MISSING);
+
+        for (size_t t = 0; t < steps; ++t) {
+            const std::int16_t* row = base + t * timeStride;
+            std::int16_t current[BLOCK];
+            for (size_t l = 0; l < lanes; ++l) {
+                const std::int16_t v = row[l * seriesStride];
+                const bool valid = v != PACKED_MISSING;
+                const bool record = valid && v >= best[l];
+                count[l] += record;
+                best[l] = record ? v : best[l];
+                current[l] = valid ? best[l] : PACKED_MISSING;
+            }
+            if (maxBase) {
+                std::int16_t* out = maxBase + t * timeStride;
+                for (size_t l = 0; l < lanes; ++l) out[l * seriesStride] = current[l];
+            }
+        }
+
+        for (size_t l = 0; l < lanes; ++l) recordCounts[first + l] = count[l];
+    }
+}
+
+void packedRunsBatch(const std::int16_t* values, size_t steps, size_t seriesStride, size_t timeStride,
+                     size_t series, std::int16_t amplitude, int threshold, PackedRunCounts* counts) {
+    const std::int16_t lower = static_cast<std::int16_t>(-amplitude);
+
+    for (size_t first = 0; first < series; first += BLOCK) {
+        const size_t lanes = std::min(BLOCK, series - first);
+        const std::int16_t* base = values + first * seriesStride;
+        int warmLength[BLOCK] = {}, coldLength[BLOCK] = {};
+        int heatwaves[BLOCK] = {}, coldSnaps[BLOCK] = {};
+        int longestWarm[BLOCK] = {}, longestCold[BLOCK] = {};
+
+        for (size_t t = 0; t < steps; ++t) {
+            const std::int16_t* row = base + t * timeStride;
+            for (size_t l = 0; l < lanes; ++l) {
+                const std::int16_t v = row[l * seriesStride];
+                const bool warm = v > amplitude;
+                const bool cold = v != PACKED_MISSING && v < lower;
+                warmLength[l] = warm ? warmLength[l] + 1 : 0;
+                coldLength[l] = cold ? coldLength[l] + 1 : 0;
+                heatwaves[l] += warmLength[l] == threshold;
+                coldSnaps[l] += coldLength[l] == threshold;
+                longestWarm[l] = std::max(longestWarm[l], warmLength[l]);
+                longestCold[l] = std::max(longestCold[l], coldLength[l]);
+            }
+        }
+
+        for (size_t l = 0; l < lanes; ++l) {
+            PackedRunCounts& out = counts[first + l];
+            out.heatwaveCount = heatwaves[l];
+            out.coldSnapCount = coldSnaps[l];
+            // EventCounter only reports lengths of runs that became events
+            out.longestHeatwave = longestWarm[l] >= threshold ? longestWarm[l] : 0;
+            out.longestColdSnap = longestCold[l] >= threshold ? longestCold[l] : 0;
+        }
+    }
+}
+
+template size_t packAnomalies<float>(const float*, size_t, std::int16_t*);
+template size_t packAnomalies<double>(const double*, size_t, std::int16_t*);
+template void unpackAnomalies<float>(const std::int16_t*, size_t, float*);
+template void unpackAnomalies<double>(const std::int16_t*, size_t, double*);
@@ -0,0 +1,82 @@
+#ifndef PACKED_ANOMALY_H
+#define PACKED_ANOMALY_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Anomalies packed as int16 hundredths of a degree (centi-kelvin). GISTEMP
+// anomalies carry two decimals, so -0.19 is stored exactly as -19; the range
+// is -327.67 to +327.67 degrees. A quarter of the memory of double storage
+// (half of float), and eight values to a 128-bit vector instead of two.
+const std::int16_t PACKED_MISSING = INT16_MIN; // "***"
+const double PACKED_SCALE = 100.0;
+
+// Function to pack one value; NaN becomes PACKED_MISSING and values outside
+// the range saturate to its ends
+inline std::int16_t packAnomaly(double value) {
+    if (std::isnan(value)) return PACKED_MISSING;
+    const double scaled = std::round(value * PACKED_SCALE);
+    if (scaled > INT16_MAX) return INT16_MAX;
+    if (scaled < -INT16_MAX) return -INT16_MAX;
+    return static_cast<std::int16_t>(scaled);
+}
+
+inline double unpackAnomaly(std::int16_t packed) {
+    return packed == PACKED_MISSING ? NAN : packed / PACKED_SCALE;
+}
+
+// Function to pack n values. Returns how many were changed by packing
+// (more than two decimals, or out of range); 0 means the packing is lossless.
+template <typename T>
+size_t packAnomalies(const T* values, size_t n, std::int16_t* packed);
+
+// Function to unpack n values; PACKED_MISSING becomes NaN
+template <typename T>
+void unpackAnomalies(const std::int16_t* packed, size_t n, T* values);
+
+// The kernels below work on many packed series at once, laid out like
+// regressBatch's input: value t of series s is
+// values[s * seriesStride + t * timeStride]. With seriesStride 1 and
+// timeStride 12 the series are the calendar months of one monthly series.
+// Series are processed in blocks whose state sits side by side, so the loop
+// over a block vectorizes across series on the int16 lanes.
+
+// Count, sum and sum of squares of the valid values, in packed units. The
+// sums are exact integers, so mean and variance lose nothing to rounding.
+struct PackedMoments {
+    std::int64_t count = 0;
+    std::int64_t sum = 0;
+    std::int64_t sumSquares = 0;
+
+    double mean() const { return count > 0 ? sum / (PACKED_SCALE * count) : NAN; }
+    // Sample variance in degrees squared
+    double variance() const;
+};
+
+// Function to accumulate the moments of each series
+void packedMomentsBatch(const std::int16_t* values, size_t steps, size_t seriesStride, size_t timeStride,
+                        size_t series, PackedMoments* moments);
+
+// Function to compute each series' running maximum and record count (values
+// that set or tie the record high, as RecordTracker counts them). runningMax
+// (optional) receives the maximum up to and including each valid value, in
+// the same layout as values, and PACKED_MISSING where the value is missing.
+void packedRecordsBatch(const std::int16_t* values, size_t steps, size_t seriesStride, size_t timeStride,
+                        size_t series, std::int16_t* runningMax, int* recordCounts);
+
+// Heatwave / cold snap counts of a packed series, as EventCounter counts them
+struct PackedRunCounts {
+    int heatwaveCount = 0;
+    int coldSnapCount = 0;
+    int longestHeatwave = 0;
+    int longestColdSnap = 0;
+};
+
+// Function to count runs of at least threshold values above +amplitude (warm)
+// or below -amplitude (cold) in each series. A missing value ends a run, and
+// steps are taken to be consecutive.
+void packedRunsBatch(const std::int16_t* values, size_t steps, size_t seriesStride, size_t timeStride,
+                     size_t series, std::int16_t amplitude, int threshold, PackedRunCounts* counts);
+
+#endif // PACKED_ANOMALY_H
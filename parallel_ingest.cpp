@@ -0,0 +1,261 @@
+#include "parallel_ingest.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "aggregation.h"
+#include "table_cache.h"
+#include "thread_pool.h"
+
+namespace {
+
+const size_t MIN_CHUNK_BYTES = 256 * 1024;
+const size_t CHUNKS_PER_WORKER = 8;
+
+// One line-aligned piece of the buffer and where its rows go in the table
+struct Chunk {
+    const char* begin;
+    const char* end;
+    size_t firstRow = 0;   // rows are written from here on
+    size_t candidates = 0; // lines that start with a digit: an upper bound on its rows
+    size_t rows = 0;
+    size_t lines = 0;
+    size_t skipped = 0;
+    size_t errorCount = 0;
+    std::vector<RowError> errors; // line numbers relative to the chunk until merged
+};
+
+// Function to split the buffer into chunks that each end just after a newline
+std::vector<Chunk> splitAtLines(const char* data, size_t length, size_t chunkBytes) {
+    std::vector<Chunk> chunks;
+    const char* const end = data + length;
+    const char* begin = data;
+    while (begin < end) {
+        const char* split = end;
+        if (static_cast<size_t>(end - begin) > chunkBytes) {
+            const char* newline = static_cast<const char*>(std::memchr(begin + chunkBytes, '\n', end - begin - chunkBytes));
+            if (newline) split = newline + 1;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = split;
+        begin = split;
+    }
+    return chunks;
+}
+
+// Function to count the lines that parseClimateRow will treat as data rows
+// (valid or not), using the same test on the first non-blank character
+void countCandidates(Chunk& chunk) {
+    const char* cursor = chunk.begin;
+    while (cursor < chunk.end) {
+        while (cursor < chunk.end && (*cursor == ' ' || *cursor == '\t')) ++cursor;
+        if (cursor < chunk.end && *cursor >= '0' && *cursor <= '9') ++chunk.candidates;
+
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', chunk.end - cursor));
+        cursor = newline ? newline + 1 : chunk.end;
+    }
+}
+
+// Destination columns of the table, in CSV column order after Year
+struct RowSink {
+    int* years;
+    double* values[VALUE_COLUMNS];
+};
+
+void parseChunk(Chunk& chunk, const RowSink& sink, size_t maxErrors) {
+    const char* cursor = chunk.begin;
+    int year = 0;
+    double values[VALUE_COLUMNS];
+    std::string message;
+
+    while (cursor < chunk.end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', chunk.end - cursor));
+        const char* next = lineEnd ? lineEnd + 1 : chunk.end;
+        if (!lineEnd) lineEnd = chunk.end;
+        ++chunk.lines;
+
+        RowStatus status = parseClimateRow(cursor, lineEnd, year, values, message);
+        if (status == ROW_OK) {
+            const size_t row = chunk.firstRow + chunk.rows++;
+            sink.years[row] = year;
+            for (int column = 0; column < VALUE_COLUMNS; ++column) {
+                sink.values[column][row] = values[column];
+            }
+        } else if (status == ROW_SKIPPED) {
+            ++chunk.skipped;
+        } else {
+            ++chunk.errorCount;
+            if (chunk.errors.size() < maxErrors) {
+                const char* textEnd = lineEnd > cursor && lineEnd[-1] == '\r' ? lineEnd - 1 : lineEnd;
+                std::string text(cursor, std::min<size_t>(textEnd - cursor, MAX_ERROR_TEXT));
+                chunk.errors.push_back({chunk.lines, message, text});
+            }
+        }
+
+        cursor = next;
+    }
+}
+
+Column<double>& valueColumn(ClimateTable& table, int column) {
+    return column < MONTHS_PER_YEAR ? table.monthly[column] : table.aggregates[column - MONTHS_PER_YEAR];
+}
+
+// Read-only mapping of a whole file
+struct MappedFile {
+    const char* data = nullptr;
+    size_t length = 0;
+
+    ~MappedFile() {
+        if (data) ::munmap(const_cast<char*>(data), length);
+    }
+};
+
+bool mapFile(const std::string& filename, MappedFile& file, std::string& error) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || ::fstat(fd, &info) != 0) {
+        if (fd >= 0) ::close(fd);
+        error = "Error opening file: " + filename;
+        return false;
+    }
+
+    file.length = static_cast<size_t>(info.st_size);
+    if (file.length > 0) {
+        void* address = ::mmap(nullptr, file.length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            error = "Error reading file: " + filename;
+            return false;
+        }
+        ::madvise(address, file.length, MADV_SEQUENTIAL);
+        file.data = static_cast<const char*>(address);
+    }
+    ::close(fd);
+    return true;
+}
+
+} // namespace
+
+void parseClimateTableParallel(const char* data, size_t length, ThreadPool& pool, const IngestOptions& options,
+                               ClimateTable& table, IngestReport& report) {
+    size_t chunkBytes = options.chunkBytes;
+    if (chunkBytes == 0) {
+        chunkBytes = std::max(MIN_CHUNK_BYTES, length / (pool.size() * CHUNKS_PER_WORKER) + 1);
+    }
+
+    std::vector<Chunk> chunks = splitAtLines(data, length, chunkBytes);
+
+    // First pass: an upper bound on each chunk's rows gives it a slot in the
+    // table, so the second pass parses straight into the final columns
+    pool.parallelFor(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) countCandidates(chunks[c]);
+    });
+    size_t capacity = 0;
+    for (Chunk& chunk : chunks) {
+        chunk.firstRow = capacity;
+        capacity += chunk.candidates;
+    }
+
+    table.clear();
+    table.years.resize(capacity);
+    RowSink sink;
+    sink.years = table.years.mutableData();
+    for (int column = 0; column < VALUE_COLUMNS; ++column) {
+        Column<double>& target = valueColumn(table, column);
+        target.resize(capacity);
+        sink.values[column] = target.mutableData();
+    }
+
+    pool.parallelFor(0, chunks.size(), 1, [&](size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) parseChunk(chunks[c], sink, options.maxErrors);
+    });
+
+    // Merge the counts and, only after a malformed row, close the gaps it left
+    report = IngestReport();
+    for (Chunk& chunk : chunks) {
+        for (RowError& e : chunk.errors) {
+            e.line += report.lines;
+            if (report.errors.size() < options.maxErrors) report.errors.push_back(std::move(e));
+        }
+        report.lines += chunk.lines;
+        report.skipped += chunk.skipped;
+        report.errorCount += chunk.errorCount;
+
+        if (report.rows != chunk.firstRow) {
+            std::memmove(sink.years + report.rows, sink.years + chunk.firstRow, chunk.rows * sizeof(int));
+            for (int column = 0; column < VALUE_COLUMNS; ++column) {
+                std::memmove(sink.values[column] + report.rows, sink.values[column] + chunk.firstRow,
+                             chunk.rows * sizeof(double));
+            }
+        }
+        report.rows += chunk.rows;
+    }
+
+    if (report.rows != capacity) {
+        table.years.resize(report.rows);
+        for (int column = 0; column < VALUE_COLUMNS; ++column) {
+            valueColumn(table, column).resize(report.rows);
+        }
+    }
+}
+
+bool ingestClimateCsv(const std::string& filename, ThreadPool& pool, const IngestOptions& options,
+                      ClimateTable& table, IngestReport& report, std::string& error) {
+    MappedFile file;
+    if (!mapFile(filename, file, error)) {
+        return false;
+    }
+    parseClimateTableParallel(file.data, file.length, pool, options, table, report);
+    return true;
+}
+
+bool loadClimateTable(const std::string& filename, ThreadPool& pool, const IngestOptions& options,
+                      ClimateTable& table, IngestReport& report, std::string& error) {
+    report = IngestReport();
+    SourceStamp stamp;
+    if (!stampSource(filename, stamp, error)) {
+        return false;
+    }
+
+    const std::string cacheFilename = tableCacheFilename(filename);
+    std::string cacheError;
+    if (openTableCache(cacheFilename, stamp, false, table, nullptr, cacheError) == CACHE_OK) {
+        report.rows = table.size();
+        return true;
+    }
+
+    if (!ingestClimateCsv(filename, pool, options, table, report, error)) {
+        return false;
+    }
+    deriveMissingAggregates(table);
+    if (report.errorCount == 0) {
+        writeTableCache(table, stamp, cacheFilename, cacheError);
+    }
+    return true;
+}
+
+void writeIngestReport(const IngestReport& report, std::ostream& out) {
+    out << "Line,Error,Row\n";
+    for (const RowError& e : report.errors) {
+        // Quote the free-text fields; the row itself contains commas
+        auto quoted = [&](const std::string& s) {
+            out << '"';
+            for (char ch : s) {
+                if (ch == '"') out << '"';
+                out << ch;
+            }
+            out << '"';
+        };
+        out << e.line << ",";
+        quoted(e.message);
+        out << ",";
+        quoted(e.text);
+        out << "\n";
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef PARALLEL_INGEST_H
+#define PARALLEL_INGEST_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "climate_table.h"
+
+class ThreadPool;
+
+// One data row that could not be parsed
+struct RowError {
+    size_t line;         // 1-based line number in the file
+    std::string message; // e.g. "invalid value 'x' in column Mar"
+    std::string text;    // the row, truncated to MAX_ERROR_TEXT characters
+};
+
+// Outcome of a parallel ingest. Malformed rows are left out of the table and
+// listed here instead of stopping the load.
+struct IngestReport {
+    size_t lines = 0;        // lines in the file
+    size_t rows = 0;         // data rows in the table
+    size_t skipped = 0;      // title, header and blank lines
+    size_t errorCount = 0;   // malformed rows, including those not kept in errors
+    std::vector<RowError> errors; // the first maxErrors malformed rows, in file order
+};
+
+const size_t MAX_ERROR_TEXT = 200;
+
+struct IngestOptions {
+    size_t chunkBytes = 0;    // 0: split into about eight chunks per worker, at least 256 KiB each
+    size_t maxErrors = 1000;  // malformed rows kept in the report
+};
+
+// Function to parse a GISTEMP-style CSV held in memory on every worker of the
+// pool. The buffer is split at line boundaries, the chunks are parsed with
+// parseClimateRow (so title and repeated header lines, "***" cells and CRLF
+// line ends are handled as in parseClimateTable) and merged in file order.
+void parseClimateTableParallel(const char* data, size_t length, ThreadPool& pool, const IngestOptions& options,
+                               ClimateTable& table, IngestReport& report);
+
+// Function to map a CSV file and ingest it in parallel; false only when the
+// file cannot be read
+bool ingestClimateCsv(const std::string& filename, ThreadPool& pool, const IngestOptions& options,
+                      ClimateTable& table, IngestReport& report, std::string& error);
+
+// Function to load a CSV through its binary cache like readClimateTable, but
+// to ingest it in parallel when the cache is missing or stale. A table built
+// from rows with errors is not cached, so the errors are reported again on
+// the next load.
+bool loadClimateTable(const std::string& filename, ThreadPool& pool, const IngestOptions& options,
+                      ClimateTable& table, IngestReport& report, std::string& error);
+
+// Function to write the report's errors as CSV (Line,Error,Row)
+void writeIngestReport(const IngestReport& report, std::ostream& out);
+
+#endif // PARALLEL_INGEST_H
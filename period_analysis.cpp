@@ -0,0 +1,425 @@
+#include "period_analysis.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "record_engine.h"
+
+namespace {
+
+// Function to parse a value cell; "***" and empty cells are missing
+bool parseValue(const char* begin, const char* end, double& value) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    if (begin == end || (end - begin == 3 && std::memcmp(begin, "***", 3) == 0)) {
+        value = std::nan("");
+        return true;
+    }
+    if (*begin == '+') ++begin;
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+// Function to parse an integer field ending at a separator (or the line end)
+bool parseField(const char*& p, const char* end, long& field) {
+    auto result = std::from_chars(p, end, field);
+    p = result.ptr;
+    return result.ec == std::errc();
+}
+
+// Function to parse one data line (without its newline) into the period it
+// belongs to; title, header and blank lines are skipped
+template <typename Calendar>
+RowStatus parsePeriodLine(const char* begin, const char* end, int& year, int& period, double& value,
+                          std::string& error) {
+    if (end > begin && end[-1] == '\r') --end;
+    const char* p = begin;
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    if (p == end || *p < '0' || *p > '9') {
+        return ROW_SKIPPED;
+    }
+
+    long first = 0;
+    parseField(p, end, first);
+    if (p < end && *p == '-') {
+        // YYYY-MM-DD,value or YYYY-MM,value
+        long month = 0;
+        long day = 1; // YYYY-MM is the 1st
+        ++p;
+        bool ok = parseField(p, end, month);
+        if (ok && p < end && *p == '-') {
+            ++p;
+            ok = parseField(p, end, day);
+        }
+        if (!ok || p == end || *p != ',' || !parseValue(p + 1, end, value)) {
+            error = "malformed line";
+            return ROW_INVALID;
+        }
+        if (!calendar_detail::validDate(static_cast<int>(first), static_cast<int>(month), static_cast<int>(day))) {
+            error = "invalid date";
+            return ROW_INVALID;
+        }
+        Calendar::locate(static_cast<int>(first), static_cast<int>(month), static_cast<int>(day), year, period);
+        return ROW_OK;
+    }
+
+    // Year,Period,Value
+    long slot = 0;
+    if (p == end || *p != ',' || !parseField(++p, end, slot) || p == end || *p != ',' || !parseValue(p + 1, end, value)) {
+        error = "malformed line";
+        return ROW_INVALID;
+    }
+    if (slot < 1 || slot > Calendar::periods) {
+        error = "period out of range";
+        return ROW_INVALID;
+    }
+    year = static_cast<int>(first);
+    period = static_cast<int>(slot) - 1;
+    return ROW_OK;
+}
+
+// Function to call visit(year, period, value) for each present period in time
+// order, stopping at the last published value so that the missing tail of the
+// current year does not close a run that is still ongoing
+template <typename Calendar, typename Visit>
+void forEachPeriod(const PeriodTable<Calendar>& table, Visit visit) {
+    constexpr int P = Calendar::periods;
+    size_t rows = table.size();
+    int lastPeriod = P - 1;
+    while (rows > 0) {
+        while (lastPeriod >= 0 && isMissing(table.row(rows - 1)[lastPeriod])) --lastPeriod;
+        if (lastPeriod >= 0) break;
+        --rows;
+        lastPeriod = P - 1;
+    }
+
+    for (size_t r = 0; r < rows; ++r) {
+        const int year = table.years[r];
+        const double* values = table.row(r);
+        const int periods = r + 1 == rows ? lastPeriod + 1 : P;
+        for (int p = 0; p < periods; ++p) {
+            if (Calendar::present(year, p)) visit(year, p, values[p]);
+        }
+    }
+}
+
+} // namespace
+
+template <typename Calendar>
+bool readPeriodCsv(const std::string& filename, PeriodTable<Calendar>& table, std::string& error) {
+    constexpr int P = Calendar::periods;
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file) {
+        error = "Error opening file: " + filename;
+        return false;
+    }
+    const std::streamsize size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    std::string buffer(static_cast<size_t>(size), '\0');
+    if (size > 0 && !file.read(&buffer[0], size)) {
+        error = "Error reading file: " + filename;
+        return false;
+    }
+
+    // The year, period and value of every data line, as columns
+    thread_local std::vector<int> lineYears, linePeriods;
+    thread_local std::vector<double> lineValues;
+    lineYears.clear();
+    linePeriods.clear();
+    lineValues.clear();
+    const char* cursor = buffer.data();
+    const char* const bufferEnd = cursor + buffer.size();
+    size_t lineNumber = 0;
+    while (cursor < bufferEnd) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', bufferEnd - cursor));
+        const char* next = lineEnd ? lineEnd + 1 : bufferEnd;
+        if (!lineEnd) lineEnd = bufferEnd;
+        ++lineNumber;
+
+        int year, period;
+        double value;
+        const RowStatus status = parsePeriodLine<Calendar>(cursor, lineEnd, year, period, value, error);
+        if (status == ROW_INVALID) {
+            error = filename + ":" + std::to_string(lineNumber) + ": " + error + ": " + std::string(cursor, lineEnd);
+            return false;
+        }
+        if (status == ROW_OK) {
+            lineYears.push_back(year);
+            linePeriods.push_back(period);
+            lineValues.push_back(value);
+        }
+        cursor = next;
+    }
+    if (lineYears.empty()) {
+        error = filename + ": no data";
+        return false;
+    }
+
+    // One row per year from the first to the last, so the axis has no holes;
+    // values of the same period are averaged
+    const auto range = std::minmax_element(lineYears.begin(), lineYears.end());
+    const int first = *range.first;
+    const size_t rows = static_cast<size_t>(*range.second - first) + 1;
+    thread_local std::vector<int> counts;
+    counts.assign(rows * P, 0);
+    table.years.resize(rows);
+    table.values.assign(rows * P, 0.0);
+    for (size_t r = 0; r < rows; ++r) {
+        table.years[r] = first + static_cast<int>(r);
+    }
+    for (size_t i = 0; i < lineYears.size(); ++i) {
+        if (isMissing(lineValues[i])) continue;
+        const size_t slot = static_cast<size_t>(lineYears[i] - first) * P + linePeriods[i];
+        table.values[slot] += lineValues[i];
+        ++counts[slot];
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        double* values = table.row(r);
+        for (int p = 0; p < P; ++p) {
+            const int count = counts[r * P + p];
+            values[p] = count > 0 && Calendar::present(table.years[r], p) ? values[p] / count : std::nan("");
+        }
+    }
+    return true;
+}
+
+void toPeriodTable(const ClimateTable& table, PeriodTable<MonthlyCalendar>& periods) {
+    periods.years.assign(table.years.begin(), table.years.end());
+    periods.values.resize(table.size() * MONTHS_PER_YEAR);
+    for (size_t r = 0; r < table.size(); ++r) {
+        double* values = periods.row(r);
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) values[m] = table.month(m)[r];
+    }
+}
+
+void toPeriodTable(const ClimateTable& table, PeriodTable<SeasonalCalendar>& periods) {
+    periods.years.assign(table.years.begin(), table.years.end());
+    periods.values.resize(table.size() * SeasonalCalendar::periods);
+    for (size_t r = 0; r < table.size(); ++r) {
+        double* values = periods.row(r);
+        for (int s = 0; s < SeasonalCalendar::periods; ++s) {
+            values[s] = table.aggregate(static_cast<AggregateColumn>(AGG_DJF + s))[r];
+        }
+    }
+}
+
+template <typename Calendar>
+bool subtractClimatology(PeriodTable<Calendar>& table, int baseFirst, int baseLast, std::vector<int>& emptyPeriods,
+                         std::string& error) {
+    constexpr int P = Calendar::periods;
+    std::array<double, P> sum;
+    std::array<double, P> count;
+    sum.fill(0.0);
+    count.fill(0.0);
+    for (size_t r = 0; r < table.size(); ++r) {
+        if (table.years[r] < baseFirst || table.years[r] > baseLast) continue;
+        const double* values = table.row(r);
+        for (int p = 0; p < P; ++p) {
+            const bool valid = !isMissing(values[p]);
+            sum[p] += valid ? values[p] : 0.0;
+            count[p] += valid ? 1.0 : 0.0;
+        }
+    }
+
+    std::array<double, P> mean;
+    emptyPeriods.clear();
+    for (int p = 0; p < P; ++p) {
+        mean[p] = count[p] > 0.0 ? sum[p] / count[p] : std::nan("");
+        if (count[p] == 0.0) emptyPeriods.push_back(p);
+    }
+    if (emptyPeriods.size() == static_cast<size_t>(P)) {
+        error = "no valid value in the base years " + std::to_string(baseFirst) + "-" + std::to_string(baseLast);
+        if (!table.years.empty()) {
+            error += " (data covers " + std::to_string(table.years.front()) + "-" +
+                     std::to_string(table.years.back()) + ")";
+        }
+        return false;
+    }
+    for (size_t r = 0; r < table.size(); ++r) {
+        double* values = table.row(r);
+        for (int p = 0; p < P; ++p) values[p] -= mean[p];
+    }
+    return true;
+}
+
+template <typename Calendar>
+void computePeriodRecords(const PeriodTable<Calendar>& table, PeriodRecords<Calendar>& records) {
+    constexpr int P = Calendar::periods;
+    std::array<RecordTracker, P> trackers;
+    std::array<RegressionAccumulator, P> gaps;
+
+    bool isHigh, isLow;
+    int highGap, lowGap;
+    for (size_t r = 0; r < table.size(); ++r) {
+        const int year = table.years[r];
+        const double* values = table.row(r);
+        for (int p = 0; p < P; ++p) {
+            trackers[p].update(year, values[p], isHigh, isLow, highGap, lowGap);
+            if (highGap >= 0) gaps[p].add(year, highGap);
+        }
+    }
+
+    for (int p = 0; p < P; ++p) {
+        records.recordCount[p] = trackers[p].recordCount;
+        records.lowRecordCount[p] = trackers[p].lowRecordCount;
+        records.maxYear[p] = trackers[p].maxYear;
+        records.minYear[p] = trackers[p].minYear;
+        records.maxValue[p] = trackers[p].maxValue;
+        records.minValue[p] = trackers[p].minValue;
+        records.gapRegression[p] = gaps[p].result();
+    }
+}
+
+template <typename Calendar>
+void computePeriodTrends(const PeriodTable<Calendar>& table, PeriodTrends<Calendar>& trends) {
+    constexpr int P = Calendar::periods;
+    const size_t rows = table.size();
+
+    // First pass: counts and means. Missing values contribute zero, so the
+    // loop over periods has no branches and vectorizes.
+    std::array<double, P> count, sumX, sumY;
+    count.fill(0.0);
+    sumX.fill(0.0);
+    sumY.fill(0.0);
+    for (size_t r = 0; r < rows; ++r) {
+        const double year = table.years[r];
+        const double* values = table.row(r);
+        for (int p = 0; p < P; ++p) {
+            const bool valid = !isMissing(values[p]);
+            count[p] += valid ? 1.0 : 0.0;
+            sumX[p] += valid ? year : 0.0;
+            sumY[p] += valid ? values[p] : 0.0;
+        }
+    }
+    std::array<double, P> meanX, meanY;
+    for (int p = 0; p < P; ++p) {
+        meanX[p] = count[p] > 0.0 ? sumX[p] / count[p] : 0.0;
+        meanY[p] = count[p] > 0.0 ? sumY[p] / count[p] : 0.0;
+    }
+
+    // Second pass: centered sums, free of the cancellation of raw years
+    std::array<double, P> sxx, syy, sxy;
+    sxx.fill(0.0);
+    syy.fill(0.0);
+    sxy.fill(0.0);
+    for (size_t r = 0; r < rows; ++r) {
+        const double year = table.years[r];
+        const double* values = table.row(r);
+        for (int p = 0; p < P; ++p) {
+            const bool valid = !isMissing(values[p]);
+            const double dx = valid ? year - meanX[p] : 0.0;
+            const double dy = valid ? values[p] - meanY[p] : 0.0;
+            sxx[p] += dx * dx;
+            syy[p] += dy * dy;
+            sxy[p] += dx * dy;
+        }
+    }
+
+    for (int p = 0; p < P; ++p) {
+        trends.periods[p] = regressionFromMoments(count[p], meanX[p], meanY[p], sxx[p], syy[p], sxy[p]);
+    }
+}
+
+template <typename Calendar>
+void computePeriodSeasons(const PeriodTable<Calendar>& table, double minValidFraction, PeriodSeasons& seasons) {
+    constexpr int P = Calendar::periods;
+    const size_t rows = table.size();
+    seasons.years.assign(table.years.begin(), table.years.end());
+    for (std::vector<double>& season : seasons.seasons) season.assign(rows, std::nan(""));
+    seasons.annual.assign(rows, std::nan(""));
+
+    auto mean = [minValidFraction](double sum, int valid, int expected) {
+        return valid > 0 && valid >= minValidFraction * expected ? sum / valid : std::nan("");
+    };
+
+    for (size_t r = 0; r < rows; ++r) {
+        const int year = table.years[r];
+        const double* values = table.row(r);
+        // The December periods of DJF come from the previous year, if present
+        const double* previous = r > 0 && table.years[r - 1] == year - 1 ? table.row(r - 1) : nullptr;
+
+        double seasonSum[4] = {0.0, 0.0, 0.0, 0.0};
+        int seasonValid[4] = {0, 0, 0, 0};
+        int seasonExpected[4] = {0, 0, 0, 0};
+        double annualSum = 0.0;
+        int annualValid = 0;
+        int annualExpected = 0;
+
+        for (int p = 0; p < P; ++p) {
+            if (Calendar::present(year, p)) {
+                ++annualExpected;
+                if (!isMissing(values[p])) {
+                    annualSum += values[p];
+                    ++annualValid;
+                }
+            }
+
+            const bool fromPrevious = Calendar::inNextYearSeason(p);
+            const int sourceYear = fromPrevious ? year - 1 : year;
+            if (!Calendar::present(sourceYear, p)) continue;
+            const int s = Calendar::season(p);
+            ++seasonExpected[s];
+            const double value = fromPrevious ? (previous ? previous[p] : std::nan("")) : values[p];
+            if (!isMissing(value)) {
+                seasonSum[s] += value;
+                ++seasonValid[s];
+            }
+        }
+
+        for (int s = 0; s < 4; ++s) {
+            seasons.seasons[s][r] = mean(seasonSum[s], seasonValid[s], seasonExpected[s]);
+        }
+        seasons.annual[r] = mean(annualSum, annualValid, annualExpected);
+    }
+}
+
+template <typename Calendar>
+std::vector<AnomalyRun> detectPeriodRuns(const PeriodTable<Calendar>& table, double amplitude) {
+    std::vector<AnomalyRun> runs;
+    RunState state;
+    state.amplitude = amplitude;
+
+    AnomalyRun run;
+    forEachPeriod(table, [&](int year, int period, double value) {
+        if (state.add<Calendar>(year, period, value, run)) runs.push_back(run);
+    });
+    if (state.current(run)) runs.push_back(run);
+    return runs;
+}
+
+template <typename Calendar>
+PeriodEventSummary countPeriodEvents(const PeriodTable<Calendar>& table, int threshold, double amplitude) {
+    EventCounter counter;
+    counter.threshold = threshold;
+    counter.run.amplitude = amplitude;
+
+    PeriodEventSummary summary;
+    forEachPeriod(table, [&](int year, int period, double value) {
+        counter.add<Calendar>(year, period, value);
+        ++summary.periodsSeen;
+    });
+    summary.heatwaveCount = counter.heatwaveCount;
+    summary.coldSnapCount = counter.coldSnapCount;
+    summary.longestHeatwave = counter.longestHeatwave;
+    summary.longestColdSnap = counter.longestColdSnap;
+    return summary;
+}
+
+#define INSTANTIATE_PERIOD_ANALYSIS(Calendar)                                                                     \
+    template bool readPeriodCsv(const std::string&, PeriodTable<Calendar>&, std::string&);                         \
+    template bool subtractClimatology(PeriodTable<Calendar>&, int, int, std::vector<int>&, std::string&);         \
+    template void computePeriodRecords(const PeriodTable<Calendar>&, PeriodRecords<Calendar>&);                    \
+    template void computePeriodTrends(const PeriodTable<Calendar>&, PeriodTrends<Calendar>&);                      \
+    template void computePeriodSeasons(const PeriodTable<Calendar>&, double, PeriodSeasons&);                      \
+    template std::vector<AnomalyRun> detectPeriodRuns(const PeriodTable<Calendar>&, double);                       \
+    template PeriodEventSummary countPeriodEvents(const PeriodTable<Calendar>&, int, double);
+
+INSTANTIATE_PERIOD_ANALYSIS(MonthlyCalendar)
+INSTANTIATE_PERIOD_ANALYSIS(SeasonalCalendar)
+INSTANTIATE_PERIOD_ANALYSIS(WeeklyCalendar)
+INSTANTIATE_PERIOD_ANALYSIS(DailyCalendar)
+
+#undef INSTANTIATE_PERIOD_ANALYSIS
@@ -0,0 +1,117 @@
+#ifndef PERIOD_ANALYSIS_H
+#define PERIOD_ANALYSIS_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "climate_table.h"
+#include "extreme_events.h"
+#include "period_calendar.h"
+#include "regression.h"
+
+// The record, trend, seasonal and extreme-event analyses for a series of any
+// calendar in period_calendar.h. Every loop over the periods of a year runs
+// to Calendar::periods, a compile-time constant, so the per-period state sits
+// in fixed-size arrays and the loops are specialized (and unrolled or
+// vectorized) for each calendar instead of going through a generic path.
+
+// Year-major series: the value of period p in row r is values[r * periods + p].
+// Years are strictly increasing but need not be contiguous. NaN marks both a
+// missing value and a period absent in that year (February 29 of a common
+// year).
+template <typename Calendar>
+struct PeriodTable {
+    std::vector<int> years;
+    std::vector<double> values;
+
+    size_t size() const { return years.size(); }
+    bool empty() const { return years.empty(); }
+    const double* row(size_t r) const { return values.data() + r * Calendar::periods; }
+    double* row(size_t r) { return values.data() + r * Calendar::periods; }
+};
+
+// Record highs and lows of every period, each period being its own series
+// over the years (every January 1, every week 30, ...)
+template <typename Calendar>
+struct PeriodRecords {
+    std::array<int, Calendar::periods> recordCount;    // years that set or tied the record high
+    std::array<int, Calendar::periods> lowRecordCount; // same for the record low
+    std::array<int, Calendar::periods> maxYear;        // earliest year holding the high, -1 if none
+    std::array<int, Calendar::periods> minYear;
+    std::array<double, Calendar::periods> maxValue;
+    std::array<double, Calendar::periods> minValue;
+    std::array<RegressionResult, Calendar::periods> gapRegression; // years between record highs on year
+};
+
+// Least squares trend of every period over the years, in units per year
+template <typename Calendar>
+struct PeriodTrends {
+    std::array<RegressionResult, Calendar::periods> periods;
+};
+
+// Season and calendar-year means. DJF of year y takes the December periods
+// of y - 1. A mean is NaN when fewer than minValidFraction of the periods it
+// covers are present.
+struct PeriodSeasons {
+    std::vector<int> years;
+    std::vector<double> seasons[4]; // DJF, MAM, JJA, SON
+    std::vector<double> annual;     // January-December (December-November when seasonal)
+};
+
+// Heatwave / cold snap summary of one series at one amplitude and duration
+struct PeriodEventSummary {
+    int heatwaveCount = 0;
+    int coldSnapCount = 0;
+    int longestHeatwave = 0; // in periods
+    int longestColdSnap = 0;
+    size_t periodsSeen = 0;  // periods fed to the detector
+};
+
+// Function to read a series of the calendar. Each data line is either
+// "YYYY-MM-DD,value" or "YYYY-MM,value" (values falling in the same period
+// are averaged, so a daily file can be read as weekly or monthly) or
+// "Year,Period,Value" with a 1-based period. Lines whose first field is not a number are skipped as
+// headers; "***" or an empty value is missing. A date that does not exist
+// (February 30, or February 29 of a common year) is an error.
+template <typename Calendar>
+bool readPeriodCsv(const std::string& filename, PeriodTable<Calendar>& table, std::string& error);
+
+// Function to take the monthly columns of a ClimateTable as a monthly series
+void toPeriodTable(const ClimateTable& table, PeriodTable<MonthlyCalendar>& periods);
+
+// Function to take the DJF..SON columns of a ClimateTable as a seasonal series
+void toPeriodTable(const ClimateTable& table, PeriodTable<SeasonalCalendar>& periods);
+
+// Function to turn values into anomalies against the mean of each period
+// over the base years (inclusive). Fails and leaves the table untouched when
+// the base years hold no valid value at all; otherwise periods with no base
+// value become NaN and are listed in emptyPeriods.
+template <typename Calendar>
+bool subtractClimatology(PeriodTable<Calendar>& table, int baseFirst, int baseLast, std::vector<int>& emptyPeriods,
+                         std::string& error);
+
+// Function to compute the records of every period in one pass over the rows
+template <typename Calendar>
+void computePeriodRecords(const PeriodTable<Calendar>& table, PeriodRecords<Calendar>& records);
+
+// Function to regress every period on the year in two passes over the rows
+template <typename Calendar>
+void computePeriodTrends(const PeriodTable<Calendar>& table, PeriodTrends<Calendar>& trends);
+
+// Function to compute season and calendar-year means
+template <typename Calendar>
+void computePeriodSeasons(const PeriodTable<Calendar>& table, double minValidFraction, PeriodSeasons& seasons);
+
+// Function to find every warm and cold run of the series in time order,
+// following runs across year ends; absent periods are skipped and a gap
+// between years ends a run
+template <typename Calendar>
+std::vector<AnomalyRun> detectPeriodRuns(const PeriodTable<Calendar>& table, double amplitude);
+
+// Function to count heatwaves and cold snaps of at least threshold periods
+template <typename Calendar>
+PeriodEventSummary countPeriodEvents(const PeriodTable<Calendar>& table, int threshold, double amplitude);
+
+#endif // PERIOD_ANALYSIS_H
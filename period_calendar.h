@@ -0,0 +1,130 @@
+#ifndef PERIOD_CALENDAR_H
+#define PERIOD_CALENDAR_H
+
+// Calendars of a periodic series. Each says how many periods a year has
+// (a compile-time constant, so loops over the periods of a year have a fixed
+// trip count), whether a period exists in a given year, where a period sits
+// on a continuous time axis (consecutive periods differ by one, so runs are
+// followed across year ends and leap days) and which meteorological season
+// it belongs to. December periods belong to the DJF season of the next year.
+//
+// Periods are 0-based. The daily calendar has 366 fixed day-of-year slots
+// with February 29 at slot 59, so a calendar day keeps its slot in every
+// year; the slot is absent in common years. Weeks are the 52 seven-day blocks
+// from January 1, the last one absorbing the one or two remaining days.
+
+namespace calendar_detail {
+
+// First day-of-year slot of each month in a leap year, and in a common year
+constexpr int LEAP_MONTH_START[13] = {0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335, 366};
+constexpr int COMMON_MONTH_START[13] = {0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365};
+
+constexpr bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Days from 0001-01-01 to January 1 of year (proleptic Gregorian)
+constexpr long daysBeforeYear(int year) {
+    const long y = year - 1;
+    return y * 365 + y / 4 - y / 100 + y / 400;
+}
+
+// Season (0 DJF, 1 MAM, 2 JJA, 3 SON) of a 0-based month
+constexpr int monthSeason(int month) {
+    return ((month + 1) % 12) / 3;
+}
+
+constexpr int monthOfSlot(int slot) {
+    int month = 0;
+    while (month < 11 && LEAP_MONTH_START[month + 1] <= slot) ++month;
+    return month;
+}
+
+// Whether a date exists (month 1-12; February 29 only in leap years)
+constexpr bool validDate(int year, int month, int day) {
+    if (month < 1 || month > 12 || day < 1) return false;
+    const int* start = isLeapYear(year) ? LEAP_MONTH_START : COMMON_MONTH_START;
+    return day <= start[month] - start[month - 1];
+}
+
+// Day of year (0-based, leap-aware) of a date; month 1-12, day 1-31
+constexpr int dayOfYear(int year, int month, int day) {
+    return (isLeapYear(year) ? LEAP_MONTH_START[month - 1] : COMMON_MONTH_START[month - 1]) + day - 1;
+}
+
+} // namespace calendar_detail
+
+struct MonthlyCalendar {
+    static constexpr int periods = 12;
+    static constexpr const char* name = "monthly";
+
+    static constexpr bool present(int, int) { return true; }
+    static constexpr long sequence(int year, int period) { return static_cast<long>(year) * periods + period; }
+    static constexpr int season(int period) { return calendar_detail::monthSeason(period); }
+    static constexpr bool inNextYearSeason(int period) { return period == 11; }
+
+    // Function to find the period of a date, which must pass calendar_detail::validDate
+    static void locate(int year, int month, int, int& periodYear, int& period) {
+        periodYear = year;
+        period = month - 1;
+    }
+};
+
+// DJF, MAM, JJA, SON, with the December of DJF taken from the previous year
+struct SeasonalCalendar {
+    static constexpr int periods = 4;
+    static constexpr const char* name = "seasonal";
+
+    static constexpr bool present(int, int) { return true; }
+    static constexpr long sequence(int year, int period) { return static_cast<long>(year) * periods + period; }
+    static constexpr int season(int period) { return period; }
+    static constexpr bool inNextYearSeason(int) { return false; }
+
+    static void locate(int year, int month, int, int& periodYear, int& period) {
+        periodYear = month == 12 ? year + 1 : year;
+        period = calendar_detail::monthSeason(month - 1);
+    }
+};
+
+struct WeeklyCalendar {
+    static constexpr int periods = 52;
+    static constexpr const char* name = "weekly";
+
+    static constexpr bool present(int, int) { return true; }
+    static constexpr long sequence(int year, int period) { return static_cast<long>(year) * periods + period; }
+    // By the month holding the middle of the week
+    static constexpr int season(int period) {
+        return calendar_detail::monthSeason(calendar_detail::monthOfSlot(period * 7 + 3));
+    }
+    static constexpr bool inNextYearSeason(int period) { return calendar_detail::monthOfSlot(period * 7 + 3) == 11; }
+
+    static void locate(int year, int month, int day, int& periodYear, int& period) {
+        periodYear = year;
+        const int week = calendar_detail::dayOfYear(year, month, day) / 7;
+        period = week < periods ? week : periods - 1;
+    }
+};
+
+struct DailyCalendar {
+    static constexpr int periods = 366;
+    static constexpr const char* name = "daily";
+    static constexpr int LEAP_DAY = 59; // slot of February 29
+
+    static constexpr bool present(int year, int period) {
+        return period != LEAP_DAY || calendar_detail::isLeapYear(year);
+    }
+    // Days since 0001-01-01
+    static constexpr long sequence(int year, int period) {
+        const bool skipLeapDay = period > LEAP_DAY && !calendar_detail::isLeapYear(year);
+        return calendar_detail::daysBeforeYear(year) + period - (skipLeapDay ? 1 : 0);
+    }
+    static constexpr int season(int period) { return calendar_detail::monthSeason(calendar_detail::monthOfSlot(period)); }
+    static constexpr bool inNextYearSeason(int period) { return period >= calendar_detail::LEAP_MONTH_START[11]; }
+
+    static void locate(int year, int month, int day, int& periodYear, int& period) {
+        periodYear = year;
+        period = calendar_detail::LEAP_MONTH_START[month - 1] + day - 1;
+    }
+};
+
+#endif // PERIOD_CALENDAR_H
@@ -0,0 +1,137 @@
+#include "quantile_sketch.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
+#include "counter_rng.h"
+
+QuantileSketch::QuantileSketch(int k, std::uint64_t seed) : k_(k), seed_(seed) {
+}
+
+namespace {
+
+// (2/3)^depth; more levels than this would take over 2^64 values
+const int MAX_DEPTH = 64;
+const std::array<double, MAX_DEPTH> SHRINK = [] {
+    std::array<double, MAX_DEPTH> factors;
+    factors[0] = 1.0;
+    for (int d = 1; d < MAX_DEPTH; ++d) factors[d] = factors[d - 1] * (2.0 / 3.0);
+    return factors;
+}();
+
+} // namespace
+
+size_t QuantileSketch::capacity(size_t level) const {
+    // Compactors shrink geometrically below the top one, by 2/3 per level
+    const size_t depth = std::min<size_t>(levels_.size() - 1 - level, MAX_DEPTH - 1);
+    return std::max<size_t>(2, static_cast<size_t>(std::ceil(k_ * SHRINK[depth])));
+}
+
+void QuantileSketch::add(double value) {
+    if (std::isnan(value)) {
+        return;
+    }
+    if (levels_.empty()) {
+        levels_.emplace_back();
+        capacityTotal_ = capacity(0);
+    }
+    levels_[0].push_back(value);
+    ++count_;
+    ++retained_;
+    if (retained_ > capacityTotal_) {
+        compress();
+    }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+    if (other.levels_.size() > levels_.size()) {
+        levels_.resize(other.levels_.size());
+    }
+    for (size_t h = 0; h < other.levels_.size(); ++h) {
+        levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+    }
+    count_ += other.count_;
+    retained_ += other.retained_;
+    compress();
+}
+
+void QuantileSketch::clear() {
+    for (std::vector<double>& level : levels_) level.clear();
+    levels_.resize(std::min<size_t>(levels_.size(), 1));
+    capacityTotal_ = levels_.empty() ? 0 : capacity(0);
+    count_ = 0;
+    retained_ = 0;
+    compactions_ = 0;
+}
+
+void QuantileSketch::compress() {
+    for (;;) {
+        capacityTotal_ = 0;
+        for (size_t h = 0; h < levels_.size(); ++h) capacityTotal_ += capacity(h);
+        if (retained_ <= capacityTotal_) {
+            return;
+        }
+
+        // The lowest compactor at or over its capacity halves into the next level
+        size_t h = 0;
+        while (h + 1 < levels_.size() && levels_[h].size() < capacity(h)) ++h;
+        if (h + 1 == levels_.size()) {
+            levels_.emplace_back();
+        }
+        std::vector<double>& level = levels_[h];
+        std::sort(level.begin(), level.end());
+
+        // An odd value out stays behind, so the promoted weight is exact
+        const size_t kept = level.size() % 2;
+        CounterRng coin(seed_, compactions_++, 0);
+        for (size_t i = kept + (coin.next() & 1u); i < level.size(); i += 2) {
+            levels_[h + 1].push_back(level[i]);
+        }
+        retained_ -= (level.size() - kept) / 2;
+        level.resize(kept);
+    }
+}
+
+double QuantileSketch::quantile(double q) const {
+    double value;
+    quantiles(&q, 1, &value);
+    return value;
+}
+
+void QuantileSketch::quantiles(const double* qs, size_t n, double* out) const {
+    if (count_ == 0) {
+        std::fill(out, out + n, NAN);
+        return;
+    }
+
+    // (value, weight) of every retained value in value order
+    thread_local std::vector<std::pair<double, double>> items;
+    items.clear();
+    for (size_t h = 0; h < levels_.size(); ++h) {
+        const double weight = std::ldexp(1.0, static_cast<int>(h));
+        for (double value : levels_[h]) items.emplace_back(value, weight);
+    }
+    std::sort(items.begin(), items.end());
+
+    // A value of weight w covers w consecutive ranks; interpolate between the
+    // centres of those spans. With unit weights this is numpy's linear rule.
+    for (size_t j = 0; j < n; ++j) {
+        const double target = std::min(std::max(qs[j], 0.0), 1.0) * (static_cast<double>(count_) - 1.0);
+        double before = 0.0;
+        double previousCentre = 0.0, previousValue = items.front().first;
+        out[j] = items.back().first;
+        for (size_t i = 0; i < items.size(); ++i) {
+            const double centre = before + (items[i].second - 1.0) / 2.0;
+            if (centre >= target) {
+                const double fraction = i == 0 ? 0.0 : (target - previousCentre) / (centre - previousCentre);
+                out[j] = previousValue + fraction * (items[i].first - previousValue);
+                break;
+            }
+            previousCentre = centre;
+            previousValue = items[i].first;
+            before += items[i].second;
+        }
+    }
+}
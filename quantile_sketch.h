@@ -0,0 +1,61 @@
+#ifndef QUANTILE_SKETCH_H
+#define QUANTILE_SKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streaming quantile sketch (KLL: Karnin, Lang and Liberty 2016). Values are
+// kept in a stack of compactors; compactor h holds values that each stand
+// for 2^h inputs. When the sketch is over capacity, the lowest full
+// compactor is sorted and every other value (odd or even positions, by a
+// coin flip) moves up a level, so the sketch keeps O(k) values for any
+// number of inputs. Until it first compacts the sketch holds every value and
+// its quantiles are exact; after that a quantile's rank is off by about
+// 1.7 / k of the count with high probability (about 1% at the default k).
+//
+// Sketches of disjoint parts of the data merge into a sketch of the whole,
+// so they can be built in parallel over threads or grid cells. The coin
+// flips come from CounterRng streams numbered by compaction, so a sketch
+// built from the same inputs in the same order is always the same.
+class QuantileSketch {
+public:
+    // k (at least 8) sets the size of the top compactor and so the accuracy
+    explicit QuantileSketch(int k = 200, std::uint64_t seed = 1880);
+
+    // Function to add one value; NaN values are ignored
+    void add(double value);
+
+    // Function to add every value of another sketch
+    void merge(const QuantileSketch& other);
+
+    // Function to empty the sketch, keeping its buffers
+    void clear();
+
+    // Function to return the q-quantile, 0 <= q <= 1, interpolated linearly
+    // between ranks as numpy's default percentile does; NaN when empty
+    double quantile(double q) const;
+
+    // Function to return several quantiles with one sort of the sketch
+    void quantiles(const double* qs, size_t n, double* out) const;
+
+    int k() const { return k_; }
+    size_t count() const { return count_; }     // values added
+    size_t retained() const { return retained_; } // values held
+    bool empty() const { return count_ == 0; }
+
+private:
+    size_t capacity(size_t level) const;
+    // Function to compact levels until the sketch is back under capacity
+    void compress();
+
+    int k_;
+    std::uint64_t seed_;
+    std::uint64_t compactions_ = 0;
+    size_t count_ = 0;
+    size_t retained_ = 0;
+    size_t capacityTotal_ = 0; // sum of the level capacities
+    std::vector<std::vector<double>> levels_;
+};
+
+#endif // QUANTILE_SKETCH_H
@@ -0,0 +1,226 @@
+#include "range_index.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+// Function to parse YYYY or, when months is set, YYYY-MM (month 0-based; -1 if absent)
+bool parseBound(const std::string& text, bool months, int& year, int& month) {
+    char* end;
+    year = static_cast<int>(std::strtol(text.c_str(), &end, 10));
+    month = -1;
+    if (end == text.c_str()) return false;
+    if (*end == '-' && months) {
+        const char* monthText = end + 1;
+        month = static_cast<int>(std::strtol(monthText, &end, 10)) - 1;
+        if (end == monthText || month < 0 || month >= MONTHS_PER_YEAR) return false;
+    }
+    return *end == '\0';
+}
+
+// Function to format the position of an extreme as YYYY or YYYY-MM
+std::string formatWhen(int year, int month, bool months) {
+    if (!months) return std::to_string(year);
+    char text[16];
+    std::snprintf(text, sizeof(text), "%d-%02d", year, month + 1);
+    return text;
+}
+
+} // namespace
+
+void SeriesIndex::build(const double* values, size_t n) {
+    values_ = values;
+    n_ = n;
+    blocks_ = (n + RANGE_BLOCK - 1) / RANGE_BLOCK;
+
+    prefixSum_.assign(n + 1, 0.0);
+    prefixCount_.assign(n + 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        const bool valid = !isMissing(values[i]);
+        prefixSum_[i + 1] = prefixSum_[i] + (valid ? values[i] : 0.0);
+        prefixCount_[i + 1] = prefixCount_[i] + (valid ? 1 : 0);
+    }
+
+    // Level 0 holds each block's extreme; level l combines two of level l - 1
+    size_t levels = 1;
+    while ((size_t(1) << levels) <= blocks_) ++levels;
+    maxTable_.assign(levels * blocks_, -1);
+    minTable_.assign(levels * blocks_, -1);
+    for (size_t b = 0; b < blocks_; ++b) {
+        const size_t last = std::min(n, (b + 1) * RANGE_BLOCK);
+        maxTable_[b] = static_cast<std::int32_t>(scan(b * RANGE_BLOCK, last, true));
+        minTable_[b] = static_cast<std::int32_t>(scan(b * RANGE_BLOCK, last, false));
+    }
+    for (size_t level = 1; level < levels; ++level) {
+        const size_t half = size_t(1) << (level - 1);
+        const std::int32_t* maxBelow = &maxTable_[(level - 1) * blocks_];
+        const std::int32_t* minBelow = &minTable_[(level - 1) * blocks_];
+        for (size_t b = 0; b + 2 * half <= blocks_; ++b) {
+            maxTable_[level * blocks_ + b] = static_cast<std::int32_t>(better(maxBelow[b], maxBelow[b + half], true));
+            minTable_[level * blocks_ + b] = static_cast<std::int32_t>(better(minBelow[b], minBelow[b + half], false));
+        }
+    }
+}
+
+long SeriesIndex::better(long a, long b, bool highest) const {
+    if (a < 0) return b;
+    if (b < 0) return a;
+    const double va = values_[a], vb = values_[b];
+    if (va == vb) return std::min(a, b);
+    return (highest ? vb > va : vb < va) ? b : a;
+}
+
+long SeriesIndex::scan(size_t first, size_t last, bool highest) const {
+    long best = -1;
+    for (size_t i = first; i < last; ++i) {
+        if (isMissing(values_[i])) continue;
+        if (best < 0 || (highest ? values_[i] > values_[best] : values_[i] < values_[best])) {
+            best = static_cast<long>(i);
+        }
+    }
+    return best;
+}
+
+long SeriesIndex::extreme(const std::vector<std::int32_t>& table, size_t first, size_t last, bool highest) const {
+    if (first >= last) return -1;
+
+    // Whole blocks strictly inside the range
+    const size_t firstBlock = (first + RANGE_BLOCK - 1) / RANGE_BLOCK;
+    const size_t lastBlock = last / RANGE_BLOCK;
+    if (firstBlock >= lastBlock) {
+        return scan(first, last, highest);
+    }
+
+    long best = scan(first, firstBlock * RANGE_BLOCK, highest);
+    size_t level = 0;
+    while ((size_t(2) << level) <= lastBlock - firstBlock) ++level;
+    best = better(best, table[level * blocks_ + firstBlock], highest);
+    best = better(best, table[level * blocks_ + lastBlock - (size_t(1) << level)], highest);
+    return better(best, scan(lastBlock * RANGE_BLOCK, last, highest), highest);
+}
+
+bool RangeIndex::build(const ClimateTable& table, std::string& error) {
+    const size_t n = table.size();
+    for (size_t i = 1; i < n; ++i) {
+        if (table.years[i] <= table.years[i - 1]) {
+            error = "years are not increasing at " + std::to_string(table.years[i]);
+            return false;
+        }
+    }
+
+    table_ = &table;
+    for (int column = 0; column < VALUE_COLUMNS; ++column) {
+        const Column<double>& values = column < MONTHS_PER_YEAR
+                                           ? table.month(column)
+                                           : table.aggregate(static_cast<AggregateColumn>(column - MONTHS_PER_YEAR));
+        columns_[column].build(values.data(), n);
+    }
+
+    timeline_.resize(n * MONTHS_PER_YEAR);
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const double* values = table.month(month).data();
+        for (size_t row = 0; row < n; ++row) timeline_[row * MONTHS_PER_YEAR + month] = values[row];
+    }
+    columns_[TIMELINE_COLUMN].build(timeline_.data(), timeline_.size());
+    return true;
+}
+
+RangeStats RangeIndex::summarize(int column, size_t first, size_t last) const {
+    RangeStats stats;
+    const SeriesIndex& index = columns_[column];
+    stats.count = index.count(first, last);
+    if (stats.count == 0) {
+        return stats;
+    }
+    stats.sum = index.sum(first, last);
+    stats.mean = stats.sum / stats.count;
+
+    // Positions are rows, or row * 12 + month on the timeline
+    auto locate = [&](long position, int& year, int& month) {
+        if (column == TIMELINE_COLUMN) {
+            year = table_->years[position / MONTHS_PER_YEAR];
+            month = static_cast<int>(position % MONTHS_PER_YEAR);
+        } else {
+            year = table_->years[position];
+            month = column < MONTHS_PER_YEAR ? column : -1;
+        }
+    };
+    const long maxPosition = index.argMax(first, last);
+    const long minPosition = index.argMin(first, last);
+    stats.max = index.value(maxPosition);
+    locate(maxPosition, stats.maxYear, stats.maxMonth);
+    stats.min = index.value(minPosition);
+    locate(minPosition, stats.minYear, stats.minMonth);
+    return stats;
+}
+
+RangeStats RangeIndex::query(int column, int firstYear, int lastYear) const {
+    if (column < 0 || column >= VALUE_COLUMNS || !table_) {
+        return RangeStats();
+    }
+    const int* years = table_->years.data();
+    const size_t n = table_->size();
+    const size_t first = std::lower_bound(years, years + n, firstYear) - years;
+    const size_t last = std::upper_bound(years, years + n, lastYear) - years;
+    return first < last ? summarize(column, first, last) : RangeStats();
+}
+
+RangeStats RangeIndex::queryMonths(int firstYear, int firstMonth, int lastYear, int lastMonth) const {
+    if (!table_) {
+        return RangeStats();
+    }
+    const int* years = table_->years.data();
+    const size_t n = table_->size();
+
+    // A bound in a year the table does not hold moves to the next year present
+    size_t row = std::lower_bound(years, years + n, firstYear) - years;
+    const size_t first = row * MONTHS_PER_YEAR + (row < n && years[row] == firstYear ? firstMonth : 0);
+    row = std::lower_bound(years, years + n, lastYear) - years;
+    const size_t last = row * MONTHS_PER_YEAR + (row < n && years[row] == lastYear ? lastMonth + 1 : 0);
+    return first < last ? summarize(TIMELINE_COLUMN, first, last) : RangeStats();
+}
+
+int findRangeColumn(const std::string& name) {
+    for (int column = 0; column <= TIMELINE_COLUMN; ++column) {
+        if (name == rangeColumnName(column)) return column;
+    }
+    return -1;
+}
+
+const char* rangeColumnName(int column) {
+    if (column == TIMELINE_COLUMN) return "Monthly";
+    if (column < MONTHS_PER_YEAR) return monthName(column);
+    return aggregateName(static_cast<AggregateColumn>(column - MONTHS_PER_YEAR));
+}
+
+bool runRangeQuery(const RangeIndex& index, const std::string& line, std::ostream& out) {
+    std::istringstream fields(line);
+    std::string name, firstText, lastText, extra;
+    if (!(fields >> name >> firstText)) return false;
+    if (!(fields >> lastText)) lastText = firstText;
+    if (fields >> extra) return false;
+
+    const int column = findRangeColumn(name);
+    const bool months = column == TIMELINE_COLUMN;
+    int firstYear, firstMonth, lastYear, lastMonth;
+    if (column < 0 || !parseBound(firstText, months, firstYear, firstMonth) ||
+        !parseBound(lastText, months, lastYear, lastMonth)) {
+        return false;
+    }
+
+    RangeStats stats = months ? index.queryMonths(firstYear, firstMonth < 0 ? 0 : firstMonth, lastYear,
+                                                  lastMonth < 0 ? MONTHS_PER_YEAR - 1 : lastMonth)
+                              : index.query(column, firstYear, lastYear);
+
+    out << name << " " << firstText << (lastText == firstText ? "" : " to " + lastText) << ": count " << stats.count;
+    if (stats.count > 0) {
+        out << ", mean " << stats.mean << ", sum " << stats.sum
+            << ", max " << stats.max << " (" << formatWhen(stats.maxYear, stats.maxMonth, months) << ")"
+            << ", min " << stats.min << " (" << formatWhen(stats.minYear, stats.minMonth, months) << ")";
+    }
+    out << "\n";
+    return true;
+}
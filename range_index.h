@@ -0,0 +1,103 @@
+#ifndef RANGE_INDEX_H
+#define RANGE_INDEX_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "climate_table.h"
+
+// Range maximum, minimum, sum and count of valid values over one series.
+// Sums and counts come from prefix arrays (O(1)). Extremes come from a
+// sparse table over blocks of RANGE_BLOCK values plus a scan of the partial
+// blocks at both ends, so a query costs O(1) plus at most two block scans
+// while the table stays O(n / RANGE_BLOCK * log n) in size. The values are
+// not copied and must outlive the index.
+const size_t RANGE_BLOCK = 32;
+
+class SeriesIndex {
+public:
+    void build(const double* values, size_t n);
+
+    size_t size() const { return n_; }
+    double value(size_t i) const { return values_[i]; }
+
+    // Queries over positions [first, last); argMax/argMin return the earliest
+    // position holding the extreme, or -1 when the range has no valid value
+    size_t count(size_t first, size_t last) const { return prefixCount_[last] - prefixCount_[first]; }
+    double sum(size_t first, size_t last) const { return prefixSum_[last] - prefixSum_[first]; }
+    long argMax(size_t first, size_t last) const { return extreme(maxTable_, first, last, true); }
+    long argMin(size_t first, size_t last) const { return extreme(minTable_, first, last, false); }
+
+private:
+    long better(long a, long b, bool highest) const;
+    long scan(size_t first, size_t last, bool highest) const;
+    long extreme(const std::vector<std::int32_t>& table, size_t first, size_t last, bool highest) const;
+
+    const double* values_ = nullptr;
+    size_t n_ = 0;
+    size_t blocks_ = 0;
+    std::vector<double> prefixSum_;
+    std::vector<std::uint32_t> prefixCount_;
+    std::vector<std::int32_t> maxTable_; // level l, block b at l * blocks_ + b
+    std::vector<std::int32_t> minTable_;
+};
+
+// Pseudo column of RangeIndex: every monthly value in time order, for
+// queries over year-month intervals that cross calendar years
+const int TIMELINE_COLUMN = VALUE_COLUMNS;
+
+// Answer to one range query. Years and months of the extremes are -1 when
+// the range has no valid value; months are 0-based and -1 for aggregates.
+struct RangeStats {
+    size_t count = 0;
+    double sum = 0.0;
+    double mean = NAN;
+    double max = NAN;
+    int maxYear = -1;
+    int maxMonth = -1;
+    double min = NAN;
+    int minYear = -1;
+    int minMonth = -1;
+};
+
+// Index over every value column of a table (months, then aggregates, as in a
+// CSV row) and the monthly timeline, built once and queried many times. The
+// table must outlive the index and its years must be strictly increasing;
+// years absent from the table are simply not in any range.
+class RangeIndex {
+public:
+    bool build(const ClimateTable& table, std::string& error);
+
+    // Function to summarize column over the years firstYear..lastYear inclusive
+    RangeStats query(int column, int firstYear, int lastYear) const;
+
+    // Function to summarize the monthly timeline from firstYear-firstMonth to
+    // lastYear-lastMonth inclusive (0-based months)
+    RangeStats queryMonths(int firstYear, int firstMonth, int lastYear, int lastMonth) const;
+
+private:
+    RangeStats summarize(int column, size_t first, size_t last) const;
+
+    const ClimateTable* table_ = nullptr;
+    std::vector<double> timeline_;
+    SeriesIndex columns_[VALUE_COLUMNS + 1];
+};
+
+// Function to look up a value column by its CSV header name ("Jan".."Dec",
+// "J-D", "D-N", "DJF", "MAM", "JJA", "SON") or "Monthly" for the timeline;
+// returns -1 for an unknown name
+int findRangeColumn(const std::string& name);
+
+// Header name of a RangeIndex column
+const char* rangeColumnName(int column);
+
+// Function to answer a query written "COLUMN FIRST [LAST]" (bounds are years,
+// or YYYY-MM for Monthly) with one line of text; returns false if the query
+// is malformed
+bool runRangeQuery(const RangeIndex& index, const std::string& query, std::ostream& out);
+
+#endif // RANGE_INDEX_H
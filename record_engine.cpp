@@ -0,0 +1,105 @@
+#include "record_engine.h"
+
+#include <limits>
+
+RecordTracker::RecordTracker()
+    : maxValue(std::numeric_limits<double>::quiet_NaN()),
+      minValue(std::numeric_limits<double>::quiet_NaN()),
+      secondValue(std::numeric_limits<double>::quiet_NaN()) {
+}
+
+void RecordTracker::update(int year, double value, bool& isHigh, bool& isLow, int& highGap, int& lowGap) {
+    isHigh = isLow = false;
+    highGap = lowGap = -1;
+    if (isMissing(value)) {
+        return;
+    }
+
+    if (maxYear == -1) {
+        // First valid value holds both records
+        maxValue = minValue = value;
+        maxYear = minYear = year;
+        isHigh = isLow = true;
+    } else {
+        if (value >= maxValue) {
+            isHigh = true;
+            // The old holder drops to second place unless this is only a tie
+            if (value > maxValue) {
+                secondValue = maxValue;
+                secondYear = maxYear;
+                maxValue = value;
+                maxYear = year;
+            } else if (secondYear == -1 || value > secondValue) {
+                secondValue = value;
+                secondYear = year;
+            }
+        } else if (secondYear == -1 || value > secondValue) {
+            secondValue = value;
+            secondYear = year;
+        }
+
+        if (value <= minValue) {
+            isLow = true;
+            if (value < minValue) {
+                minValue = value;
+                minYear = year;
+            }
+        }
+    }
+
+    if (isHigh) {
+        ++recordCount;
+        if (lastHighYear != -1) highGap = year - lastHighYear;
+        lastHighYear = year;
+    }
+    if (isLow) {
+        ++lowRecordCount;
+        if (lastLowYear != -1) lowGap = year - lastLowYear;
+        lastLowYear = year;
+    }
+}
+
+void computeSeriesRecords(const int* years, const double* values, size_t n, SeriesRecords& records) {
+
+    records = SeriesRecords();
+    records.previousRecord.resize(n);
+    records.previousLowRecord.resize(n);
+    records.secondRecord.resize(n);
+    records.runningMax.resize(n);
+    records.runningMin.resize(n);
+    records.runningSecond.resize(n);
+
+    RecordTracker tracker;
+    bool isHigh, isLow;
+    int highGap, lowGap;
+
+    for (size_t i = 0; i < n; ++i) {
+        const int year = years[i];
+        tracker.update(year, values[i], isHigh, isLow, highGap, lowGap);
+
+        records.previousRecord[i] = isHigh ? year : tracker.maxYear;
+        records.previousLowRecord[i] = isLow ? year : tracker.minYear;
+        records.secondRecord[i] = tracker.secondYear;
+        records.runningMax[i] = tracker.maxValue;
+        records.runningMin[i] = tracker.minValue;
+        records.runningSecond[i] = tracker.secondValue;
+
+        if (highGap >= 0) {
+            records.gapyears.push_back(year - highGap);
+            records.gapsizes.push_back(highGap);
+        }
+        if (lowGap >= 0) {
+            records.lowGapyears.push_back(year - lowGap);
+            records.lowGapsizes.push_back(lowGap);
+        }
+    }
+
+    records.recordCount = tracker.recordCount;
+    records.lowRecordCount = tracker.lowRecordCount;
+}
+
+void computeRecords(const ClimateTable& table, RecordSet& records) {
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        computeSeriesRecords(table.years.data(), table.month(month).data(), table.size(), records.months[month]);
+    }
+}
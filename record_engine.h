@@ -0,0 +1,64 @@
+#ifndef RECORD_ENGINE_H
+#define RECORD_ENGINE_H
+
+#include <vector>
+
+#include "climate_table.h"
+
+// Incremental record holder for one series. It is plain data so it can be
+// embedded in checkpointed state; update() is O(1) per value.
+struct RecordTracker {
+    double maxValue;
+    double minValue;
+    double secondValue;
+    int maxYear = -1;    // earliest year holding the record high
+    int minYear = -1;    // earliest year holding the record low
+    int secondYear = -1; // year holding second place
+    int lastHighYear = -1;
+    int lastLowYear = -1;
+    int recordCount = 0;
+    int lowRecordCount = 0;
+
+    RecordTracker();
+
+    // Function to add the next value of the series. Missing values never set
+    // a record. Sets isHigh/isLow when the value sets or ties a record, and
+    // highGap/lowGap to the years since the previous record (-1 if none).
+    void update(int year, double value, bool& isHigh, bool& isLow, int& highGap, int& lowGap);
+};
+
+// Running record state for one series (one calendar month of a table).
+// Every per-row vector has one entry per input row; -1 marks "no holder yet".
+struct SeriesRecords {
+    std::vector<int> previousRecord;    // year holding the record high as of each row (the row's own year if it sets or ties it)
+    std::vector<int> previousLowRecord; // same for the record low
+    std::vector<int> secondRecord;      // year holding second place behind the record high
+    std::vector<double> runningMax;     // highest value up to and including each row (NaN until the first value)
+    std::vector<double> runningMin;     // lowest value up to and including each row
+    std::vector<double> runningSecond;  // second-highest value up to and including each row
+
+    // Gaps between successive record highs / lows
+    std::vector<int> gapyears;
+    std::vector<int> gapsizes;
+    std::vector<int> lowGapyears;
+    std::vector<int> lowGapsizes;
+
+    int recordCount = 0;    // rows that set or tied the record high
+    int lowRecordCount = 0; // rows that set or tied the record low
+};
+
+// Records for every calendar month of a ClimateTable
+struct RecordSet {
+    SeriesRecords months[MONTHS_PER_YEAR];
+};
+
+// Function to compute running records, second places and record gaps in a
+// single pass over a numeric series. Missing (NaN) rows never set a record;
+// they keep the current holders. Ties count as a new record for the tying
+// year, while the running holder stays the earliest year with that value.
+void computeSeriesRecords(const int* years, const double* values, size_t n, SeriesRecords& records);
+
+// Function to compute records for each of the twelve monthly columns
+void computeRecords(const ClimateTable& table, RecordSet& records);
+
+#endif // RECORD_ENGINE_H
@@ -0,0 +1,204 @@
+#include "regression.h"
+
+#include <algorithm>
+
+#include "distributions.h"
+
+RegressionResult regressionFromMoments(double n, double meanX, double meanY, double sxx, double syy, double sxy,
+                                       double lagProduct) {
+    RegressionResult r;
+    r.n = static_cast<size_t>(n);
+    if (n < 2.0 || !(sxx > 0.0)) {
+        return r;
+    }
+
+    r.slope = sxy / sxx;
+    r.intercept = meanY - r.slope * meanX;
+
+    // Residual sum of squares; clamp the rounding noise of a perfect fit
+    const double sse = std::max(0.0, syy - r.slope * sxy);
+    r.rSquared = syy > 0.0 ? 1.0 - sse / syy : 1.0;
+
+    if (n > 2.0) {
+        r.residualVariance = sse / (n - 2.0);
+        r.slopeStdError = std::sqrt(r.residualVariance / sxx);
+        r.interceptStdError = std::sqrt(r.residualVariance * (1.0 / n + meanX * meanX / sxx));
+    }
+    if (n > 2.0 && sse > 0.0 && !std::isnan(lagProduct)) {
+        r.lag1Autocorrelation = std::min(std::max(lagProduct / sse, -1.0), 1.0);
+        const double rho = std::max(r.lag1Autocorrelation, 0.0);
+        r.effectiveN = n * (1.0 - rho) / (1.0 + rho);
+        if (r.effectiveN > 2.0) {
+            r.adjustedSlopeStdError = std::sqrt(sse / (r.effectiveN - 2.0) / sxx);
+        }
+    }
+    return r;
+}
+
+RegressionTests regressionTests(const RegressionResult& fit) {
+    RegressionTests tests;
+    if (!fit.valid() || std::isnan(fit.slopeStdError)) {
+        return tests;
+    }
+
+    const double df = static_cast<double>(fit.n) - 2.0;
+    tests.slopeT = fit.slope / fit.slopeStdError;
+    tests.interceptT = fit.intercept / fit.interceptStdError;
+    tests.slopePValue = studentTTwoSidedPValue(tests.slopeT, df);
+    tests.interceptPValue = studentTTwoSidedPValue(tests.interceptT, df);
+    if (!std::isnan(fit.adjustedSlopeStdError)) {
+        tests.adjustedSlopeT = fit.slope / fit.adjustedSlopeStdError;
+        tests.adjustedSlopePValue = studentTTwoSidedPValue(tests.adjustedSlopeT, fit.effectiveN - 2.0);
+    }
+    return tests;
+}
+
+void regressionTestsBatch(const RegressionResult* fits, size_t count, RegressionTests* tests) {
+    for (size_t i = 0; i < count; ++i) {
+        tests[i] = regressionTests(fits[i]);
+    }
+}
+
+void RegressionAccumulator::merge(const RegressionAccumulator& other) {
+    if (other.count == 0.0) return;
+    if (count == 0.0) {
+        *this = other;
+        return;
+    }
+
+    // The other's pair sums moved to this origin, plus the pair across the join
+    const double sx = other.originX - originX;
+    const double sy = other.originY - originY;
+    pairYY += other.pairYY + sy * other.pairY + sy * sy * other.pairs;
+    pairXY += other.pairXY + sx * other.pairY + sy * other.pairX + 2.0 * sx * sy * other.pairs;
+    pairXX += other.pairXX + sx * other.pairX + sx * sx * other.pairs;
+    pairY += other.pairY + 2.0 * sy * other.pairs;
+    pairX += other.pairX + 2.0 * sx * other.pairs;
+    pairs += other.pairs;
+    pairYY += linked * sy * lastY;
+    pairY += linked * (sy + lastY);
+    pairXY += linked * (sx * lastY + sy * lastX);
+    pairX += linked * (sx + lastX);
+    pairXX += linked * sx * lastX;
+    pairs += linked;
+    lastX = other.lastX + sx;
+    lastY = other.lastY + sy;
+    linked = other.linked;
+
+    // Chan et al. pairwise update of the co-moments
+    const double total = count + other.count;
+    const double dx = other.meanX - meanX;
+    const double dy = other.meanY - meanY;
+    const double weight = count * other.count / total;
+
+    m2X += other.m2X + dx * dx * weight;
+    m2Y += other.m2Y + dy * dy * weight;
+    cXY += other.cXY + dx * dy * weight;
+    meanX += dx * other.count / total;
+    meanY += dy * other.count / total;
+    count = total;
+}
+
+RegressionResult RegressionAccumulator::result() const {
+    double lagProduct = NAN;
+    if (pairs > 0.0 && m2X > 0.0) {
+        const double slope = cXY / m2X;
+        const double intercept = (meanY - originY) - slope * (meanX - originX);
+        lagProduct = lagResidualProduct(pairs, pairYY, pairY, pairXY, pairX, pairXX, intercept, slope);
+    }
+    return regressionFromMoments(count, meanX, meanY, m2X, m2Y, cXY, lagProduct);
+}
+
+RegressionResult linearRegression(const double* x, const double* y, size_t n) {
+    RegressionAccumulator acc;
+    for (size_t i = 0; i < n; ++i) {
+        if (!std::isnan(y[i])) {
+            acc.add(x[i], y[i]);
+        } else {
+            acc.breakRun();
+        }
+    }
+    return acc.result();
+}
+
+template <typename T>
+void regressBatch(const double* x, size_t n, const T* y, size_t seriesStride, size_t timeStride,
+                  size_t series, RegressionResult* results) {
+    const size_t BLOCK = 8;
+
+    // Center x once for every series; y is shifted per series by its first
+    // valid value, so the sums below stay small and do not cancel
+    double xMean = 0.0;
+    for (size_t i = 0; i < n; ++i) xMean += x[i];
+    xMean = n > 0 ? xMean / n : 0.0;
+
+    for (size_t first = 0; first < series; first += BLOCK) {
+        const size_t lanes = std::min(BLOCK, series - first);
+        const T* base = y + first * seriesStride;
+
+        double shift[BLOCK] = {}, count[BLOCK] = {}, sx[BLOCK] = {}, sy[BLOCK] = {};
+        double sxx[BLOCK] = {}, syy[BLOCK] = {}, sxy[BLOCK] = {};
+        // Consecutive valid pairs, in the same centered x and shifted y
+        double previousW[BLOCK] = {}, previousX[BLOCK] = {}, previousY[BLOCK] = {};
+        double pairs[BLOCK] = {}, pairYY[BLOCK] = {}, pairY[BLOCK] = {}, pairXY[BLOCK] = {};
+        double pairX[BLOCK] = {}, pairXX[BLOCK] = {};
+
+        for (size_t l = 0; l < lanes; ++l) {
+            for (size_t i = 0; i < n; ++i) {
+                const double v = base[l * seriesStride + i * timeStride];
+                if (!std::isnan(v)) {
+                    shift[l] = v;
+                    break;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            const double dx = x[i] - xMean;
+            const T* row = base + i * timeStride;
+            for (size_t l = 0; l < lanes; ++l) {
+                const double v = row[l * seriesStride];
+                const bool valid = v == v;
+                const double w = valid ? 1.0 : 0.0;
+                const double dy = valid ? v - shift[l] : 0.0;
+                count[l] += w;
+                sx[l] += w * dx;
+                sxx[l] += w * dx * dx;
+                sy[l] += dy;
+                syy[l] += dy * dy;
+                sxy[l] += dx * dy;
+
+                const double pair = w * previousW[l];
+                const double px = w * dx;
+                pairs[l] += pair;
+                pairYY[l] += pair * dy * previousY[l];
+                pairY[l] += pair * (dy + previousY[l]);
+                pairXY[l] += pair * (px * previousY[l] + dy * previousX[l]);
+                pairX[l] += pair * (px + previousX[l]);
+                pairXX[l] += pair * px * previousX[l];
+                previousW[l] = w;
+                previousX[l] = px;
+                previousY[l] = dy;
+            }
+        }
+
+        for (size_t l = 0; l < lanes; ++l) {
+            const double c = count[l];
+            const double mx = c > 0.0 ? sx[l] / c : 0.0;
+            const double my = c > 0.0 ? sy[l] / c : 0.0;
+            const double cxx = sxx[l] - sx[l] * mx;
+            const double cxy = sxy[l] - sx[l] * my;
+            double lagProduct = NAN;
+            if (pairs[l] > 0.0 && cxx > 0.0) {
+                const double slope = cxy / cxx;
+                lagProduct = lagResidualProduct(pairs[l], pairYY[l], pairY[l], pairXY[l], pairX[l], pairXX[l],
+                                                my - slope * mx, slope);
+            }
+            results[first + l] = regressionFromMoments(c, mx + xMean, my + shift[l], cxx, syy[l] - sy[l] * my, cxy,
+                                                       lagProduct);
+        }
+    }
+}
+
+template void regressBatch<float>(const double*, size_t, const float*, size_t, size_t, size_t, RegressionResult*);
+template void regressBatch<double>(const double*, size_t, const double*, size_t, size_t, size_t, RegressionResult*);
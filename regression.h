@@ -0,0 +1,161 @@
+#ifndef REGRESSION_H
+#define REGRESSION_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Ordinary least squares fit y = slope * x + intercept with its diagnostics.
+// Everything except n is NaN when the fit is undefined (fewer than two
+// points or no spread in x); the standard errors need at least three points.
+//
+// The AR(1) fields allow for serially correlated residuals, as monthly and
+// annual anomalies have: with r the lag-1 autocorrelation of the residuals
+// (consecutive valid points), n_eff = n (1 - r) / (1 + r) and the slope
+// standard error uses n_eff - 2 degrees of freedom (Santer et al. 2000).
+// A negative r leaves n_eff at n. They are NaN where the fit's source does
+// not track consecutive points.
+struct RegressionResult {
+    size_t n = 0;
+    double slope = NAN;
+    double intercept = NAN;
+    double rSquared = NAN;
+    double slopeStdError = NAN;
+    double interceptStdError = NAN;
+    double residualVariance = NAN; // sum of squared residuals / (n - 2)
+    double lag1Autocorrelation = NAN;
+    double effectiveN = NAN;
+    double adjustedSlopeStdError = NAN; // AR(1)-adjusted slope standard error
+
+    bool valid() const { return !std::isnan(slope); }
+};
+
+// One-pass regression accumulator using Welford-style co-moment updates, so
+// large x values (years) and small y values (anomalies) do not cancel. It is
+// plain data and can be updated one point at a time, checkpointed, or merged
+// across threads.
+//
+// Each point is also paired with the one added before it, and the pairs'
+// sums (relative to the first point, so they stay small) give the lag-1
+// autocorrelation of the residuals without a second pass once the line is
+// known. A gap in the series should end the run of consecutive points.
+struct RegressionAccumulator {
+    double count = 0.0;
+    double meanX = 0.0;
+    double meanY = 0.0;
+    double m2X = 0.0; // sum of squared deviations of x from its mean
+    double m2Y = 0.0;
+    double cXY = 0.0; // sum of co-deviations
+
+    // Consecutive pairs (x', y') (x, y), both relative to the first point
+    double originX = 0.0;
+    double originY = 0.0;
+    double lastX = 0.0;
+    double lastY = 0.0;
+    double linked = 0.0; // 1 when the next point follows the last one
+    double pairs = 0.0;
+    double pairYY = 0.0; // sum of y y'
+    double pairY = 0.0;  // sum of y + y'
+    double pairXY = 0.0; // sum of x y' + y x'
+    double pairX = 0.0;  // sum of x + x'
+    double pairXX = 0.0; // sum of x x'
+
+    void add(double x, double y) {
+        if (count == 0.0) {
+            originX = x;
+            originY = y;
+        }
+        count += 1.0;
+        const double dx = x - meanX;
+        meanX += dx / count;
+        const double dy = y - meanY;
+        meanY += dy / count;
+        m2X += dx * (x - meanX);
+        m2Y += dy * (y - meanY);
+        cXY += dx * (y - meanY);
+
+        const double px = x - originX;
+        const double py = y - originY;
+        pairs += linked;
+        pairYY += linked * py * lastY;
+        pairY += linked * (py + lastY);
+        pairXY += linked * (px * lastY + py * lastX);
+        pairX += linked * (px + lastX);
+        pairXX += linked * px * lastX;
+        lastX = px;
+        lastY = py;
+        linked = 1.0;
+    }
+
+    // Function to end the run of consecutive points, e.g. at a missing value
+    void breakRun() { linked = 0.0; }
+
+    void reset() { *this = RegressionAccumulator(); }
+
+    // Function to combine with an accumulator built over other points; when
+    // this run is not broken, the other's first point follows this one's last
+    void merge(const RegressionAccumulator& other);
+
+    RegressionResult result() const;
+};
+
+// Function to regress y on x over n points; NaN y values are skipped and
+// break the run of consecutive residuals
+RegressionResult linearRegression(const double* x, const double* y, size_t n);
+
+template <typename X, typename Y>
+RegressionResult linearRegression(const std::vector<X>& x, const std::vector<Y>& y) {
+    RegressionAccumulator acc;
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (!std::isnan(static_cast<double>(y[i]))) {
+            acc.add(x[i], y[i]);
+        } else {
+            acc.breakRun();
+        }
+    }
+    return acc.result();
+}
+
+// Function to regress many series against one shared x axis in a single
+// pass. Value i of series s is y[s * seriesStride + i * timeStride], so both
+// series-major and time-major layouts work (e.g. seriesStride 1 and
+// timeStride 12 regresses every calendar month of a monthly series at once).
+// NaN values are skipped per series. Series are processed in blocks whose
+// accumulators sit side by side, so the inner loop vectorizes across series;
+// the lag-1 sums of the AR(1) fields ride in the same pass.
+template <typename T>
+void regressBatch(const double* x, size_t n, const T* y, size_t seriesStride, size_t timeStride,
+                  size_t series, RegressionResult* results);
+
+// t statistics and two-sided p-values of a fit's coefficients against zero,
+// with n - 2 degrees of freedom as statsmodels' OLS reports them
+struct RegressionTests {
+    double slopeT = NAN;
+    double interceptT = NAN;
+    double slopePValue = NAN;
+    double interceptPValue = NAN;
+    double adjustedSlopeT = NAN;      // slope over its AR(1)-adjusted standard error
+    double adjustedSlopePValue = NAN; // with effectiveN - 2 degrees of freedom
+};
+
+// Function to test the coefficients of one fit
+RegressionTests regressionTests(const RegressionResult& fit);
+
+// Function to test many fits, e.g. the output of regressBatch
+void regressionTestsBatch(const RegressionResult* fits, size_t count, RegressionTests* tests);
+
+// Function to finish a fit from its centered sums; lagProduct, the sum of
+// products of consecutive residuals, fills the AR(1) fields when given
+RegressionResult regressionFromMoments(double n, double meanX, double meanY, double sxx, double syy, double sxy,
+                                       double lagProduct = NAN);
+
+// Function to return the sum of products of consecutive residuals
+// y - (intercept + slope x) from the pair sums of RegressionAccumulator, in
+// the coordinates the sums were taken in
+inline double lagResidualProduct(double pairs, double pairYY, double pairY, double pairXY, double pairX,
+                                 double pairXX, double intercept, double slope) {
+    return pairYY - intercept * pairY - slope * pairXY + intercept * intercept * pairs +
+           intercept * slope * pairX + slope * slope * pairXX;
+}
+
+#endif // REGRESSION_H
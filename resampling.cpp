@@ -0,0 +1,266 @@
+#include "resampling.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "counter_rng.h"
+#include "record_engine.h"
+#include "regression.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Resamples handed to one task when a single series is split across threads
+const size_t REPLICATE_GRAIN = 256;
+
+// The (x, y) pairs of one series without its NaN values, and prefix sums of
+// the centered x, y, x^2 and xy, so the sums over any block take O(1)
+struct CenteredSeries {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> prefix; // 4 sums per position, m + 1 positions
+    RegressionResult fit;
+};
+
+// Buffers reused from one series to the next
+struct BootstrapWorkspace {
+    CenteredSeries series;
+    std::vector<double> slopes;
+};
+
+thread_local BootstrapWorkspace workspace;
+
+template <typename T>
+void centerSeries(const double* x, const T* y, size_t n, size_t stride, CenteredSeries& series) {
+    series.x.clear();
+    series.y.clear();
+    RegressionAccumulator acc;
+    for (size_t i = 0; i < n; ++i) {
+        const double v = y[i * stride];
+        if (!std::isnan(v)) {
+            series.x.push_back(x[i]);
+            series.y.push_back(v);
+            acc.add(x[i], v);
+        }
+    }
+    series.fit = acc.result();
+
+    const size_t m = series.x.size();
+    series.prefix.assign(4 * (m + 1), 0.0);
+    double* p = series.prefix.data();
+    for (size_t i = 0; i < m; ++i, p += 4) {
+        const double xc = series.x[i] - acc.meanX;
+        const double yc = series.y[i] - acc.meanY;
+        p[4] = p[0] + xc;
+        p[5] = p[1] + yc;
+        p[6] = p[2] + xc * xc;
+        p[7] = p[3] + xc * yc;
+    }
+}
+
+size_t blockLengthFor(size_t m, const ResamplingOptions& options) {
+    size_t block = options.blockLength;
+    if (block == 0) {
+        block = static_cast<size_t>(std::lround(std::cbrt(static_cast<double>(m))));
+    }
+    return std::max<size_t>(1, std::min(block, m));
+}
+
+// Function to compute the slopes of resamples [first, last): each resample
+// concatenates blocks that start at uniform positions and wrap around the end
+// (the circular block bootstrap), until it holds m points
+void bootstrapReplicates(const CenteredSeries& series, size_t block, const ResamplingOptions& options,
+                         std::uint64_t stream, size_t first, size_t last, double* slopes) {
+    const double* p = series.prefix.data();
+    const size_t m = series.x.size();
+    const std::uint32_t bound = static_cast<std::uint32_t>(m);
+
+    for (size_t r = first; r < last; ++r) {
+        CounterRng rng(options.seed, stream, static_cast<std::uint32_t>(r));
+        double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+        for (size_t taken = 0; taken < m; taken += block) {
+            const size_t start = rng.below(bound);
+            const size_t end = start + std::min(block, m - taken);
+            // [start, end) or, past the last point, [start, m) and [0, end - m)
+            const double* a = p + 4 * start;
+            const double* b = p + 4 * std::min(end, m);
+            sx += b[0] - a[0];
+            sy += b[1] - a[1];
+            sxx += b[2] - a[2];
+            sxy += b[3] - a[3];
+            if (end > m) {
+                const double* c = p + 4 * (end - m);
+                sx += c[0];
+                sy += c[1];
+                sxx += c[2];
+                sxy += c[3];
+            }
+        }
+        const double sxxCentered = sxx - sx * sx / m;
+        slopes[r] = sxxCentered > 0.0 ? (sxy - sx * sy / m) / sxxCentered : NAN;
+    }
+}
+
+// Linear interpolation between order statistics of sorted values
+double quantile(const std::vector<double>& sorted, double p) {
+    const double position = p * (sorted.size() - 1);
+    const size_t below = static_cast<size_t>(position);
+    if (below + 1 >= sorted.size()) return sorted.back();
+    return sorted[below] + (position - below) * (sorted[below + 1] - sorted[below]);
+}
+
+// Function to turn the resampled slopes into an interval; reorders slopes
+SlopeInterval summarizeSlopes(const RegressionResult& fit, std::vector<double>& slopes, double confidence) {
+    SlopeInterval interval;
+    interval.slope = fit.slope;
+    slopes.erase(std::remove_if(slopes.begin(), slopes.end(), [](double s) { return std::isnan(s); }), slopes.end());
+    if (!fit.valid() || slopes.size() < 2) {
+        return interval;
+    }
+
+    std::sort(slopes.begin(), slopes.end());
+    const double tail = (1.0 - confidence) / 2.0;
+    interval.lower = quantile(slopes, tail);
+    interval.upper = quantile(slopes, 1.0 - tail);
+    interval.replicates = slopes.size();
+
+    double mean = 0.0;
+    for (double s : slopes) mean += s;
+    mean /= slopes.size();
+    double squares = 0.0;
+    for (double s : slopes) squares += (s - mean) * (s - mean);
+    interval.standardError = std::sqrt(squares / (slopes.size() - 1));
+    return interval;
+}
+
+// Function to count the records of a series and regress its gaps, as the
+// record engine does
+void recordStatistics(const int* years, const double* values, size_t m, int& records, double& gapSlope) {
+    RecordTracker tracker;
+    RegressionAccumulator gaps;
+    bool isHigh, isLow;
+    int highGap, lowGap;
+    for (size_t i = 0; i < m; ++i) {
+        tracker.update(years[i], values[i], isHigh, isLow, highGap, lowGap);
+        if (highGap >= 0) gaps.add(years[i] - highGap, highGap);
+    }
+    records = tracker.recordCount;
+    gapSlope = gaps.result().slope;
+}
+
+} // namespace
+
+double expectedRecordCount(size_t n) {
+    double sum = 0.0;
+    for (size_t k = n; k >= 1; --k) sum += 1.0 / k; // smallest terms first
+    return sum;
+}
+
+SlopeInterval bootstrapSlope(const double* x, const double* y, size_t n, const ResamplingOptions& options,
+                             std::uint64_t stream, ThreadPool* pool) {
+    if (!pool || options.replicates < 2 * REPLICATE_GRAIN) {
+        SlopeInterval result;
+        bootstrapSlopeBatch(x, n, y, 0, 1, 1, options, stream, nullptr, &result);
+        return result;
+    }
+
+    CenteredSeries series;
+    centerSeries(x, y, n, 1, series);
+    if (!series.fit.valid()) {
+        return SlopeInterval();
+    }
+
+    const size_t block = blockLengthFor(series.x.size(), options);
+    std::vector<double> slopes(options.replicates);
+    pool->parallelFor(0, options.replicates, REPLICATE_GRAIN, [&](size_t first, size_t last) {
+        bootstrapReplicates(series, block, options, stream, first, last, slopes.data());
+    });
+    return summarizeSlopes(series.fit, slopes, options.confidence);
+}
+
+template <typename T>
+void bootstrapSlopeBatch(const double* x, size_t n, const T* y, size_t seriesStride, size_t timeStride,
+                         size_t series, const ResamplingOptions& options, std::uint64_t firstStream,
+                         ThreadPool* pool, SlopeInterval* results) {
+    auto run = [&](size_t first, size_t last) {
+        BootstrapWorkspace& ws = workspace;
+        for (size_t s = first; s < last; ++s) {
+            centerSeries(x, y + s * seriesStride, n, timeStride, ws.series);
+            if (!ws.series.fit.valid()) {
+                results[s] = SlopeInterval();
+                continue;
+            }
+            ws.slopes.resize(options.replicates);
+            bootstrapReplicates(ws.series, blockLengthFor(ws.series.x.size(), options), options, firstStream + s, 0,
+                                options.replicates, ws.slopes.data());
+            results[s] = summarizeSlopes(ws.series.fit, ws.slopes, options.confidence);
+        }
+    };
+
+    if (pool) {
+        pool->parallelFor(0, series, 1, run);
+    } else {
+        run(0, series);
+    }
+}
+
+template void bootstrapSlopeBatch<float>(const double*, size_t, const float*, size_t, size_t, size_t,
+                                         const ResamplingOptions&, std::uint64_t, ThreadPool*, SlopeInterval*);
+template void bootstrapSlopeBatch<double>(const double*, size_t, const double*, size_t, size_t, size_t,
+                                          const ResamplingOptions&, std::uint64_t, ThreadPool*, SlopeInterval*);
+
+RecordSignificance permutationRecordTest(const int* years, const double* values, size_t n,
+                                         const ResamplingOptions& options, std::uint64_t stream, ThreadPool* pool) {
+    RecordSignificance result;
+    std::vector<int> validYears;
+    std::vector<double> validValues;
+    for (size_t i = 0; i < n; ++i) {
+        if (!isMissing(values[i])) {
+            validYears.push_back(years[i]);
+            validValues.push_back(values[i]);
+        }
+    }
+    const size_t m = validValues.size();
+    recordStatistics(validYears.data(), validValues.data(), m, result.records, result.gapSlope);
+    if (m < 2 || options.replicates == 0) {
+        return result;
+    }
+    result.expectedRecords = expectedRecordCount(m);
+
+    // Statistics of every permutation, kept by index so the p-values do not
+    // depend on how the permutations were split across threads
+    std::vector<int> records(options.replicates);
+    std::vector<double> gapSlopes(options.replicates);
+    auto run = [&](size_t first, size_t last) {
+        thread_local std::vector<double> shuffled;
+        for (size_t r = first; r < last; ++r) {
+            CounterRng rng(options.seed, stream, static_cast<std::uint32_t>(r));
+            shuffled.assign(validValues.begin(), validValues.end());
+            for (size_t i = m - 1; i > 0; --i) {
+                std::swap(shuffled[i], shuffled[rng.below(static_cast<std::uint32_t>(i + 1))]);
+            }
+            recordStatistics(validYears.data(), shuffled.data(), m, records[r], gapSlopes[r]);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(0, options.replicates, REPLICATE_GRAIN, run);
+    } else {
+        run(0, options.replicates);
+    }
+
+    // A permuted slope only counts as more extreme beyond rounding noise of the observed one
+    const double observedDistance = std::fabs(result.gapSlope) * (1.0 - 1e-12);
+    size_t moreRecords = 0, moreExtremeSlopes = 0;
+    for (size_t r = 0; r < options.replicates; ++r) {
+        if (records[r] >= result.records) ++moreRecords;
+        if (!std::isnan(gapSlopes[r]) && std::fabs(gapSlopes[r]) >= observedDistance) ++moreExtremeSlopes;
+    }
+
+    const double denominator = static_cast<double>(options.replicates) + 1.0;
+    result.permutations = options.replicates;
+    result.recordsPValue = (moreRecords + 1.0) / denominator;
+    if (!std::isnan(result.gapSlope)) {
+        result.gapSlopePValue = (moreExtremeSlopes + 1.0) / denominator;
+    }
+    return result;
+}
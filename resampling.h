@@ -0,0 +1,71 @@
+#ifndef RESAMPLING_H
+#define RESAMPLING_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+// Settings shared by the bootstrap and permutation tests. Resample r of the
+// series with stream number s always draws the same random numbers (see
+// CounterRng), so results are reproducible for any number of threads.
+struct ResamplingOptions {
+    size_t replicates = 10000;  // bootstrap resamples or permutations per series
+    size_t blockLength = 0;     // bootstrap block length; 0: round(n^(1/3)), at least 1
+    double confidence = 0.95;   // coverage of bootstrap intervals
+    std::uint64_t seed = 1880;
+};
+
+// Least squares slope with a circular block-bootstrap percentile interval.
+// Everything is NaN when the slope itself is undefined.
+struct SlopeInterval {
+    double slope = NAN;
+    double lower = NAN;
+    double upper = NAN;
+    double standardError = NAN; // standard deviation of the bootstrap slopes
+    size_t replicates = 0;      // resamples with a defined slope
+
+    bool valid() const { return !std::isnan(lower); }
+};
+
+// Function to bootstrap the slope of y on x over n points, skipping NaN y
+// values. Resampling whole blocks of consecutive (x, y) pairs keeps the
+// serial correlation of the residuals, which an i.i.d. bootstrap would
+// destroy and so understate the spread. With a pool the resamples of this
+// one series are split across threads.
+SlopeInterval bootstrapSlope(const double* x, const double* y, size_t n, const ResamplingOptions& options,
+                             std::uint64_t stream = 0, ThreadPool* pool = nullptr);
+
+// Function to bootstrap many series against one shared x axis, laid out as in
+// regressBatch; series s uses stream firstStream + s. Series are spread
+// across the pool, each resampled on one thread with per-thread buffers.
+template <typename T>
+void bootstrapSlopeBatch(const double* x, size_t n, const T* y, size_t seriesStride, size_t timeStride,
+                         size_t series, const ResamplingOptions& options, std::uint64_t firstStream,
+                         ThreadPool* pool, SlopeInterval* results);
+
+// Record highs of a series against a stationary null. If the values are
+// exchangeable, the k-th valid value sets a record with probability 1/k, so
+// n values set H(n) = 1 + 1/2 + ... + 1/n records on average and the gaps
+// between records show no trend. The permutation p-values shuffle the values
+// over the same years; ties count as records, as in RecordTracker.
+struct RecordSignificance {
+    int records = 0;                // observed records (including the first value)
+    double expectedRecords = NAN;   // H(n) for n valid values
+    double recordsPValue = NAN;     // one-sided: permutations with at least as many records
+    double gapSlope = NAN;          // slope of gap size on gap start year
+    double gapSlopePValue = NAN;    // two-sided: permutations with a slope at least as far from 0
+    size_t permutations = 0;
+};
+
+// Function to test the records of one series
+RecordSignificance permutationRecordTest(const int* years, const double* values, size_t n,
+                                         const ResamplingOptions& options, std::uint64_t stream = 0,
+                                         ThreadPool* pool = nullptr);
+
+// Function to return the harmonic number H(n), the expected record count of n
+// exchangeable values without ties
+double expectedRecordCount(size_t n);
+
+#endif // RESAMPLING_H
@@ -0,0 +1,516 @@
+#include "robust_trend.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+#include "counter_rng.h"
+#include "distributions.h"
+#include "thread_pool.h"
+
+namespace {
+
+// Seed of the draws that narrow a slope selection; each rank has its own stream
+const std::uint64_t SELECTION_SEED = 1968;
+// Rounds of narrowing after which the remaining pairs are listed whatever their number
+const int MAX_ROUNDS = 64;
+// Series with at most this many pairs list them all: below a few hundred
+// points that is faster than narrowing
+const std::uint64_t ALL_PAIRS_LIMIT = 1 << 15;
+
+// Function to sort items stably by before(a, b) with a bottom-up merge sort
+// and return the number of inversions, the pairs the sort puts the other
+// way round. Each item that moves ahead of left items is passed to
+// visit(firstLeft, lastLeft, item) with the items it passes.
+template <typename Item, typename Before, typename Visit>
+std::uint64_t mergeSortCounting(std::vector<Item>& items, std::vector<Item>& buffer, Before before, Visit visit) {
+    const size_t n = items.size();
+    buffer.resize(n);
+    std::uint64_t inversions = 0;
+    for (size_t width = 1; width < n; width *= 2) {
+        for (size_t start = 0; start < n; start += 2 * width) {
+            const size_t middle = std::min(start + width, n);
+            const size_t end = std::min(start + 2 * width, n);
+            size_t i = start, j = middle, k = start;
+            while (i < middle && j < end) {
+                if (before(items[j], items[i])) {
+                    visit(&items[i], &items[middle], items[j]);
+                    inversions += middle - i;
+                    buffer[k++] = items[j++];
+                } else {
+                    buffer[k++] = items[i++];
+                }
+            }
+            while (i < middle) buffer[k++] = items[i++];
+            while (j < end) buffer[k++] = items[j++];
+        }
+        items.swap(buffer);
+    }
+    return inversions;
+}
+
+template <typename Item, typename Before>
+std::uint64_t mergeSortCounting(std::vector<Item>& items, std::vector<Item>& buffer, Before before) {
+    return mergeSortCounting(items, buffer, before, [](const Item*, const Item*, const Item&) {});
+}
+
+// Counts of values inserted at positions 0..n-1, with prefix counts and
+// the position of the k-th inserted value in O(log n)
+class Fenwick {
+public:
+    void reset(size_t n) {
+        tree_.assign(n + 1, 0);
+        top_ = 1;
+        while (top_ * 2 <= n) top_ *= 2;
+    }
+
+    void insert(size_t position) {
+        for (size_t i = position + 1; i < tree_.size(); i += i & (~i + 1)) ++tree_[i];
+    }
+
+    // Function to return how many inserted values are below position
+    std::uint32_t countBelow(size_t position) const {
+        std::uint32_t count = 0;
+        for (size_t i = position; i > 0; i -= i & (~i + 1)) count += tree_[i];
+        return count;
+    }
+
+    // Function to return the position of the rank-th smallest inserted value (rank from 1)
+    size_t find(std::uint32_t rank) const {
+        size_t position = 0;
+        for (size_t step = top_; step > 0; step /= 2) {
+            if (position + step < tree_.size() && tree_[position + step] < rank) {
+                position += step;
+                rank -= tree_[position];
+            }
+        }
+        return position;
+    }
+
+private:
+    std::vector<std::uint32_t> tree_;
+    size_t top_ = 1;
+};
+
+// A threshold on the pairwise slopes: below it are the pairs with slope < t,
+// or slope <= t when inclusive
+struct SlopeCut {
+    double t;
+    bool inclusive;
+};
+
+// Selection of pairwise slopes by rank among points sorted by (x, y).
+//
+// For x_i < x_j the slope of (i, j) is below t exactly when
+// y_j - t x_j < y_i - t x_i, so sorting the points by r = y - t x (ties
+// kept in x order) turns the pairs below t into the inversions of that
+// order. Points with equal x keep their order for every t, as they should.
+// Between two thresholds lie the pairs whose order differs between the two
+// sorts, which can be listed in time proportional to their number, or drawn
+// uniformly with a Fenwick tree.
+class SlopeSelector {
+    struct Residual {
+        double r; // y - t x
+        std::uint32_t point;
+    };
+
+public:
+    void build(const double* x, const double* y, size_t n) {
+        x_ = x;
+        y_ = y;
+        n_ = n;
+
+        // Sorted by x descending, ties still by y: the order as t -> infinity
+        top_.clear();
+        pairs_ = static_cast<std::uint64_t>(n) * (n - 1) / 2;
+        for (size_t end = n; end > 0;) {
+            size_t begin = end - 1;
+            while (begin > 0 && x_[begin - 1] == x_[end - 1]) --begin;
+            const std::uint64_t ties = end - begin;
+            pairs_ -= ties * (ties - 1) / 2;
+            for (size_t i = begin; i < end; ++i) top_.push_back(static_cast<std::uint32_t>(i));
+            end = begin;
+        }
+    }
+
+    // Pairs with distinct x, i.e. the number of slopes
+    std::uint64_t pairs() const { return pairs_; }
+
+    // Function to set slopes[i] to the slope of rank ranks[i] (from 0, in
+    // ascending order) for count ranks. Ranks within n of each other are
+    // selected together; a series with few pairs lists them all once.
+    void select(const std::uint64_t* ranks, size_t count, double* slopes) {
+        wanted_.resize(count);
+        for (size_t i = 0; i < count; ++i) wanted_[i] = {ranks[i], i};
+        std::sort(wanted_.begin(), wanted_.end());
+        sortedRanks_.resize(count);
+        picked_.resize(count);
+        for (size_t i = 0; i < count; ++i) sortedRanks_[i] = wanted_[i].first;
+
+        if (pairs_ <= ALL_PAIRS_LIMIT) {
+            orderAt(lowest(), lower_);
+            orderAt(highest(), upper_);
+            listBetween();
+            pickRanks(sortedRanks_.data(), count, 0, picked_.data());
+        } else {
+            for (size_t first = 0, last = 0; first < count; first = last) {
+                while (last < count && sortedRanks_[last] - sortedRanks_[first] <= n_) ++last;
+                selectGroup(sortedRanks_.data() + first, last - first, picked_.data() + first);
+            }
+        }
+        for (size_t i = 0; i < count; ++i) slopes[wanted_[i].second] = picked_[i];
+    }
+
+private:
+    static SlopeCut lowest() { return {-std::numeric_limits<double>::infinity(), false}; }
+    static SlopeCut highest() { return {std::numeric_limits<double>::infinity(), true}; }
+
+    // Function to select ranks close together: narrow two cuts around them
+    // until few enough pairs lie between to list
+    void selectGroup(const std::uint64_t* ranks, size_t count, double* slopes) {
+        const std::uint64_t first = ranks[0], last = ranks[count - 1];
+        CounterRng rng(SELECTION_SEED, first, 0);
+        SlopeCut lo = lowest(), hi = highest();
+        std::uint64_t below = orderAt(lo, lower_);
+        std::uint64_t above = orderAt(hi, upper_);
+        const size_t listLimit = std::max<size_t>(16 * n_, 1024) + (last - first);
+
+        for (int round = 0;; ++round) {
+            // Only the pairs of slope exactly t lie between t and t inclusive
+            if (lo.t == hi.t) {
+                std::fill(slopes, slopes + count, lo.t);
+                return;
+            }
+
+            if (above - below <= listLimit || round == MAX_ROUNDS) {
+                listBetween();
+                if (slopes_.empty()) {
+                    std::fill(slopes, slopes + count, lo.t);
+                    return;
+                }
+                pickRanks(ranks, count, below, slopes);
+                return;
+            }
+
+            // The sample's order statistics around the ranks' expected places
+            // bracket them with high probability; a miss still narrows one side
+            const size_t draws = n_;
+            const std::uint64_t between = drawBetween(draws, rng);
+            if (between == 0) {
+                listBetween();
+                pickRanks(ranks, count, below, slopes);
+                return;
+            }
+            std::sort(slopes_.begin(), slopes_.end());
+            const double scale = draws / static_cast<double>(between);
+            const double spread = 2.0 * std::sqrt(static_cast<double>(draws));
+            const double lowIndex = std::floor((first - below + 0.5) * scale - spread);
+            const double highIndex = std::ceil((last - below + 0.5) * scale + spread);
+            if (lowIndex >= 0.0) {
+                narrow({slopes_[static_cast<size_t>(lowIndex)], false}, first, last, lo, hi, below, above);
+            }
+            if (highIndex < draws) {
+                narrow({slopes_[static_cast<size_t>(highIndex)], true}, first, last, lo, hi, below, above);
+            }
+        }
+    }
+
+    // Function to pick ascending ranks from the listed slopes, the first of
+    // which has rank offset
+    void pickRanks(const std::uint64_t* ranks, size_t count, std::uint64_t offset, double* slopes) {
+        if (slopes_.empty()) {
+            std::fill(slopes, slopes + count, NAN);
+            return;
+        }
+        auto begin = slopes_.begin();
+        for (size_t i = 0; i < count; ++i) {
+            const size_t rank = std::min<size_t>(ranks[i] - offset, slopes_.size() - 1);
+            auto nth = slopes_.begin() + rank;
+            if (nth >= begin) {
+                std::nth_element(begin, nth, slopes_.end());
+                begin = nth + 1;
+            }
+            slopes[i] = *nth;
+        }
+    }
+
+    // Function to sort the points by their order at cut and return the
+    // number of slopes below it
+    std::uint64_t orderAt(const SlopeCut& cut, std::vector<std::uint32_t>& order) {
+        if (std::isinf(cut.t)) {
+            if (cut.t > 0.0) {
+                order = top_;
+                return pairs_;
+            }
+            order.resize(n_);
+            std::iota(order.begin(), order.end(), 0u);
+            return 0;
+        }
+
+        // Sorted as (r, point) items so the merges compare contiguous keys.
+        // Equal r: an inclusive cut is the order just above t, where the
+        // larger x comes first; otherwise the x order stands
+        keyed_.resize(n_);
+        for (size_t i = 0; i < n_; ++i) keyed_[i] = {y_[i] - cut.t * x_[i], static_cast<std::uint32_t>(i)};
+        std::uint64_t count;
+        if (cut.inclusive) {
+            const double* x = x_;
+            count = mergeSortCounting(keyed_, keyedBuffer_, [x](const Residual& a, const Residual& b) {
+                return a.r < b.r || (a.r == b.r && x[a.point] > x[b.point]);
+            });
+        } else {
+            count = mergeSortCounting(keyed_, keyedBuffer_,
+                                      [](const Residual& a, const Residual& b) { return a.r < b.r; });
+        }
+        order.resize(n_);
+        for (size_t i = 0; i < n_; ++i) order[i] = keyed_[i].point;
+        return count;
+    }
+
+    // Function to move a bound to cut when all the ranks stay between the bounds
+    void narrow(const SlopeCut& cut, std::uint64_t first, std::uint64_t last, SlopeCut& lo, SlopeCut& hi,
+                std::uint64_t& below, std::uint64_t& above) {
+        const std::uint64_t count = orderAt(cut, candidate_);
+        if (count <= first && count >= below) {
+            lo = cut;
+            below = count;
+            lower_.swap(candidate_);
+        } else if (count > last && count <= above) {
+            hi = cut;
+            above = count;
+            upper_.swap(candidate_);
+        }
+    }
+
+    double slope(std::uint32_t a, std::uint32_t b) const { return (y_[b] - y_[a]) / (x_[b] - x_[a]); }
+
+    // Function to set the upper order's position of every point
+    void rankUpper() {
+        upperPosition_.resize(n_);
+        for (size_t p = 0; p < n_; ++p) upperPosition_[upper_[p]] = static_cast<std::uint32_t>(p);
+    }
+
+    // Function to list the slopes between the bounds: the pairs of the
+    // lower order that the upper order inverts
+    void listBetween() {
+        rankUpper();
+        slopes_.clear();
+        items_ = lower_;
+        const std::uint32_t* position = upperPosition_.data();
+        mergeSortCounting(
+            items_, buffer_, [position](std::uint32_t a, std::uint32_t b) { return position[a] < position[b]; },
+            [this](const std::uint32_t* first, const std::uint32_t* last, std::uint32_t b) {
+                for (const std::uint32_t* a = first; a < last; ++a) slopes_.push_back(slope(*a, b));
+            });
+    }
+
+    // Function to draw count slopes uniformly, with replacement, from those
+    // between the bounds; returns how many there are
+    std::uint64_t drawBetween(size_t count, CounterRng& rng) {
+        rankUpper();
+        // Point k of the lower order is inverted with the earlier points
+        // of higher upper position: inverted_[k] of them, after start_[k]
+        fenwick_.reset(n_);
+        inverted_.resize(n_);
+        start_.resize(n_);
+        std::uint64_t total = 0;
+        for (size_t k = 0; k < n_; ++k) {
+            const size_t position = upperPosition_[lower_[k]];
+            inverted_[k] = static_cast<std::uint32_t>(k - fenwick_.countBelow(position));
+            start_[k] = total;
+            total += inverted_[k];
+            fenwick_.insert(position);
+        }
+        slopes_.clear();
+        if (total == 0) {
+            return 0;
+        }
+
+        draws_.resize(count);
+        for (std::uint64_t& draw : draws_) {
+            const std::uint64_t bits = (static_cast<std::uint64_t>(rng.next()) << 32) | rng.next();
+            draw = bits % total;
+        }
+        std::sort(draws_.begin(), draws_.end());
+
+        // The w-th inverted partner of point k is the w-th smallest upper
+        // position above its own among the points before it
+        fenwick_.reset(n_);
+        size_t next = 0;
+        for (size_t k = 0; k < n_ && next < count; ++k) {
+            const size_t position = upperPosition_[lower_[k]];
+            const std::uint32_t lower = fenwick_.countBelow(position);
+            for (; next < count && draws_[next] < start_[k] + inverted_[k]; ++next) {
+                const std::uint32_t w = static_cast<std::uint32_t>(draws_[next] - start_[k]);
+                const size_t partner = fenwick_.find(lower + w + 1);
+                slopes_.push_back(slope(upper_[partner], lower_[k]));
+            }
+            fenwick_.insert(position);
+        }
+        return total;
+    }
+
+    const double* x_ = nullptr;
+    const double* y_ = nullptr;
+    size_t n_ = 0;
+    std::uint64_t pairs_ = 0;
+    std::vector<std::uint32_t> top_;
+    std::vector<std::uint32_t> lower_, upper_, candidate_; // point indices in the order at each cut
+    std::vector<std::uint32_t> items_, buffer_, upperPosition_, inverted_;
+    std::vector<std::uint64_t> start_, draws_;
+    std::vector<Residual> keyed_, keyedBuffer_;
+    std::vector<double> slopes_, picked_;
+    std::vector<std::pair<std::uint64_t, size_t>> wanted_;
+    std::vector<std::uint64_t> sortedRanks_;
+    Fenwick fenwick_;
+};
+
+// Function to add the tie terms of a run of t equal values
+void addTies(double t, double& pairs, double& variance, double& twice, double& thrice) {
+    pairs += t * (t - 1.0) / 2.0;
+    variance += t * (t - 1.0) * (2.0 * t + 5.0);
+    twice += t * (t - 1.0);
+    thrice += t * (t - 1.0) * (t - 2.0);
+}
+
+// Function to compute Kendall's S, tau-b and the tie-corrected variance of
+// S from points sorted by (x, y): the discordant pairs are the inversions
+// of y, and the pairs tied in x, in y and in both come from runs
+void kendallTest(const double* x, const double* y, size_t n, RobustTrend& result) {
+    const double total = static_cast<double>(n) * (n - 1) / 2.0;
+    double xPairs = 0.0, xVariance = 0.0, xTwice = 0.0, xThrice = 0.0;
+    double jointPairs = 0.0;
+    for (size_t begin = 0, end = 0; begin < n; begin = end) {
+        while (end < n && x[end] == x[begin]) ++end;
+        addTies(static_cast<double>(end - begin), xPairs, xVariance, xTwice, xThrice);
+        for (size_t run = begin, stop = begin; run < end; run = stop) {
+            while (stop < end && y[stop] == y[run]) ++stop;
+            const double t = static_cast<double>(stop - run);
+            jointPairs += t * (t - 1.0) / 2.0;
+        }
+    }
+
+    thread_local std::vector<double> sorted, buffer;
+    sorted.assign(y, y + n);
+    const std::uint64_t discordant = mergeSortCounting(sorted, buffer, [](double a, double b) { return a < b; });
+    double yPairs = 0.0, yVariance = 0.0, yTwice = 0.0, yThrice = 0.0;
+    for (size_t begin = 0, end = 0; begin < n; begin = end) {
+        while (end < n && sorted[end] == sorted[begin]) ++end;
+        addTies(static_cast<double>(end - begin), yPairs, yVariance, yTwice, yThrice);
+    }
+
+    const double nn = static_cast<double>(n);
+    const double s = total - xPairs - yPairs + jointPairs - 2.0 * static_cast<double>(discordant);
+    double variance = (nn * (nn - 1.0) * (2.0 * nn + 5.0) - xVariance - yVariance) / 18.0 +
+                      xTwice * yTwice / (2.0 * nn * (nn - 1.0));
+    if (n > 2) variance += xThrice * yThrice / (9.0 * nn * (nn - 1.0) * (nn - 2.0));
+
+    result.kendallS = s;
+    result.kendallTau = s / std::sqrt((total - xPairs) * (total - yPairs));
+    result.varianceS = variance;
+    if (variance > 0.0) {
+        const double corrected = s > 0.0 ? s - 1.0 : (s < 0.0 ? s + 1.0 : 0.0);
+        result.z = corrected / std::sqrt(variance);
+        result.pValue = 2.0 * normalCdf(-std::fabs(result.z));
+    }
+}
+
+// Function to return the median of values, reordering them
+double median(std::vector<double>& values) {
+    const size_t middle = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + middle, values.end());
+    const double upper = values[middle];
+    if (values.size() % 2 == 1) {
+        return upper;
+    }
+    return 0.5 * (*std::max_element(values.begin(), values.begin() + middle) + upper);
+}
+
+} // namespace
+
+template <typename T>
+RobustTrend theilSen(const double* x, const T* y, size_t n, size_t stride, double confidence) {
+    RobustTrend result;
+
+    // Valid points sorted by (x, y)
+    thread_local std::vector<std::uint32_t> index;
+    thread_local std::vector<double> sortedX, sortedY, scratch;
+    index.clear();
+    for (size_t i = 0; i < n; ++i) {
+        if (!std::isnan(x[i]) && !std::isnan(static_cast<double>(y[i * stride]))) {
+            index.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    std::sort(index.begin(), index.end(), [&](std::uint32_t a, std::uint32_t b) {
+        const double ya = y[a * stride], yb = y[b * stride];
+        return x[a] < x[b] || (x[a] == x[b] && ya < yb);
+    });
+    const size_t valid = index.size();
+    sortedX.resize(valid);
+    sortedY.resize(valid);
+    for (size_t i = 0; i < valid; ++i) {
+        sortedX[i] = x[index[i]];
+        sortedY[i] = y[index[i] * stride];
+    }
+    result.n = valid;
+
+    thread_local SlopeSelector selector;
+    selector.build(sortedX.data(), sortedY.data(), valid);
+    const std::uint64_t pairs = selector.pairs();
+    if (pairs == 0) {
+        return result;
+    }
+
+    kendallTest(sortedX.data(), sortedY.data(), valid, result);
+
+    // The two middle slopes, and the bounds of the interval: the slopes of
+    // ranks (N - z sqrt(var S)) / 2 and (N + z sqrt(var S)) / 2 + 1 counted
+    // from 1, all selected at once
+    const double halfWidth = normalQuantile(0.5 + 0.5 * confidence) * std::sqrt(result.varianceS);
+    const double last = static_cast<double>(pairs - 1);
+    std::uint64_t ranks[4] = {(pairs - 1) / 2, pairs / 2, 0, 0};
+    size_t count = 2;
+    if (!std::isnan(halfWidth)) {
+        ranks[count++] = static_cast<std::uint64_t>(
+            std::min(std::max(std::nearbyint((pairs - halfWidth) / 2.0) - 1.0, 0.0), last));
+        ranks[count++] = static_cast<std::uint64_t>(
+            std::min(std::max(std::nearbyint((pairs + halfWidth) / 2.0), 0.0), last));
+    }
+    double slopes[4];
+    selector.select(ranks, count, slopes);
+    result.slope = 0.5 * (slopes[0] + slopes[1]);
+    if (count == 4) {
+        result.slopeLower = slopes[2];
+        result.slopeUpper = slopes[3];
+    }
+
+    scratch = sortedY;
+    const double medianY = median(scratch);
+    scratch = sortedX;
+    result.intercept = medianY - result.slope * median(scratch);
+    return result;
+}
+
+template <typename T>
+void theilSenBatch(const double* x, size_t n, const T* y, size_t seriesStride, size_t timeStride, size_t series,
+                   RobustTrend* results, ThreadPool* pool, double confidence) {
+    auto fit = [&](size_t first, size_t last) {
+        for (size_t s = first; s < last; ++s) {
+            results[s] = theilSen(x, y + s * seriesStride, n, timeStride, confidence);
+        }
+    };
+    if (pool) {
+        pool->parallelFor(0, series, 4, fit);
+    } else {
+        fit(0, series);
+    }
+}
+
+template RobustTrend theilSen<float>(const double*, const float*, size_t, size_t, double);
+template RobustTrend theilSen<double>(const double*, const double*, size_t, size_t, double);
+template void theilSenBatch<float>(const double*, size_t, const float*, size_t, size_t, size_t, RobustTrend*,
+                                   ThreadPool*, double);
+template void theilSenBatch<double>(const double*, size_t, const double*, size_t, size_t, size_t, RobustTrend*,
+                                    ThreadPool*, double);
@@ -0,0 +1,65 @@
+#ifndef ROBUST_TREND_H
+#define ROBUST_TREND_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// Theil-Sen line and Mann-Kendall trend test of one series. The slope is
+// the median of the slopes of all pairs of points with distinct x (Sen
+// 1968), so up to 29% of the points can be arbitrarily wrong before it
+// moves; the test counts concordant minus discordant pairs (Kendall's S)
+// and needs no assumption about the distribution of the residuals.
+// Everything except n is NaN with fewer than two distinct x values.
+struct RobustTrend {
+    size_t n = 0;
+    double slope = NAN;
+    double intercept = NAN;  // median(y) - slope * median(x), as scipy's theilslopes
+    double slopeLower = NAN; // confidence bounds of the slope from the order statistics of the pairwise
+    double slopeUpper = NAN; // slopes, with ranks set by the variance of S (Sen 1968; Gilbert 1987)
+    double kendallS = NAN;   // concordant minus discordant pairs
+    double kendallTau = NAN; // tau-b, i.e. S over the pairs untied in x and in y
+    double varianceS = NAN;  // variance of S under no trend, corrected for ties in x and in y
+    double z = NAN;          // (S - sign(S)) / sqrt(varianceS), continuity corrected as Mann-Kendall tests are
+    double pValue = NAN;     // two-sided, normal approximation
+
+    bool valid() const { return !std::isnan(slope); }
+};
+
+// Function to fit a Theil-Sen line and run the Mann-Kendall test on n
+// points; value i is y[i * stride] at x[i] and NaN values are skipped. x
+// need not be sorted and may repeat (pairs with equal x have no slope).
+//
+// Both run in O(n log n) rather than over the n (n - 1) / 2 pairs. S comes
+// from counting the inversions of y in x order with a merge sort (Knight
+// 1966). A slope of rank k is selected without listing the pairs: the
+// pairs with slope below t are exactly the inversions of y - t x in x order,
+// so their number costs one merge sort. Pairs drawn uniformly from the ones
+// between two such thresholds pick the next, narrower thresholds around
+// rank k (Matousek 1991), and once O(n) pairs remain between them they are
+// listed and the rank selected directly. The draws come from a fixed
+// counter-based stream and only decide how fast the interval narrows: the
+// result is the exact order statistic.
+template <typename T>
+RobustTrend theilSen(const double* x, const T* y, size_t n, size_t stride = 1, double confidence = 0.95);
+
+template <typename X, typename Y>
+RobustTrend theilSen(const std::vector<X>& x, const std::vector<Y>& y, double confidence = 0.95) {
+    thread_local std::vector<double> xs, ys;
+    xs.assign(x.begin(), x.end());
+    ys.assign(y.begin(), y.end());
+    return theilSen(xs.data(), ys.data(), xs.size(), 1, confidence);
+}
+
+// Function to fit many series against one shared x axis. Value i of series s
+// is y[s * seriesStride + i * timeStride], as in regressBatch, so cell-major
+// grids and the calendar months of a monthly series both work. Series run
+// in parallel when a pool is given; each result is independent of the
+// threads.
+template <typename T>
+void theilSenBatch(const double* x, size_t n, const T* y, size_t seriesStride, size_t timeStride, size_t series,
+                   RobustTrend* results, ThreadPool* pool = nullptr, double confidence = 0.95);
+
+#endif // ROBUST_TREND_H
@@ -0,0 +1,102 @@
+#include "rolling_trend.h"
+
+#include <cmath>
+
+namespace {
+
+enum PrefixSum { SUM_COUNT_VALID = 0, SUM_X, SUM_Y, SUM_XX, SUM_YY, SUM_XY, SUM_COUNT };
+
+struct PrefixSums {
+    double hi[SUM_COUNT] = {};
+    double lo[SUM_COUNT] = {};
+};
+
+} // namespace
+
+std::vector<WindowTrend> computeRollingTrends(const std::vector<double>& x, const std::vector<double>& y,
+                                              const RollingTrendOptions& options) {
+    std::vector<WindowTrend> trends;
+    const size_t n = x.size();
+    if (n == 0 || !(options.window > 0.0) || !(options.stride > 0.0)) {
+        return trends;
+    }
+
+    // Center x on its midpoint and shift y by its first valid value so the
+    // prefix sums stay small
+    const double centerX = 0.5 * (x.front() + x.back());
+    double shiftY = 0.0;
+    for (double value : y) {
+        if (!std::isnan(value)) {
+            shiftY = value;
+            break;
+        }
+    }
+
+    // Compensated prefix sums: a window sum is the difference of two large
+    // prefixes, so each prefix keeps its rounding error in lo to make that
+    // difference exact enough for long monthly series
+    std::vector<PrefixSums> prefix(n + 1);
+    for (size_t i = 0; i < n; ++i) {
+        const bool valid = !std::isnan(y[i]);
+        const double dx = valid ? x[i] - centerX : 0.0;
+        const double dy = valid ? y[i] - shiftY : 0.0;
+        const double terms[SUM_COUNT] = {valid ? 1.0 : 0.0, dx, dy, dx * dx, dy * dy, dx * dy};
+
+        const PrefixSums& previous = prefix[i];
+        PrefixSums& current = prefix[i + 1];
+        for (int k = 0; k < SUM_COUNT; ++k) {
+            // Knuth's TwoSum
+            const double sum = previous.hi[k] + terms[k];
+            const double virtualTerm = sum - previous.hi[k];
+            const double error = (previous.hi[k] - (sum - virtualTerm)) + (terms[k] - virtualTerm);
+            current.hi[k] = sum;
+            current.lo[k] = previous.lo[k] + error;
+        }
+    }
+
+    double start = x.front();
+    if (options.alignTo > 0.0) {
+        start = std::floor(x.front() / options.alignTo) * options.alignTo;
+    }
+    // A window is complete if it ends within one sampling step of the last point
+    const double lastStep = n > 1 ? x[n - 1] - x[n - 2] : 0.0;
+    const double dataEnd = x.back() + lastStep;
+
+    const double firstStart = start;
+    size_t first = 0, last = 0;
+    for (size_t k = 0; (start = firstStart + k * options.stride) <= x.back(); ++k) {
+        const double end = start + options.window;
+        if (!options.partialWindows && end > dataEnd) {
+            break;
+        }
+
+        while (first < n && x[first] < start) ++first;
+        if (last < first) last = first;
+        while (last < n && x[last] < end) ++last;
+
+        WindowTrend trend;
+        trend.start = start;
+        trend.end = end;
+        trend.first = first;
+        trend.last = last;
+
+        double sums[SUM_COUNT];
+        for (int k = 0; k < SUM_COUNT; ++k) {
+            sums[k] = (prefix[last].hi[k] - prefix[first].hi[k]) + (prefix[last].lo[k] - prefix[first].lo[k]);
+        }
+
+        const double c = sums[SUM_COUNT_VALID];
+        if (c >= options.minPoints) {
+            const double mx = sums[SUM_X] / c, my = sums[SUM_Y] / c;
+            trend.fit = regressionFromMoments(c, mx + centerX, my + shiftY,
+                                              sums[SUM_XX] - sums[SUM_X] * mx,
+                                              sums[SUM_YY] - sums[SUM_Y] * my,
+                                              sums[SUM_XY] - sums[SUM_X] * my);
+        } else {
+            trend.fit.n = static_cast<size_t>(c);
+        }
+        trends.push_back(trend);
+    }
+
+    return trends;
+}
@@ -0,0 +1,34 @@
+#ifndef ROLLING_TREND_H
+#define ROLLING_TREND_H
+
+#include <cstddef>
+#include <vector>
+
+#include "regression.h"
+
+// Windows are measured in x units (years), so the same options work for
+// annual rows and for monthly series with fractional-year x.
+struct RollingTrendOptions {
+    double window = 10.0;        // window length
+    double stride = 10.0;        // distance between window starts
+    double alignTo = 0.0;        // > 0: starts are multiples of this (10 = calendar decades); 0: first window starts at the first x
+    size_t minPoints = 2;        // windows with fewer valid points get an invalid fit
+    bool partialWindows = false; // keep trailing windows that run past the end of the data
+};
+
+// Trend over the half-open x interval [start, end)
+struct WindowTrend {
+    double start;
+    double end;
+    size_t first; // index range [first, last) of the points inside the window
+    size_t last;
+    RegressionResult fit;
+};
+
+// Function to fit a trend in every window of a series with ascending x.
+// Compensated prefix sums are built once, so each window costs O(1) however
+// long it is; NaN y values are skipped.
+std::vector<WindowTrend> computeRollingTrends(const std::vector<double>& x, const std::vector<double>& y,
+                                              const RollingTrendOptions& options);
+
+#endif // ROLLING_TREND_H
@@ -0,0 +1,296 @@
+#include "spectrum.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "regression.h"
+#include "thread_pool.h"
+
+namespace {
+
+typedef std::complex<double> Complex;
+
+// Plain complex product; std::complex's operator* checks for infinities
+// and NaNs on every call, which keeps the butterflies from vectorizing
+inline Complex multiply(Complex a, Complex b) {
+    return Complex(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+}
+
+// Function to fit the line of a segment, skipping NaN values, in two
+// branch-free passes; mean is the mean of the values present
+RegressionResult fitSegment(const double* x, const double* y, size_t n, double& mean) {
+    double count = 0.0, sumX = 0.0, sumY = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const bool valid = y[i] == y[i];
+        count += valid ? 1.0 : 0.0;
+        sumX += valid ? x[i] : 0.0;
+        sumY += valid ? y[i] : 0.0;
+    }
+    const double meanX = count > 0.0 ? sumX / count : 0.0;
+    mean = count > 0.0 ? sumY / count : NAN;
+    double sxx = 0.0, syy = 0.0, sxy = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const bool valid = y[i] == y[i];
+        const double dx = valid ? x[i] - meanX : 0.0;
+        const double dy = valid ? y[i] - mean : 0.0;
+        sxx += dx * dx;
+        syy += dy * dy;
+        sxy += dx * dy;
+    }
+    return regressionFromMoments(count, meanX, mean, sxx, syy, sxy);
+}
+
+} // namespace
+
+FftPlan::FftPlan(size_t n) : n_(n), m_(n) {
+    // Bluestein for lengths with a prime factor over 5
+    size_t rest = n;
+    for (size_t p : {2, 3, 5}) {
+        while (rest > 0 && rest % p == 0) rest /= p;
+    }
+    const bool bluestein = n > 1 && rest != 1;
+    if (bluestein) {
+        m_ = 1;
+        while (m_ < 2 * n - 1) m_ <<= 1;
+    }
+
+    // Radix 4 stages first, then 2, 3 and 5
+    rest = m_;
+    for (size_t length = m_; rest > 1;) {
+        Stage stage;
+        stage.radix = rest % 4 == 0 ? 4 : rest % 2 == 0 ? 2 : rest % 3 == 0 ? 3 : 5;
+        stage.twiddleOffset = twiddles_.size();
+        for (size_t r = 0; r < stage.radix; ++r) stage.roots[r] = std::polar(1.0, -2.0 * M_PI * r / stage.radix);
+        const size_t m = length / stage.radix;
+        for (size_t q = 0; q < m; ++q) {
+            for (size_t t = 1; t < stage.radix; ++t) {
+                twiddles_.push_back(std::polar(1.0, -2.0 * M_PI * static_cast<double>(q * t) / length));
+            }
+        }
+        stages_.push_back(stage);
+        rest /= stage.radix;
+        length = m;
+    }
+
+    if (bluestein) {
+        // k^2 mod 2n keeps the chirp's phase exact for long series
+        chirp_.resize(n);
+        for (size_t k = 0; k < n; ++k) chirp_[k] = std::polar(1.0, -M_PI * static_cast<double>(k * k % (2 * n)) / n);
+        chirpSpectrum_.assign(m_, Complex(0.0, 0.0));
+        chirpSpectrum_[0] = std::conj(chirp_[0]);
+        for (size_t k = 1; k < n; ++k) chirpSpectrum_[k] = chirpSpectrum_[m_ - k] = std::conj(chirp_[k]);
+        transformFactored(chirpSpectrum_.data());
+    }
+}
+
+void FftPlan::transformFactored(Complex* data) const {
+    thread_local std::vector<Complex> scratch;
+    scratch.resize(m_);
+    const Complex* in = data;
+    Complex* out = scratch.data();
+
+    // Decimation in frequency: each stage splits blocks of length into radix
+    // interleaved blocks, leaving the output in natural order
+    size_t length = m_, stride = 1;
+    for (const Stage& stage : stages_) {
+        const size_t p = stage.radix;
+        const size_t m = length / p;
+        const Complex* w = &twiddles_[stage.twiddleOffset];
+        for (size_t q = 0; q < m; ++q) {
+            const Complex* wq = w + q * (p - 1);
+            for (size_t s = 0; s < stride; ++s) {
+                const Complex* a = in + s + stride * q;
+                Complex* y = out + s + stride * p * q;
+                if (p == 4) {
+                    const Complex t0 = a[0] + a[2 * stride * m];
+                    const Complex t1 = a[0] - a[2 * stride * m];
+                    const Complex t2 = a[stride * m] + a[3 * stride * m];
+                    const Complex d = a[stride * m] - a[3 * stride * m];
+                    const Complex t3(d.imag(), -d.real()); // -i d
+                    y[0] = t0 + t2;
+                    y[stride] = multiply(t1 + t3, wq[0]);
+                    y[2 * stride] = multiply(t0 - t2, wq[1]);
+                    y[3 * stride] = multiply(t1 - t3, wq[2]);
+                } else if (p == 2) {
+                    const Complex u = a[0], v = a[stride * m];
+                    y[0] = u + v;
+                    y[stride] = multiply(u - v, wq[0]);
+                } else {
+                    Complex values[5];
+                    for (size_t r = 0; r < p; ++r) values[r] = a[r * stride * m];
+                    for (size_t t = 0; t < p; ++t) {
+                        Complex sum = values[0];
+                        for (size_t r = 1; r < p; ++r) sum += multiply(values[r], stage.roots[r * t % p]);
+                        y[t * stride] = t == 0 ? sum : multiply(sum, wq[t - 1]);
+                    }
+                }
+            }
+        }
+        // The first pass reads data; later ones alternate between the buffers
+        in = out;
+        out = out == scratch.data() ? data : scratch.data();
+        length = m;
+        stride *= p;
+    }
+    if (in != data) std::copy(in, in + m_, data);
+}
+
+void FftPlan::forward(Complex* data, size_t count) const {
+    if (n_ == 0) {
+        return;
+    }
+    if (chirp_.empty()) {
+        for (size_t s = 0; s < count; ++s) transformFactored(data + s * n_);
+        return;
+    }
+
+    // Bluestein: X[k] = chirp[k] * (chirped x circularly convolved with the conjugate chirp)[k]
+    thread_local std::vector<Complex> work;
+    work.resize(m_);
+    const double inverse = 1.0 / m_;
+    for (size_t s = 0; s < count; ++s) {
+        Complex* x = data + s * n_;
+        for (size_t k = 0; k < n_; ++k) work[k] = multiply(x[k], chirp_[k]);
+        std::fill(work.begin() + n_, work.end(), Complex(0.0, 0.0));
+        transformFactored(work.data());
+        // The inverse transform is the conjugate of the forward transform of the conjugate
+        for (size_t k = 0; k < m_; ++k) work[k] = std::conj(multiply(work[k], chirpSpectrum_[k]));
+        transformFactored(work.data());
+        for (size_t k = 0; k < n_; ++k) x[k] = multiply(std::conj(work[k]) * inverse, chirp_[k]);
+    }
+}
+
+SpectrumPlan::SpectrumPlan(size_t n, const SpectrumOptions& options)
+    : n_(n), options_(options),
+      fft_(options.segment > 0 && options.segment < n ? options.segment : n) {
+    const size_t length = fft_.size();
+    if (length > 0) {
+        const size_t shared = static_cast<size_t>(std::round(std::min(std::max(options.overlap, 0.0), 0.95) * length));
+        const size_t step = std::max<size_t>(length - shared, 1);
+        for (size_t start = 0; start + length <= n; start += step) starts_.push_back(start);
+    }
+
+    window_.assign(length, 1.0);
+    if (options.taper == TAPER_HANN) {
+        for (size_t i = 0; i < length; ++i) window_[i] = 0.5 - 0.5 * std::cos(2.0 * M_PI * i / length);
+    } else if (options.taper == TAPER_SPLIT_COSINE && length > 1) {
+        // Tukey window with alpha 0.2: a half cosine over the first and last 10%
+        const double edge = 0.1 * (length - 1);
+        for (size_t i = 0; i < length; ++i) {
+            const double distance = std::min<double>(i, length - 1 - i);
+            if (distance < edge) window_[i] = 0.5 - 0.5 * std::cos(M_PI * distance / edge);
+        }
+    }
+    double sumSquares = 0.0;
+    for (double w : window_) sumSquares += w * w;
+    scale_ = sumSquares > 0.0 ? 1.0 / (options.sampleRate * sumSquares) : 0.0;
+}
+
+template <typename T>
+void SpectrumPlan::compute(const T* values, size_t seriesStride, size_t timeStride, size_t count, double* power,
+                           ThreadPool* pool) const {
+    const size_t length = fft_.size();
+    const size_t binCount = bins();
+
+    auto pairs = [&](size_t firstPair, size_t lastPair) {
+        thread_local std::vector<double> x, y, segment[2];
+        thread_local std::vector<Complex> z;
+        x.resize(length);
+        y.resize(length);
+        segment[0].resize(length);
+        segment[1].resize(length);
+        z.resize(length);
+        for (size_t i = 0; i < length; ++i) x[i] = static_cast<double>(i);
+
+        for (size_t pair = firstPair; pair < lastPair; ++pair) {
+            const size_t first = 2 * pair;
+            const size_t members = std::min<size_t>(2, count - first);
+            size_t used[2] = {0, 0};
+            for (size_t j = 0; j < members; ++j) {
+                std::fill(power + (first + j) * binCount, power + (first + j + 1) * binCount, 0.0);
+            }
+
+            for (size_t start : starts_) {
+                // Detrended, tapered segments of both series; missing values become the trend
+                bool valid[2] = {false, false};
+                for (size_t j = 0; j < 2; ++j) {
+                    double* out = segment[j].data();
+                    if (j >= members) {
+                        std::fill(out, out + length, 0.0);
+                        continue;
+                    }
+                    const T* series = values + (first + j) * seriesStride + start * timeStride;
+                    for (size_t i = 0; i < length; ++i) y[i] = static_cast<double>(series[i * timeStride]);
+                    double mean;
+                    const RegressionResult fit = fitSegment(x.data(), y.data(), length, mean);
+                    valid[j] = fit.n >= 2;
+                    double slope = 0.0, intercept = 0.0;
+                    if (options_.detrend == DETREND_LINEAR && fit.valid()) {
+                        slope = fit.slope;
+                        intercept = fit.intercept;
+                    } else if (options_.detrend == DETREND_MEAN && fit.n > 0) {
+                        intercept = mean;
+                    }
+                    for (size_t i = 0; i < length; ++i) {
+                        const double residual = y[i] - (slope * x[i] + intercept);
+                        out[i] = std::isnan(residual) ? 0.0 : residual * window_[i];
+                    }
+                }
+                if (!valid[0] && !valid[1]) continue;
+
+                // Both real segments in one complex transform
+                for (size_t i = 0; i < length; ++i) z[i] = Complex(segment[0][i], segment[1][i]);
+                fft_.forward(z.data(), 1);
+                for (size_t j = 0; j < members; ++j) {
+                    if (!valid[j]) continue;
+                    ++used[j];
+                    double* out = power + (first + j) * binCount;
+                    for (size_t k = 0; k < binCount; ++k) {
+                        const Complex a = z[k];
+                        const Complex b = std::conj(z[(length - k) % length]);
+                        // Spectrum of the real part (a + b) / 2, of the imaginary part (a - b) / 2i
+                        const Complex part = j == 0 ? 0.5 * (a + b) : Complex(0.0, -0.5) * (a - b);
+                        // One-sided: every bin but zero and Nyquist also stands for its negative frequency
+                        const double fold = (k == 0 || 2 * k == length) ? 1.0 : 2.0;
+                        out[k] += fold * std::norm(part);
+                    }
+                }
+            }
+
+            for (size_t j = 0; j < members; ++j) {
+                double* out = power + (first + j) * binCount;
+                const double factor = used[j] > 0 ? scale_ / used[j] : NAN;
+                for (size_t k = 0; k < binCount; ++k) out[k] *= factor;
+            }
+        }
+    };
+
+    const size_t pairCount = (count + 1) / 2;
+    if (pool) {
+        pool->parallelFor(0, pairCount, 8, pairs);
+    } else {
+        pairs(0, pairCount);
+    }
+}
+
+double bandPower(const SpectrumPlan& plan, const double* power, double low, double high) {
+    const double width = plan.frequency(1);
+    double sum = 0.0;
+    for (size_t k = 0; k < plan.bins(); ++k) {
+        const double f = plan.frequency(k);
+        if (f >= low && f <= high) sum += power[k];
+    }
+    return sum * width;
+}
+
+size_t peakBin(const SpectrumPlan& plan, const double* power, double low, double high) {
+    size_t best = 0;
+    for (size_t k = 0; k < plan.bins(); ++k) {
+        const double f = plan.frequency(k);
+        if (f >= low && f <= high && (best == 0 || power[k] > power[best])) best = k;
+    }
+    return best;
+}
+
+template void SpectrumPlan::compute<float>(const float*, size_t, size_t, size_t, double*, ThreadPool*) const;
+template void SpectrumPlan::compute<double>(const double*, size_t, size_t, size_t, double*, ThreadPool*) const;
@@ -0,0 +1,114 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+class ThreadPool;
+
+// Discrete Fourier transform of one length, planned once and shared. Lengths
+// whose only prime factors are 2, 3 and 5 (monthly series of whole years,
+// among others) run as a self-sorting mixed-radix (Stockham) transform with
+// radix 4, 2, 3 and 5 stages and precomputed twiddle factors; other lengths
+// use the chirp of Bluestein's algorithm, which turns the transform into a
+// circular convolution of power-of-two length. Every length costs
+// O(n log n). A plan is read-only after construction, so any number of
+// threads may use it at once.
+class FftPlan {
+public:
+    explicit FftPlan(size_t n);
+
+    size_t size() const { return n_; }
+
+    // Function to transform count series of n values each, stored one after
+    // another, in place: X[k] = sum over j of x[j] exp(-2 pi i j k / n)
+    void forward(std::complex<double>* data, size_t count) const;
+
+private:
+    struct Stage {
+        size_t radix;
+        size_t twiddleOffset; // exp(-2 pi i q t / length) at twiddleOffset + q * (radix - 1) + t - 1
+        std::complex<double> roots[5]; // exp(-2 pi i r / radix)
+    };
+
+    // Function to transform m_ values in place, one pass per stage
+    void transformFactored(std::complex<double>* data) const;
+
+    size_t n_;
+    size_t m_; // length of the factored transform: n, or a power of two of at least 2n - 1
+    std::vector<Stage> stages_;
+    std::vector<std::complex<double>> twiddles_;
+    std::vector<std::complex<double>> chirp_;         // exp(-pi i k^2 / n), Bluestein only
+    std::vector<std::complex<double>> chirpSpectrum_; // transform of the conjugate chirp, over m
+};
+
+enum SpectralDetrend {
+    DETREND_NONE,
+    DETREND_MEAN,
+    DETREND_LINEAR // least squares line
+};
+
+enum SpectralTaper {
+    TAPER_NONE,
+    TAPER_HANN,        // periodic Hann window, scipy's default for Welch
+    TAPER_SPLIT_COSINE // cosine bell over the outer 10% at each end (symmetric Tukey, alpha 0.2)
+};
+
+struct SpectrumOptions {
+    SpectralDetrend detrend = DETREND_LINEAR; // applied to each segment
+    SpectralTaper taper = TAPER_HANN;
+    size_t segment = 0;       // Welch segment length in samples; 0 takes the whole series (a periodogram)
+    double overlap = 0.5;     // fraction of a segment shared with the next
+    double sampleRate = 12.0; // samples per unit time; 12 gives frequencies in cycles per year for months
+};
+
+// Everything shared by the spectra of equal-length series: the segments,
+// the window and its power, and one FftPlan of the segment length
+class SpectrumPlan {
+public:
+    SpectrumPlan(size_t n, const SpectrumOptions& options);
+
+    size_t length() const { return n_; }
+    size_t segmentLength() const { return fft_.size(); }
+    size_t segments() const { return starts_.size(); }
+    // Frequencies 0, 1, ..., segmentLength / 2 times sampleRate / segmentLength
+    size_t bins() const { return fft_.size() / 2 + 1; }
+    double frequency(size_t bin) const { return bin * options_.sampleRate / fft_.size(); }
+    const SpectrumOptions& options() const { return options_; }
+
+    // Function to compute the spectra of count series of length(). Value i
+    // of series s is values[s * seriesStride + i * timeStride], so cell-major
+    // grids (seriesStride months, timeStride 1) and the calendar months of a
+    // monthly series (seriesStride 1, timeStride 12) both work. The one-sided
+    // power spectral density of series s, scaled as scipy's density (a
+    // spectrum's sum times the bin width is the variance), goes to
+    // power[s * bins() + bin].
+    //
+    // Missing values become the segment's fitted trend, i.e. zero after
+    // detrending; a segment with fewer than two values is left out of the
+    // average and a series with no segment left gets NaN throughout. Series
+    // are transformed two at a time as the real and imaginary parts of one
+    // complex transform, and pairs run in parallel when a pool is given.
+    template <typename T>
+    void compute(const T* values, size_t seriesStride, size_t timeStride, size_t count, double* power,
+                 ThreadPool* pool = nullptr) const;
+
+private:
+    size_t n_;
+    SpectrumOptions options_;
+    FftPlan fft_;
+    std::vector<size_t> starts_;
+    std::vector<double> window_;
+    double scale_; // 1 / (sampleRate * sum of squared window weights)
+};
+
+// Function to return the spectral density integrated over frequencies in
+// [low, high], i.e. the variance of the series in that band
+double bandPower(const SpectrumPlan& plan, const double* power, double low, double high);
+
+// Function to return the bin of highest power with frequency in [low, high];
+// 0 if no bin is in range
+size_t peakBin(const SpectrumPlan& plan, const double* power, double low, double high);
+
+#endif // SPECTRUM_H
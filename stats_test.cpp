@@ -0,0 +1,20 @@
+#include <iostream>
+#include <string>
+
+#include "climate_table.h"
+#include "climate_reports.h"
+
+int main(int argc, char* argv[]) {
+    const std::string filename = argc > 1 ? argv[1] : "GISTEMP_global_dataset.csv";
+
+    ClimateTable table;
+    std::string error;
+    if (!readClimateTable(filename, table, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    printStationarityAnalysis(AnalysisPipeline(table, ResamplingOptions()), std::cout);
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include "stream_state.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+static_assert(std::is_trivially_copyable<StreamState>::value, "StreamState is checkpointed byte for byte");
+
+namespace {
+
+const char CHECKPOINT_MAGIC[8] = {'C', 'L', 'S', 'T', 'A', 'T', 'E', '\0'};
+const std::uint32_t CHECKPOINT_VERSION = 4;
+
+struct CheckpointHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t payloadSize;
+    std::uint32_t checksum;
+};
+
+// FNV-1a, enough to catch truncated or partially written checkpoints
+std::uint32_t checksum(const unsigned char* data, size_t size) {
+    std::uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+} // namespace
+
+bool ingestMonth(StreamState& state, int year, int month, double value) {
+    if (year < state.lastYear || (year == state.lastYear && month <= state.lastMonth)) {
+        return false;
+    }
+    state.lastYear = year;
+    state.lastMonth = month;
+
+    bool isHigh, isLow;
+    int highGap, lowGap;
+    state.records[month].update(year, value, isHigh, isLow, highGap, lowGap);
+    if (highGap >= 0) {
+        state.gapRegression[month].add(year - highGap, highGap);
+    }
+
+    state.events.add(year, month, value);
+    return true;
+}
+
+bool ingestAnnual(StreamState& state, int year, double jd) {
+    if (isMissing(jd) || year <= state.lastAnnualYear) {
+        return false;
+    }
+    state.lastAnnualYear = year;
+    state.overallTrend.add(year, jd);
+
+    // Calendar decades, e.g. 1880-1889
+    const int decade = year - ((year % 10) + 10) % 10;
+    if (decade != state.decadeStart) {
+        state.decadeStart = decade;
+        state.decadeTrend.reset();
+    }
+    state.decadeTrend.add(year, jd);
+    return true;
+}
+
+int ingestRow(StreamState& state, int year, const double values[VALUE_COLUMNS]) {
+    // Trailing "***" months have not been published yet
+    int lastPublished = MONTHS_PER_YEAR - 1;
+    while (lastPublished >= 0 && isMissing(values[lastPublished])) --lastPublished;
+
+    int added = 0;
+    for (int month = 0; month <= lastPublished; ++month) {
+        if (ingestMonth(state, year, month, values[month])) ++added;
+    }
+
+    ingestAnnual(state, year, values[MONTHS_PER_YEAR + AGG_JD]);
+    return added;
+}
+
+bool saveStreamState(const StreamState& state, const std::string& filename, std::string& error) {
+    CheckpointHeader header;
+    std::memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    header.version = CHECKPOINT_VERSION;
+    header.payloadSize = sizeof(StreamState);
+    header.checksum = checksum(reinterpret_cast<const unsigned char*>(&state), sizeof(StreamState));
+
+    const std::string tempName = filename + ".tmp";
+    {
+        std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            error = "Error opening file: " + tempName;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(&state), sizeof(StreamState));
+        if (!file.flush()) {
+            error = "Error writing file: " + tempName;
+            return false;
+        }
+    }
+
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+        error = "Error replacing checkpoint: " + filename;
+        return false;
+    }
+    return true;
+}
+
+bool loadStreamState(StreamState& state, const std::string& filename, bool& exists, std::string& error) {
+    std::ifstream file(filename, std::ios::binary);
+    exists = static_cast<bool>(file);
+    if (!exists) {
+        return true;
+    }
+
+    CheckpointHeader header;
+    StreamState loaded;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) != 0) {
+        error = filename + ": not a stream checkpoint";
+        return false;
+    }
+    if (header.version != CHECKPOINT_VERSION || header.payloadSize != sizeof(StreamState)) {
+        error = filename + ": checkpoint was written by an incompatible version";
+        return false;
+    }
+    if (!file.read(reinterpret_cast<char*>(&loaded), sizeof(StreamState))
+        || header.checksum != checksum(reinterpret_cast<const unsigned char*>(&loaded), sizeof(StreamState))) {
+        error = filename + ": checkpoint is truncated or corrupt";
+        return false;
+    }
+
+    state = loaded;
+    return true;
+}
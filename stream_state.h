@@ -0,0 +1,45 @@
+#ifndef STREAM_STATE_H
+#define STREAM_STATE_H
+
+#include <string>
+
+#include "climate_table.h"
+#include "extreme_events.h"
+#include "record_engine.h"
+#include "regression.h"
+
+// Everything the analyses need to continue from the last ingested month.
+// Plain data so that it can be checkpointed byte for byte.
+struct StreamState {
+    int lastYear = -1;       // year and month (0-based) of the last monthly value
+    int lastMonth = -1;
+    int lastAnnualYear = -1; // last year whose J-D average was ingested
+    int decadeStart = -1;    // first year of the decade in decadeTrend
+
+    RecordTracker records[MONTHS_PER_YEAR];
+    RegressionAccumulator gapRegression[MONTHS_PER_YEAR]; // gap start year vs gap size, as in linear_regression
+    RegressionAccumulator overallTrend;                   // J-D anomaly vs year
+    RegressionAccumulator decadeTrend;                    // J-D anomaly vs year for the current calendar decade
+    EventCounter events;                                  // heatwaves / cold snaps across year boundaries
+};
+
+// Function to add one monthly value. Values at or before the last ingested
+// month are ignored and false is returned.
+bool ingestMonth(StreamState& state, int year, int month, double value);
+
+// Function to add one J-D annual average; repeated years are ignored
+bool ingestAnnual(StreamState& state, int year, double jd);
+
+// Function to add the new part of a parsed CSV row: months after the last
+// ingested month up to the row's last published month, and the J-D average
+// once it is present. Returns the number of monthly values added.
+int ingestRow(StreamState& state, int year, const double values[VALUE_COLUMNS]);
+
+// Function to write the state atomically (temporary file and rename)
+bool saveStreamState(const StreamState& state, const std::string& filename, std::string& error);
+
+// Function to read a checkpoint. A missing file leaves state untouched and
+// sets exists to false; a corrupt or mismatched file is an error.
+bool loadStreamState(StreamState& state, const std::string& filename, bool& exists, std::string& error);
+
+#endif // STREAM_STATE_H
@@ -0,0 +1,124 @@
+#include "synthetic_data.h"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "climate_table.h"
+
+namespace {
+
+// Function to append one cell, "***" for NaN
+void appendCell(std::string& out, double value) {
+    char buffer[32];
+    if (std::isnan(value)) {
+        out += ",***";
+        return;
+    }
+    int length = std::snprintf(buffer, sizeof(buffer), ",%.2f", value);
+    out.append(buffer, length);
+}
+
+// Function to average the given months, NaN if any is missing
+double average(const double* values, const int* months, int count) {
+    double sum = 0.0;
+    for (int i = 0; i < count; ++i) {
+        sum += values[months[i]];
+    }
+    return sum / count;
+}
+
+} // namespace
+
+std::string generateSyntheticCsv(size_t rows, std::uint32_t seed, double missingFraction) {
+    std::string out;
+    out.reserve(rows * 120 + 256);
+    out += "Land-Ocean: Global Means,,,,,,,,,,,,,,,,,,\n";
+    out += "Year,Jan,Feb,Mar,Apr,May,Jun,Jul,Aug,Sep,Oct,Nov,Dec,J-D,D-N,DJF,MAM,JJA,SON\n";
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 0.1);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    static const int ALL[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+    static const int MAM[3] = {2, 3, 4};
+    static const int JJA[3] = {5, 6, 7};
+    static const int SON[3] = {8, 9, 10};
+
+    const double nan = std::nan("");
+    double previousDecember = nan;
+    double ar = 0.0;
+    char yearBuffer[16];
+
+    for (size_t row = 0; row < rows; ++row) {
+        const long year = 1880 + static_cast<long>(row);
+        // Trend matches Global.csv over its range and keeps growing slowly beyond it
+        const double trend = -0.3 + 0.0076 * static_cast<double>(row % 1000);
+
+        double months[MONTHS_PER_YEAR];
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            ar = 0.7 * ar + noise(rng);
+            months[m] = uniform(rng) < missingFraction ? nan : std::round((trend + ar) * 100.0) / 100.0;
+        }
+
+        double dn[MONTHS_PER_YEAR] = {previousDecember, months[0], months[1], months[2], months[3], months[4],
+                                      months[5], months[6], months[7], months[8], months[9], months[10]};
+        const int djfMonths[3] = {0, 1, 2};
+
+        int length = std::snprintf(yearBuffer, sizeof(yearBuffer), "%ld", year);
+        out.append(yearBuffer, length);
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            appendCell(out, months[m]);
+        }
+        appendCell(out, average(months, ALL, 12));
+        appendCell(out, average(dn, ALL, 12));
+        appendCell(out, average(dn, djfMonths, 3));
+        appendCell(out, average(months, MAM, 3));
+        appendCell(out, average(months, JJA, 3));
+        appendCell(out, average(months, SON, 3));
+        out += '\n';
+
+        previousDecember = months[11];
+    }
+
+    return out;
+}
+
+std::string generateSyntheticDailyCsv(size_t years, std::uint32_t seed, double missingFraction) {
+    static const int DAYS_IN_MONTH[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    const double pi = 3.14159265358979323846;
+
+    std::string out;
+    out.reserve(years * 366 * 18 + 32);
+    out += "Date,Temperature\n";
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 1.2);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    double ar = 0.0;
+    char buffer[32];
+    for (size_t row = 0; row < years; ++row) {
+        const int year = 1880 + static_cast<int>(row);
+        const bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+        const double trend = -0.3 + 0.0076 * static_cast<double>(row % 1000);
+        int dayOfYear = 0;
+        for (int m = 0; m < 12; ++m) {
+            const int days = DAYS_IN_MONTH[m] + (m == 1 && leap ? 1 : 0);
+            for (int d = 1; d <= days; ++d, ++dayOfYear) {
+                // Coldest around January 15, warmest around July 15
+                const double cycle = 10.0 - 8.0 * std::cos(2.0 * pi * (dayOfYear - 14) / 365.25);
+                ar = 0.8 * ar + noise(rng);
+                int length = std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d,", year, m + 1, d);
+                out.append(buffer, length);
+                if (uniform(rng) < missingFraction) {
+                    out += "***\n";
+                } else {
+                    length = std::snprintf(buffer, sizeof(buffer), "%.1f\n", cycle + trend + ar);
+                    out.append(buffer, length);
+                }
+            }
+        }
+    }
+    return out;
+}
@@ -0,0 +1,22 @@
+#ifndef SYNTHETIC_DATA_H
+#define SYNTHETIC_DATA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Function to generate a Global.csv-shaped file in memory: the
+// "Land-Ocean: Global Means" title line, the Year,Jan,...,SON header and one
+// row per year starting at 1880. Anomalies follow a warming trend with AR(1)
+// noise and carry two decimals; about missingFraction of the months are "***",
+// and any aggregate that depends on a missing month is "***" too.
+std::string generateSyntheticCsv(size_t rows, std::uint32_t seed, double missingFraction = 0.002);
+
+// Function to generate a daily station-like series as "YYYY-MM-DD,value"
+// lines under a "Date,Temperature" header, one per calendar day from
+// 1880-01-01 for the given number of years: a seasonal cycle of absolute
+// temperatures in degrees C plus the same kind of trend and AR(1) noise, with
+// about missingFraction of the days "***".
+std::string generateSyntheticDailyCsv(size_t years, std::uint32_t seed, double missingFraction = 0.002);
+
+#endif // SYNTHETIC_DATA_H
@@ -0,0 +1,314 @@
+#include "table_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(sizeof(int) == sizeof(std::int32_t), "Year column is stored as int32");
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'C', 'L', 'C', 'A', 'C', 'H', 'E', '\0'};
+// 2: monthly-only tables are cached with their derived aggregates
+const std::uint32_t CACHE_VERSION = 2;
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+const size_t SAMPLE_BYTES = 64 * 1024;
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t rows;
+    std::uint64_t sourceSize;
+    std::int64_t sourceMtimeNs;
+    std::uint64_t sourceHash;
+    std::uint64_t fileSize;
+    std::uint32_t columns;
+    std::uint32_t reserved;
+    std::uint64_t headerChecksum; // header (with this field zero) and directory
+};
+
+struct ColumnEntry {
+    std::uint64_t valuesOffset;
+    std::uint64_t maskOffset;
+    std::uint64_t checksum; // values followed by mask
+};
+
+// Layout of a cache with a given number of rows
+struct CacheLayout {
+    ColumnEntry entries[CACHE_COLUMNS];
+    size_t fileSize;
+};
+
+// FNV-1a, 64-bit; seeded with a previous result to hash several ranges
+std::uint64_t checksum(const void* data, size_t size, std::uint64_t hash = 14695981039346656037ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+size_t alignUp(size_t offset) {
+    return (offset + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+}
+
+size_t maskWords(size_t rows) {
+    return (rows + 63) / 64;
+}
+
+size_t elementSize(int column) {
+    return column == 0 ? sizeof(std::int32_t) : sizeof(double);
+}
+
+CacheLayout computeLayout(size_t rows) {
+    CacheLayout layout;
+    size_t offset = sizeof(CacheHeader) + sizeof(layout.entries);
+    for (int column = 0; column < CACHE_COLUMNS; ++column) {
+        offset = alignUp(offset);
+        layout.entries[column].valuesOffset = offset;
+        offset = alignUp(offset + rows * elementSize(column));
+        layout.entries[column].maskOffset = offset;
+        offset += maskWords(rows) * sizeof(std::uint64_t);
+        layout.entries[column].checksum = 0;
+    }
+    layout.fileSize = offset;
+    return layout;
+}
+
+const void* columnValues(const ClimateTable& table, int column) {
+    if (column == 0) return table.years.data();
+    if (column <= MONTHS_PER_YEAR) return table.month(column - 1).data();
+    return table.aggregate(static_cast<AggregateColumn>(column - 1 - MONTHS_PER_YEAR)).data();
+}
+
+std::uint64_t headerChecksum(CacheHeader header, const ColumnEntry* entries) {
+    header.headerChecksum = 0;
+    return checksum(entries, sizeof(ColumnEntry) * CACHE_COLUMNS, checksum(&header, sizeof(header)));
+}
+
+} // namespace
+
+std::string tableCacheFilename(const std::string& csvFilename) {
+    return csvFilename + ".clcache";
+}
+
+bool stampSource(const std::string& filename, SourceStamp& stamp, std::string& error) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || ::fstat(fd, &info) != 0) {
+        if (fd >= 0) ::close(fd);
+        error = "Error opening file: " + filename;
+        return false;
+    }
+
+    stamp.size = static_cast<std::uint64_t>(info.st_size);
+    stamp.mtimeNs = static_cast<std::int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+
+    // Head and tail samples: appended rows and edited headers change the hash
+    std::vector<char> sample(SAMPLE_BYTES);
+    stamp.hash = checksum(&stamp.size, sizeof(stamp.size));
+    const off_t offsets[2] = {0, static_cast<off_t>(stamp.size > SAMPLE_BYTES ? stamp.size - SAMPLE_BYTES : 0)};
+    for (off_t offset : offsets) {
+        ssize_t got = ::pread(fd, sample.data(), sample.size(), offset);
+        if (got < 0) {
+            ::close(fd);
+            error = "Error reading file: " + filename;
+            return false;
+        }
+        stamp.hash = checksum(sample.data(), static_cast<size_t>(got), stamp.hash);
+    }
+
+    ::close(fd);
+    return true;
+}
+
+bool writeTableCache(const ClimateTable& table, const SourceStamp& source, const std::string& filename,
+                     std::string& error) {
+    const size_t rows = table.size();
+    CacheLayout layout = computeLayout(rows);
+
+    // Masks first, so the directory with its checksums can lead the file
+    std::vector<std::uint64_t> masks(CACHE_COLUMNS * maskWords(rows), 0);
+    for (int column = 0; column < CACHE_COLUMNS; ++column) {
+        std::uint64_t* mask = &masks[column * maskWords(rows)];
+        if (column > 0) {
+            const double* values = static_cast<const double*>(columnValues(table, column));
+            for (size_t row = 0; row < rows; ++row) {
+                if (isMissing(values[row])) mask[row / 64] |= std::uint64_t(1) << (row % 64);
+            }
+        }
+        layout.entries[column].checksum = checksum(mask, maskWords(rows) * sizeof(std::uint64_t),
+                                                   checksum(columnValues(table, column), rows * elementSize(column)));
+    }
+
+    CacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = CACHE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.rows = rows;
+    header.sourceSize = source.size;
+    header.sourceMtimeNs = source.mtimeNs;
+    header.sourceHash = source.hash;
+    header.fileSize = layout.fileSize;
+    header.columns = CACHE_COLUMNS;
+    header.headerChecksum = headerChecksum(header, layout.entries);
+
+    // Unique per process, so that concurrent jobs rebuilding the same cache do not interleave
+    const std::string tempName = filename + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            error = "Error opening file: " + tempName;
+            return false;
+        }
+
+        const char padding[CACHE_ALIGNMENT] = {};
+        size_t offset = 0;
+        auto writeAt = [&](size_t target, const void* data, size_t size) {
+            file.write(padding, target - offset);
+            file.write(static_cast<const char*>(data), size);
+            offset = target + size;
+        };
+
+        writeAt(0, &header, sizeof(header));
+        writeAt(offset, layout.entries, sizeof(layout.entries));
+        for (int column = 0; column < CACHE_COLUMNS; ++column) {
+            writeAt(layout.entries[column].valuesOffset, columnValues(table, column), rows * elementSize(column));
+            writeAt(layout.entries[column].maskOffset, &masks[column * maskWords(rows)],
+                    maskWords(rows) * sizeof(std::uint64_t));
+        }
+
+        if (!file.flush()) {
+            file.close();
+            std::remove(tempName.c_str());
+            error = "Error writing file: " + tempName;
+            return false;
+        }
+    }
+
+    if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+        std::remove(tempName.c_str());
+        error = "Error replacing cache: " + filename;
+        return false;
+    }
+    return true;
+}
+
+CacheStatus openTableCache(const std::string& filename, const SourceStamp& expected, bool verifyPayload,
+                           ClimateTable& table, const std::uint64_t* missing[VALUE_COLUMNS], std::string& error) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return CACHE_MISSING;
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CacheHeader)) {
+        ::close(fd);
+        error = filename + ": not a table cache";
+        return CACHE_CORRUPT;
+    }
+
+    // Shared read-only mapping: concurrent jobs share the same page-cache pages
+    const size_t length = static_cast<size_t>(info.st_size);
+    void* address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        error = filename + ": cannot map file";
+        return CACHE_CORRUPT;
+    }
+    std::shared_ptr<const void> mapping(address, [length](const void* p) { ::munmap(const_cast<void*>(p), length); });
+
+    const char* base = static_cast<const char*>(address);
+    CacheHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(header.magic)) != 0) {
+        error = filename + ": not a table cache";
+        return CACHE_CORRUPT;
+    }
+    if (header.version != CACHE_VERSION || header.byteOrder != BYTE_ORDER_MARK) {
+        return CACHE_STALE;
+    }
+    if (header.columns != CACHE_COLUMNS || length < sizeof(CacheHeader) + sizeof(ColumnEntry) * CACHE_COLUMNS) {
+        error = filename + ": cache is truncated or corrupt";
+        return CACHE_CORRUPT;
+    }
+
+    const ColumnEntry* entries = reinterpret_cast<const ColumnEntry*>(base + sizeof(CacheHeader));
+    const size_t rows = static_cast<size_t>(header.rows);
+    const CacheLayout layout = computeLayout(rows);
+    bool layoutMatches = header.fileSize == length && layout.fileSize == length;
+    for (int column = 0; layoutMatches && column < CACHE_COLUMNS; ++column) {
+        layoutMatches = entries[column].valuesOffset == layout.entries[column].valuesOffset
+                     && entries[column].maskOffset == layout.entries[column].maskOffset;
+    }
+    if (!layoutMatches || header.headerChecksum != headerChecksum(header, entries)) {
+        error = filename + ": cache is truncated or corrupt";
+        return CACHE_CORRUPT;
+    }
+
+    if (header.sourceSize != expected.size || header.sourceMtimeNs != expected.mtimeNs
+        || header.sourceHash != expected.hash) {
+        return CACHE_STALE;
+    }
+
+    if (verifyPayload) {
+        for (int column = 0; column < CACHE_COLUMNS; ++column) {
+            const ColumnEntry& entry = entries[column];
+            std::uint64_t sum = checksum(base + entry.maskOffset, maskWords(rows) * sizeof(std::uint64_t),
+                                         checksum(base + entry.valuesOffset, rows * elementSize(column)));
+            if (sum != entry.checksum) {
+                error = filename + ": cache column " + std::to_string(column) + " fails its checksum";
+                return CACHE_CORRUPT;
+            }
+        }
+    }
+
+    table.clear();
+    table.years.borrow(reinterpret_cast<const int*>(base + entries[0].valuesOffset), rows);
+    for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+        table.monthly[m].borrow(reinterpret_cast<const double*>(base + entries[1 + m].valuesOffset), rows);
+    }
+    for (int a = 0; a < AGG_COUNT; ++a) {
+        table.aggregates[a].borrow(
+            reinterpret_cast<const double*>(base + entries[1 + MONTHS_PER_YEAR + a].valuesOffset), rows);
+    }
+    if (missing) {
+        for (int column = 0; column < VALUE_COLUMNS; ++column) {
+            missing[column] = reinterpret_cast<const std::uint64_t*>(base + entries[1 + column].maskOffset);
+        }
+    }
+    table.mapping = mapping;
+    return CACHE_OK;
+}
+
+bool readClimateTable(const std::string& filename, ClimateTable& table, std::string& error) {
+    SourceStamp stamp;
+    if (!stampSource(filename, stamp, error)) {
+        return false;
+    }
+
+    const std::string cacheFilename = tableCacheFilename(filename);
+    std::string cacheError;
+    if (openTableCache(cacheFilename, stamp, false, table, nullptr, cacheError) == CACHE_OK) {
+        return true;
+    }
+
+    // Stamped before parsing: a CSV that changes meanwhile leaves a stale cache, never a wrong one
+    if (!readClimateCsv(filename, table, error)) {
+        return false;
+    }
+
+    // A read-only directory only costs the next run another parse
+    writeTableCache(table, stamp, cacheFilename, cacheError);
+    return true;
+}
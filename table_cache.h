@@ -0,0 +1,63 @@
+#ifndef TABLE_CACHE_H
+#define TABLE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "climate_table.h"
+
+// Binary columnar cache of a parsed GISTEMP CSV, written beside it as
+// "<file>.clcache" and opened with mmap. The file holds a fixed header, a
+// directory with one entry per column and, for each column, its values and
+// a missing-value bitmask, every array aligned to CACHE_ALIGNMENT bytes.
+// Columns are Year (int32) followed by the twelve months and six aggregates
+// (double, NaN for "***"). The layout is native-endian; a byte order marker
+// rejects files written on another architecture.
+
+const size_t CACHE_ALIGNMENT = 64;
+
+// Number of columns in a cache: Year plus the value columns
+const int CACHE_COLUMNS = 1 + VALUE_COLUMNS;
+
+// Identity of the source CSV. The cache is only used while the CSV has the
+// same size, modification time and content hash; the hash covers the first
+// and last 64 KiB so that stamping a multi-GB file stays cheap.
+struct SourceStamp {
+    std::uint64_t size = 0;
+    std::int64_t mtimeNs = 0;
+    std::uint64_t hash = 0;
+};
+
+// Outcome of opening a cache
+enum CacheStatus {
+    CACHE_OK,      // table borrows its columns from the mapping
+    CACHE_MISSING, // no cache file
+    CACHE_STALE,   // cache of another version of the CSV, or another format version
+    CACHE_CORRUPT  // damaged or truncated; error describes the problem
+};
+
+// Function to name the cache that belongs to a CSV
+std::string tableCacheFilename(const std::string& csvFilename);
+
+// Function to stamp a source file
+bool stampSource(const std::string& filename, SourceStamp& stamp, std::string& error);
+
+// Function to write the cache atomically (temporary file and rename)
+bool writeTableCache(const ClimateTable& table, const SourceStamp& source, const std::string& filename,
+                     std::string& error);
+
+// Function to map a cache read-only and point the table's columns at it. The
+// header and directory are always checked; verifyPayload also checks every
+// column against its checksum, which reads the whole file. When missing is
+// not null it receives each column's bitmask (bit r of word r / 64 is set
+// when row r is missing), indexed like the value columns of a CSV row.
+CacheStatus openTableCache(const std::string& filename, const SourceStamp& expected, bool verifyPayload,
+                           ClimateTable& table, const std::uint64_t* missing[VALUE_COLUMNS], std::string& error);
+
+// Returns true if bit row of a missing-value bitmask is set
+inline bool maskBit(const std::uint64_t* mask, size_t row) {
+    return (mask[row / 64] >> (row % 64)) & 1u;
+}
+
+#endif // TABLE_CACHE_H
@@ -0,0 +1,160 @@
+// Augmented Dickey-Fuller statistics against direct least squares fits, and
+// MacKinnon p-values and critical values against statsmodels
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "adf_test.h"
+#include "test_check.h"
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Function to fit y on the columns of X (row-major, p columns) by solving the
+// normal equations in long double with Gauss-Jordan elimination; returns the
+// residual sum of squares and the t statistic of column k
+double olsFit(const std::vector<double>& X, const std::vector<double>& y, size_t p, size_t k, double& tStatistic) {
+    const size_t n = y.size();
+    std::vector<long double> a(p * 2 * p, 0.0L), b(p, 0.0L);
+    for (size_t t = 0; t < n; ++t) {
+        for (size_t i = 0; i < p; ++i) {
+            b[i] += static_cast<long double>(X[t * p + i]) * y[t];
+            for (size_t j = 0; j < p; ++j) a[i * 2 * p + j] += static_cast<long double>(X[t * p + i]) * X[t * p + j];
+        }
+    }
+    for (size_t i = 0; i < p; ++i) a[i * 2 * p + p + i] = 1.0L;
+    for (size_t c = 0; c < p; ++c) {
+        size_t pivot = c;
+        for (size_t r = c + 1; r < p; ++r) {
+            if (std::fabs(a[r * 2 * p + c]) > std::fabs(a[pivot * 2 * p + c])) pivot = r;
+        }
+        for (size_t j = 0; j < 2 * p; ++j) std::swap(a[c * 2 * p + j], a[pivot * 2 * p + j]);
+        std::swap(b[c], b[pivot]);
+        for (size_t r = 0; r < p; ++r) {
+            if (r == c) continue;
+            const long double f = a[r * 2 * p + c] / a[c * 2 * p + c];
+            for (size_t j = 0; j < 2 * p; ++j) a[r * 2 * p + j] -= f * a[c * 2 * p + j];
+            b[r] -= f * b[c];
+        }
+    }
+    std::vector<long double> beta(p);
+    for (size_t i = 0; i < p; ++i) beta[i] = b[i] / a[i * 2 * p + i];
+
+    long double ssr = 0.0L;
+    for (size_t t = 0; t < n; ++t) {
+        long double fitted = 0.0L;
+        for (size_t i = 0; i < p; ++i) fitted += beta[i] * X[t * p + i];
+        ssr += (y[t] - fitted) * (y[t] - fitted);
+    }
+    const long double inverseKK = a[k * 2 * p + p + k] / a[k * 2 * p + k];
+    tStatistic = static_cast<double>(beta[k] / std::sqrt(ssr / (n - p) * inverseKK));
+    return static_cast<double>(ssr);
+}
+
+// Function to fit the Dickey-Fuller regression with lag lagged differences on
+// the differences from index first on; returns the residual sum of squares
+// and sets the level's t statistic and the number of observations
+double dickeyFuller(const std::vector<double>& x, AdfRegression regression, int lag, size_t first,
+                    double& tStatistic, size_t& nobs) {
+    const size_t terms = regression == ADF_NO_CONSTANT ? 0 : (regression == ADF_CONSTANT ? 1 : 2);
+    const size_t p = terms + 1 + lag;
+    std::vector<double> X, y;
+    for (size_t t = first; t + 1 < x.size(); ++t) {
+        // Difference x[t + 1] - x[t] on the level x[t] and the differences before it
+        if (terms >= 1) X.push_back(1.0);
+        if (terms == 2) X.push_back(static_cast<double>(t));
+        X.push_back(x[t]);
+        for (int i = 1; i <= lag; ++i) X.push_back(x[t + 1 - i] - x[t - i]);
+        y.push_back(x[t + 1] - x[t]);
+    }
+    nobs = y.size();
+    return olsFit(X, y, p, terms, tStatistic);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1979);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    const AdfRegression regressions[] = {ADF_NO_CONSTANT, ADF_CONSTANT, ADF_CONSTANT_TREND};
+
+    for (int trial = 0; trial < 30; ++trial) {
+        // AR(2) series, some near a unit root, with a drift
+        const size_t n = 40 + static_cast<size_t>(trial) * 7;
+        const double phi = trial % 3 == 0 ? 0.98 : 0.6;
+        std::vector<double> x(n);
+        double previous = 0.0, beforePrevious = 0.0;
+        for (size_t t = 0; t < n; ++t) {
+            const double value = 0.05 * t + phi * previous + 0.25 * (previous - beforePrevious) + noise(rng);
+            beforePrevious = previous;
+            previous = value;
+            x[t] = value;
+        }
+
+        for (AdfRegression regression : regressions) {
+            // Fixed lag: the statistic is the level's t in one OLS fit
+            for (int lag = 0; lag <= 4; ++lag) {
+                AdfOptions options;
+                options.regression = regression;
+                options.autolag = ADF_LAG_FIXED;
+                options.maxLag = lag;
+                const AdfResult result = adfTest(x.data(), n, options);
+                double tStatistic;
+                size_t nobs;
+                dickeyFuller(x, regression, lag, lag, tStatistic, nobs);
+                CHECK(result.usedLag == lag && result.nobs == nobs);
+                CHECK_NEAR(result.statistic, tStatistic, 1e-8);
+                CHECK_NEAR(result.pValue, mackinnonPValue(tStatistic, regression), 1e-8);
+            }
+
+            // AIC: every lag fitted separately on the observations maxLag
+            // allows, the smallest criterion winning (ties to the shorter lag)
+            const int maxLag = 6;
+            AdfOptions options;
+            options.regression = regression;
+            options.maxLag = maxLag;
+            const AdfResult result = adfTest(x.data(), n, options);
+            const size_t terms = regression == ADF_NO_CONSTANT ? 0 : (regression == ADF_CONSTANT ? 1 : 2);
+            int bestLag = -1;
+            double bestIc = 0.0;
+            for (int lag = maxLag; lag >= 0; --lag) {
+                double tStatistic;
+                size_t nobs;
+                const double ssr = dickeyFuller(x, regression, lag, maxLag, tStatistic, nobs);
+                const double ic = nobs * (std::log(2.0 * PI) + std::log(ssr / nobs) + 1.0) + 2.0 * (terms + 1 + lag);
+                if (bestLag < 0 || ic <= bestIc) {
+                    bestLag = lag;
+                    bestIc = ic;
+                }
+            }
+            CHECK(result.usedLag == bestLag);
+            CHECK_NEAR(result.icBest, bestIc, 1e-9);
+
+            // The chosen lag is refitted on every observation it allows
+            double tStatistic;
+            size_t nobs;
+            dickeyFuller(x, regression, bestLag, bestLag, tStatistic, nobs);
+            CHECK(result.nobs == nobs);
+            CHECK_NEAR(result.statistic, tStatistic, 1e-8);
+        }
+    }
+
+    // statsmodels 0.15 mackinnonp and mackinnoncrit (nobs 100)
+    const double statistics[5] = {-4.5, -3.2, -2.5, -1.0, 0.5};
+    const double pValues[3][5] = {
+        {9.443579625324582e-06, 0.0013776281110360416, 0.012004037384041915, 0.28810611212633064, 0.824879195252956},
+        {0.0001966399003359905, 0.019984679218641072, 0.11547432475870761, 0.7532643012005655, 0.9848730963065522},
+        {0.0015095180777541192, 0.08440170242654821, 0.32796229628585105, 0.9441147109023218, 0.996851911498776}};
+    const double critical[3][3] = {{-2.5884607, -1.943991277, -1.614410036},
+                                   {-3.497501033, -2.89090644, -2.5824349},
+                                   {-4.052277955, -3.455342974, -3.15332088}};
+    for (int r = 0; r < 3; ++r) {
+        for (int i = 0; i < 5; ++i) CHECK_NEAR(mackinnonPValue(statistics[i], regressions[r]), pValues[r][i], 1e-10);
+        double values[3];
+        mackinnonCriticalValues(regressions[r], 100, values);
+        for (int level = 0; level < 3; ++level) CHECK_NEAR(values[level], critical[r][level], 1e-9);
+    }
+    return testResult();
+}
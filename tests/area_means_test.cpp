@@ -0,0 +1,123 @@
+// Area-weighted regional means of a small grid against a direct weighted
+// average over each region's valid cells
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "area_means.h"
+#include "gridded_field.h"
+#include "thread_pool.h"
+#include "test_check.h"
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Function to average month t over the region's cells directly: weights
+// cos(latitude) over the cells with a value, missing when none has one or
+// they cover less than minCoverage of the region's area. Areas are counted
+// per row, so a coverage exactly at the cutoff is not lost to rounding.
+double directMean(const GriddedField& field, const MeanRegion& region, size_t t, double minCoverage) {
+    double sum = 0.0, weight = 0.0, full = 0.0;
+    for (int lat = 0; lat < field.nlat; ++lat) {
+        const double latitude = field.latitude(lat);
+        if (latitude < region.south || (latitude >= region.north && region.north < 90.0)) continue;
+        const double w = std::cos(latitude * PI / 180.0);
+        int valid = 0;
+        for (int lon = 0; lon < field.nlon; ++lon) {
+            const float value = field.series(static_cast<size_t>(lat) * field.nlon + lon)[t];
+            if (std::isnan(value)) continue;
+            sum += w * value;
+            ++valid;
+        }
+        weight += w * valid;
+        full += w * field.nlon;
+    }
+    if (weight == 0.0 || weight < minCoverage * full) return NAN;
+    return sum / weight;
+}
+
+void checkField(const GriddedField& field, const std::vector<MeanRegion>& regions, double minCoverage,
+                ThreadPool& pool) {
+    AreaMeanOptions options;
+    options.minCoverage = minCoverage;
+    std::vector<ClimateTable> tables;
+    areaMeans(field, regions, options, pool, tables);
+    CHECK(tables.size() == regions.size());
+    for (size_t r = 0; r < regions.size(); ++r) {
+        const ClimateTable& table = tables[r];
+        CHECK(table.size() == static_cast<size_t>(field.years()));
+        for (size_t y = 0; y < table.size(); ++y) {
+            CHECK(table.years[y] == field.startYear + static_cast<int>(y));
+            for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+                const size_t t = y * MONTHS_PER_YEAR + m;
+                // The trailing partial year is padded with missing months
+                const double expected = t < static_cast<size_t>(field.months)
+                                            ? directMean(field, regions[r], t, minCoverage)
+                                            : NAN;
+                CHECK_NEAR(table.month(m)[y], expected, 1e-12);
+            }
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1987);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // 9 x 8 cells over more than one block of months, ending mid-year
+    GriddedField field;
+    field.nlat = 9;
+    field.nlon = 8;
+    field.startYear = 1950;
+    field.months = 12 * 25 + 5;
+    field.values.resize(field.cells() * field.months);
+    for (size_t cell = 0; cell < field.cells(); ++cell) {
+        const int lat = static_cast<int>(cell / field.nlon);
+        for (int t = 0; t < field.months; ++t) {
+            float value = static_cast<float>(std::round((0.02 * lat + noise(rng)) * 100.0) / 100.0);
+            if (unit(rng) < 0.3) value = NAN;                   // scattered gaps
+            if (t % 50 == 7 && lat < field.nlat / 2) value = NAN; // whole southern rows missing
+            if (t == 100) value = NAN;                          // a month with no data at all
+            field.series(cell)[t] = value;
+        }
+    }
+
+    std::vector<MeanRegion> regions = standardRegions();
+    regions.push_back({"Row", 10.0, 30.0}); // exactly one row of cells
+    ThreadPool one(1), three(3);
+    for (double minCoverage : {0.0, 0.5, 0.75, 1.0}) {
+        checkField(field, regions, minCoverage, one);
+        checkField(field, regions, minCoverage, three);
+    }
+
+    // A zonal-mean field (one longitude) reduces the same way
+    GriddedField zonal = field;
+    zonal.nlon = 1;
+    zonal.values.resize(zonal.cells() * zonal.months);
+    for (size_t lat = 0; lat < zonal.cells(); ++lat) {
+        for (int t = 0; t < zonal.months; ++t) zonal.series(lat)[t] = field.series(lat * field.nlon)[t];
+    }
+    checkField(zonal, regions, 0.5, three);
+
+    // The packed field of two-decimal values gives the same means
+    PackedField packed;
+    CHECK(packGriddedField(field, packed) == 0);
+    AreaMeanOptions options;
+    options.minCoverage = 0.5;
+    std::vector<ClimateTable> fromFloat, fromPacked;
+    areaMeans(field, regions, options, three, fromFloat);
+    areaMeans(packed, regions, options, three, fromPacked);
+    for (size_t r = 0; r < regions.size(); ++r) {
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            for (size_t y = 0; y < fromFloat[r].size(); ++y) {
+                CHECK_NEAR(fromPacked[r].month(m)[y], fromFloat[r].month(m)[y], 1e-6);
+            }
+        }
+    }
+    return testResult();
+}
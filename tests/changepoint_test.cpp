@@ -0,0 +1,110 @@
+// PELT against exhaustive optimal partitioning on small series
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "changepoint.h"
+#include "test_check.h"
+
+namespace {
+
+// Function to compute the residual sum of squares of points [s, t) directly
+double segmentCost(const std::vector<double>& x, const std::vector<double>& y, size_t s, size_t t,
+                   ChangeModel model) {
+    const double c = static_cast<double>(t - s);
+    double mx = 0.0, my = 0.0;
+    for (size_t i = s; i < t; ++i) {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= c;
+    my /= c;
+    double sxx = 0.0, syy = 0.0, sxy = 0.0;
+    for (size_t i = s; i < t; ++i) {
+        sxx += (x[i] - mx) * (x[i] - mx);
+        syy += (y[i] - my) * (y[i] - my);
+        sxy += (x[i] - mx) * (y[i] - my);
+    }
+    double rss = syy;
+    if (model == CHANGE_TREND && sxx > 0.0) rss -= sxy * sxy / sxx;
+    return rss > 0.0 ? rss : 0.0;
+}
+
+// Function to find the minimum of cost plus penalty per changepoint over
+// every partition whose segments hold at least minSegment points
+double optimalPartitioning(const std::vector<double>& x, const std::vector<double>& y, size_t minSegment,
+                           double penalty, ChangeModel model) {
+    const size_t n = y.size();
+    if (n < 2 * minSegment) {
+        return segmentCost(x, y, 0, n, model);
+    }
+    std::vector<double> best(n + 1, std::numeric_limits<double>::infinity());
+    best[0] = -penalty;
+    for (size_t t = minSegment; t <= n; ++t) {
+        for (size_t s = 0; s + minSegment <= t; ++s) {
+            if (s != 0 && s < minSegment) continue;
+            const double total = best[s] + segmentCost(x, y, s, t, model) + penalty;
+            if (total < best[t]) best[t] = total;
+        }
+    }
+    return best[n];
+}
+
+// Function to draw a piecewise series with a few random breaks
+void piecewiseSeries(std::mt19937& rng, size_t n, std::vector<double>& x, std::vector<double>& y) {
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> level(-3.0, 3.0);
+    std::uniform_int_distribution<size_t> gap(3, 15);
+    x.resize(n);
+    y.resize(n);
+    double mean = level(rng), slope = 0.1 * level(rng);
+    size_t nextBreak = gap(rng);
+    for (size_t i = 0; i < n; ++i) {
+        if (i == nextBreak) {
+            mean = level(rng);
+            slope = 0.1 * level(rng);
+            nextBreak += gap(rng);
+        }
+        x[i] = 1900.0 + static_cast<double>(i);
+        y[i] = mean + slope * static_cast<double>(i % 16) + noise(rng);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2012);
+    std::uniform_int_distribution<size_t> length(4, 90);
+    std::uniform_int_distribution<size_t> segment(1, 8);
+    std::uniform_real_distribution<double> penalty(0.5, 12.0);
+    std::vector<double> x, y;
+
+    for (int trial = 0; trial < 400; ++trial) {
+        piecewiseSeries(rng, length(rng), x, y);
+        const ChangeModel model = trial % 2 == 0 ? CHANGE_TREND : CHANGE_MEAN;
+
+        // Explicit penalty and minimum segment length
+        ChangepointOptions options;
+        options.model = model;
+        options.penalty = penalty(rng);
+        options.minSegment = segment(rng);
+        options.pruningBudget = 0;
+        ChangepointResult result = detectChangepoints(x.data(), y.data(), y.size(), 1, options);
+        CHECK(result.method == CHANGE_PELT);
+        const double expected = optimalPartitioning(x, y, options.minSegment, options.penalty, model);
+        CHECK_NEAR(result.cost + result.penalty * result.changepoints(), expected, 1e-9);
+        for (const ChangeSegment& s : result.segments) {
+            CHECK(result.changepoints() == 0 || s.last - s.first >= options.minSegment);
+        }
+
+        // Defaults: estimated penalty and 3 points per segment parameter
+        ChangepointOptions defaults;
+        defaults.model = model;
+        result = detectChangepoints(x.data(), y.data(), y.size(), 1, defaults);
+        const size_t minSegment = model == CHANGE_TREND ? 6 : 3;
+        CHECK_NEAR(result.cost + result.penalty * result.changepoints(),
+                   optimalPartitioning(x, y, minSegment, result.penalty, model), 1e-9);
+    }
+    return testResult();
+}
@@ -0,0 +1,108 @@
+// KLL quantile sketches against sorting the values themselves
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "quantile_sketch.h"
+#include "test_check.h"
+
+namespace {
+
+const double QS[] = {0.0, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 1.0};
+
+// Function to interpolate the q-quantile linearly between ranks, as numpy's
+// default percentile does, selecting the two ranks with nth_element
+double exactQuantile(std::vector<double> values, double q) {
+    const double position = q * (values.size() - 1);
+    const size_t lower = static_cast<size_t>(std::floor(position));
+    std::nth_element(values.begin(), values.begin() + lower, values.end());
+    const double low = values[lower];
+    if (lower + 1 >= values.size()) {
+        return low;
+    }
+    const double high = *std::min_element(values.begin() + lower + 1, values.end());
+    return low + (high - low) * (position - lower);
+}
+
+// Function to return how far the value v is from rank q of sorted, as a
+// fraction of the count: 0 when q falls among the ranks holding v
+double rankError(const std::vector<double>& sorted, double v, double q) {
+    const double n = static_cast<double>(sorted.size());
+    const double below = static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), v) - sorted.begin());
+    const double through = static_cast<double>(std::upper_bound(sorted.begin(), sorted.end(), v) - sorted.begin());
+    const double target = q * (n - 1);
+    if (target < below) return (below - target) / n;
+    if (target > through) return (target - through) / n;
+    return 0.0;
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(2016);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Up to k values the sketch never compacts, so every percentile is exact;
+    // values are rounded so some tie, and NaN values are ignored
+    const size_t smallSizes[] = {1, 2, 5, 30, 150, 199, 200};
+    for (size_t n : smallSizes) {
+        QuantileSketch sketch;
+        std::vector<double> values;
+        while (values.size() < n) {
+            const double value = unit(rng) < 0.05 ? NAN : std::round(noise(rng) * 10.0) / 10.0;
+            sketch.add(value);
+            if (!std::isnan(value)) values.push_back(value);
+        }
+        CHECK(sketch.count() == n);
+        for (double q : QS) CHECK_NEAR(sketch.quantile(q), exactQuantile(values, q), 1e-12);
+
+        double many[sizeof(QS) / sizeof(QS[0])];
+        sketch.quantiles(QS, sizeof(QS) / sizeof(QS[0]), many);
+        for (size_t i = 0; i < sizeof(QS) / sizeof(QS[0]); ++i) CHECK_NEAR(many[i], sketch.quantile(QS[i]), 0.0);
+    }
+    CHECK(std::isnan(QuantileSketch().quantile(0.5)));
+
+    // At large n a quantile's rank is off by about 1.7 / k of the count;
+    // allow twice that, on skewed data with ties
+    const size_t n = 1000000;
+    const double bound = 2.0 * 1.7 / 200;
+    std::vector<double> values(n);
+    for (double& value : values) value = std::round(std::exp(noise(rng)) * 1000.0) / 1000.0;
+    QuantileSketch whole;
+    for (double value : values) whole.add(value);
+    std::vector<double> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    CHECK(whole.count() == n && whole.retained() < 2000);
+    for (double q : QS) CHECK(rankError(sorted, whole.quantile(q), q) <= bound);
+    CHECK(whole.quantile(0.0) >= sorted.front() && whole.quantile(1.0) <= sorted.back());
+
+    // Sketches of disjoint parts (as grid cells or thread blocks) merged in
+    // order are a sketch of the whole: same count, same rank guarantee
+    QuantileSketch merged;
+    const size_t parts = 37;
+    for (size_t p = 0; p < parts; ++p) {
+        QuantileSketch part;
+        for (size_t i = p * n / parts; i < (p + 1) * n / parts; ++i) part.add(values[i]);
+        merged.merge(part);
+    }
+    CHECK(merged.count() == whole.count());
+    for (double q : QS) CHECK(rankError(sorted, merged.quantile(q), q) <= bound);
+
+    // While the merged parts total at most k values nothing compacts, and
+    // the merged sketch answers exactly as one sketch of all of them
+    QuantileSketch small, single, half;
+    for (size_t i = 0; i < 180; ++i) {
+        single.add(values[i]);
+        (i % 2 == 0 ? small : half).add(values[i]);
+    }
+    small.merge(half);
+    std::vector<double> first(values.begin(), values.begin() + 180);
+    for (double q : QS) {
+        CHECK_NEAR(small.quantile(q), single.quantile(q), 0.0);
+        CHECK_NEAR(small.quantile(q), exactQuantile(first, q), 1e-12);
+    }
+    return testResult();
+}
@@ -0,0 +1,137 @@
+// Range queries against a linear scan of the same range
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "range_index.h"
+#include "synthetic_data.h"
+#include "test_check.h"
+
+namespace {
+
+// Function to summarize values[first, last) by scanning it; extremes are the
+// earliest position holding them, -1 when nothing is valid
+void scanRange(const std::vector<double>& values, size_t first, size_t last, size_t& count, double& sum,
+               long& argMax, long& argMin) {
+    count = 0;
+    sum = 0.0;
+    argMax = argMin = -1;
+    for (size_t i = first; i < last; ++i) {
+        if (std::isnan(values[i])) continue;
+        ++count;
+        sum += values[i];
+        if (argMax < 0 || values[i] > values[argMax]) argMax = static_cast<long>(i);
+        if (argMin < 0 || values[i] < values[argMin]) argMin = static_cast<long>(i);
+    }
+}
+
+void checkSeriesRange(const SeriesIndex& index, const std::vector<double>& values, size_t first, size_t last) {
+    size_t count;
+    double sum;
+    long argMax, argMin;
+    scanRange(values, first, last, count, sum, argMax, argMin);
+    CHECK(index.count(first, last) == count);
+    CHECK_NEAR(index.sum(first, last), sum, 1e-12);
+    CHECK(index.argMax(first, last) == argMax);
+    CHECK(index.argMin(first, last) == argMin);
+}
+
+// Function to check the extremes and totals of a RangeIndex answer against
+// the values of the rows or months it covers
+void checkStats(const RangeStats& stats, const std::vector<double>& values, const std::vector<int>& years,
+                const std::vector<int>& months) {
+    size_t count;
+    double sum;
+    long argMax, argMin;
+    scanRange(values, 0, values.size(), count, sum, argMax, argMin);
+    CHECK(stats.count == count);
+    CHECK_NEAR(stats.sum, sum, 1e-12);
+    if (argMax < 0) {
+        CHECK(stats.maxYear == -1 && stats.minYear == -1 && std::isnan(stats.mean));
+        return;
+    }
+    CHECK_NEAR(stats.mean, sum / count, 1e-12);
+    CHECK(stats.max == values[argMax] && stats.maxYear == years[argMax] && stats.maxMonth == months[argMax]);
+    CHECK(stats.min == values[argMin] && stats.minYear == years[argMin] && stats.minMonth == months[argMin]);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1314);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    // Lengths around the block size; values rounded so extremes tie, and runs
+    // of NaN long enough to empty whole blocks
+    const size_t lengths[] = {1, 2, 31, 32, 33, 64, 65, 100, 257, 1000};
+    for (size_t n : lengths) {
+        std::vector<double> values(n);
+        for (size_t i = 0; i < n; ++i) {
+            values[i] = std::round(unit(rng) * 20.0) / 4.0;
+            if (unit(rng) < 0.1 || (i / 40) % 5 == 3) values[i] = NAN;
+        }
+        SeriesIndex index;
+        index.build(values.data(), n);
+        if (n <= 100) {
+            for (size_t first = 0; first <= n; ++first) {
+                for (size_t last = first; last <= n; ++last) checkSeriesRange(index, values, first, last);
+            }
+        } else {
+            std::uniform_int_distribution<size_t> position(0, n);
+            for (int q = 0; q < 5000; ++q) {
+                size_t first = position(rng), last = position(rng);
+                if (first > last) std::swap(first, last);
+                checkSeriesRange(index, values, first, last);
+            }
+        }
+    }
+
+    // Whole-table queries by year and by month
+    const std::string csv = generateSyntheticCsv(200, 7, 0.05);
+    ClimateTable table;
+    std::string error;
+    CHECK(parseClimateTable(csv.data(), csv.size(), table, error));
+    RangeIndex index;
+    CHECK(index.build(table, error));
+    const int firstYear = table.years[0], lastYear = table.years[table.size() - 1];
+    std::uniform_int_distribution<int> year(firstYear - 5, lastYear + 5);
+    std::uniform_int_distribution<int> month(0, MONTHS_PER_YEAR - 1);
+    std::vector<double> values;
+    std::vector<int> years, months;
+    for (int q = 0; q < 2000; ++q) {
+        int from = year(rng), to = year(rng);
+        if (from > to) std::swap(from, to);
+
+        const int column = q % VALUE_COLUMNS;
+        values.clear();
+        years.clear();
+        months.clear();
+        for (size_t r = 0; r < table.size(); ++r) {
+            if (table.years[r] < from || table.years[r] > to) continue;
+            values.push_back(column < MONTHS_PER_YEAR
+                                 ? table.month(column)[r]
+                                 : table.aggregate(static_cast<AggregateColumn>(column - MONTHS_PER_YEAR))[r]);
+            years.push_back(table.years[r]);
+            months.push_back(column < MONTHS_PER_YEAR ? column : -1);
+        }
+        checkStats(index.query(column, from, to), values, years, months);
+
+        const int fromMonth = month(rng), toMonth = month(rng);
+        values.clear();
+        years.clear();
+        months.clear();
+        for (size_t r = 0; r < table.size(); ++r) {
+            for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+                const long position = table.years[r] * 12L + m;
+                if (position < from * 12L + fromMonth || position > to * 12L + toMonth) continue;
+                values.push_back(table.month(m)[r]);
+                years.push_back(table.years[r]);
+                months.push_back(m);
+            }
+        }
+        checkStats(index.queryMonths(from, fromMonth, to, toMonth), values, years, months);
+    }
+    return testResult();
+}
@@ -0,0 +1,136 @@
+// Theil-Sen slopes and Mann-Kendall statistics against every pair of points
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "distributions.h"
+#include "robust_trend.h"
+#include "test_check.h"
+
+namespace {
+
+// Function to add the tie terms of every group of equal values
+void tieTerms(const std::vector<double>& values, double& pairs, double& variance, double& twice, double& thrice) {
+    std::map<double, double> groups;
+    for (double value : values) groups[value] += 1.0;
+    pairs = variance = twice = thrice = 0.0;
+    for (const auto& group : groups) {
+        const double t = group.second;
+        pairs += t * (t - 1.0) / 2.0;
+        variance += t * (t - 1.0) * (2.0 * t + 5.0);
+        twice += t * (t - 1.0);
+        thrice += t * (t - 1.0) * (t - 2.0);
+    }
+}
+
+// Function to fit the same line the slow way: list and sort every pairwise
+// slope, and count concordant and discordant pairs one by one
+RobustTrend allPairs(const std::vector<double>& xIn, const std::vector<double>& yIn, double confidence) {
+    std::vector<double> x, y;
+    for (size_t i = 0; i < xIn.size(); ++i) {
+        if (std::isnan(xIn[i]) || std::isnan(yIn[i])) continue;
+        x.push_back(xIn[i]);
+        y.push_back(yIn[i]);
+    }
+    RobustTrend result;
+    result.n = x.size();
+    const double n = static_cast<double>(x.size());
+
+    std::vector<double> slopes;
+    double s = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        for (size_t j = i + 1; j < x.size(); ++j) {
+            const double dx = x[j] - x[i], dy = y[j] - y[i];
+            if (dx != 0.0) slopes.push_back(dy / dx);
+            s += ((dx > 0) - (dx < 0)) * ((dy > 0) - (dy < 0));
+        }
+    }
+    if (slopes.empty()) {
+        return result;
+    }
+    std::sort(slopes.begin(), slopes.end());
+    const size_t pairs = slopes.size();
+    result.slope = 0.5 * (slopes[(pairs - 1) / 2] + slopes[pairs / 2]);
+
+    double xPairs, xVariance, xTwice, xThrice, yPairs, yVariance, yTwice, yThrice;
+    tieTerms(x, xPairs, xVariance, xTwice, xThrice);
+    tieTerms(y, yPairs, yVariance, yTwice, yThrice);
+    double variance = (n * (n - 1.0) * (2.0 * n + 5.0) - xVariance - yVariance) / 18.0 +
+                      xTwice * yTwice / (2.0 * n * (n - 1.0));
+    if (n > 2) variance += xThrice * yThrice / (9.0 * n * (n - 1.0) * (n - 2.0));
+    const double total = n * (n - 1.0) / 2.0;
+    result.kendallS = s;
+    result.kendallTau = s / std::sqrt((total - xPairs) * (total - yPairs));
+    result.varianceS = variance;
+
+    // Gilbert (1987): ranks (N - C) / 2 and (N + C) / 2 + 1, counted from 1
+    const double halfWidth = normalQuantile(0.5 + 0.5 * confidence) * std::sqrt(variance);
+    const double last = static_cast<double>(pairs - 1);
+    const double lower = std::min(std::max(std::nearbyint((pairs - halfWidth) / 2.0) - 1.0, 0.0), last);
+    const double upper = std::min(std::max(std::nearbyint((pairs + halfWidth) / 2.0), 0.0), last);
+    result.slopeLower = slopes[static_cast<size_t>(lower)];
+    result.slopeUpper = slopes[static_cast<size_t>(upper)];
+    return result;
+}
+
+void checkSame(const RobustTrend& fast, const RobustTrend& slow) {
+    CHECK(fast.n == slow.n);
+    CHECK_NEAR(fast.slope, slow.slope, 1e-12);
+    CHECK_NEAR(fast.slopeLower, slow.slopeLower, 1e-12);
+    CHECK_NEAR(fast.slopeUpper, slow.slopeUpper, 1e-12);
+    CHECK_NEAR(fast.kendallS, slow.kendallS, 0.0);
+    CHECK_NEAR(fast.kendallTau, slow.kendallTau, 1e-12);
+    CHECK_NEAR(fast.varianceS, slow.varianceS, 1e-12);
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1968);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<double> x, y;
+
+    // Sizes on both sides of the all-pairs limit, so the selection by
+    // inversion counting is exercised as well as the direct listing
+    const size_t sizes[] = {2, 3, 5, 17, 60, 255, 256, 400, 900};
+    for (size_t n : sizes) {
+        for (int trial = 0; trial < 6; ++trial) {
+            x.resize(n);
+            y.resize(n);
+            const double slope = noise(rng);
+            for (size_t i = 0; i < n; ++i) {
+                // Odd trials repeat x values, and trials from 2 on round y so values tie
+                x[i] = trial % 2 == 1 ? std::floor(unit(rng) * n / 3.0) : static_cast<double>(i);
+                y[i] = slope * x[i] + noise(rng) * (trial % 3 == 0 ? 5.0 : 1.0);
+                if (trial >= 2) y[i] = std::round(y[i]);
+                if (trial >= 4 && unit(rng) < 0.1) y[i] = NAN;
+            }
+            if (trial == 5 && n > 3) std::shuffle(x.begin(), x.end(), rng);
+            checkSame(theilSen(x.data(), y.data(), n, 1, 0.9), allPairs(x, y, 0.9));
+        }
+    }
+
+    // Strided series through the batch entry point
+    const size_t n = 120, series = 5;
+    x.resize(n);
+    std::vector<float> grid(n * series);
+    for (size_t i = 0; i < n; ++i) x[i] = 1900.0 + static_cast<double>(i);
+    for (float& value : grid) value = static_cast<float>(std::round(noise(rng) * 4.0) / 4.0);
+    std::vector<RobustTrend> results(series);
+    theilSenBatch(x.data(), n, grid.data(), 1, series, series, results.data());
+    y.resize(n);
+    for (size_t s = 0; s < series; ++s) {
+        for (size_t i = 0; i < n; ++i) y[i] = grid[i * series + s];
+        checkSame(results[s], allPairs(x, y, 0.95));
+    }
+
+    // Fewer than two distinct x values: no line
+    x.assign(4, 2000.0);
+    y.assign({1.0, 2.0, 3.0, 4.0});
+    CHECK(!theilSen(x.data(), y.data(), 4).valid());
+    return testResult();
+}
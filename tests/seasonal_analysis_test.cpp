@@ -0,0 +1,81 @@
+// Monthly and yearly deviation statistics of a monthly-only table, whose
+// derived first DJF is missing, against a direct computation
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include "aggregation.h"
+#include "climate_analysis.h"
+#include "climate_reports.h"
+#include "test_check.h"
+
+int main() {
+    // Year,Jan..Dec only, with a few months missing and one year entirely so
+    std::mt19937 rng(1951);
+    std::normal_distribution<double> noise(0.0, 0.3);
+    std::ostringstream csv;
+    csv << "Year,Jan,Feb,Mar,Apr,May,Jun,Jul,Aug,Sep,Oct,Nov,Dec\n";
+    for (int year = 1950; year < 1990; ++year) {
+        csv << year;
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            const bool missing = year == 1970 || (year == 1951 && m == 0) || (year == 1960 && m % 5 == 1);
+            if (missing) {
+                csv << ",***";
+            } else {
+                csv << "," << std::round((0.01 * (year - 1950) + noise(rng)) * 100.0) / 100.0;
+            }
+        }
+        csv << "\n";
+    }
+    const std::string text = csv.str();
+    ClimateTable table;
+    std::string error;
+    CHECK(parseClimateTable(text.data(), text.size(), table, error));
+    CHECK(deriveMissingAggregates(table));
+    CHECK(isMissing(table.aggregate(AGG_DJF)[0])); // no December before the first year
+
+    MonthDeviationStats stats[MONTHS_PER_YEAR];
+    computeMonthlyDeviationStats(table, stats);
+    for (int month = 0; month < MONTHS_PER_YEAR; ++month) {
+        const Column<double>& season = table.aggregate(static_cast<AggregateColumn>(AGG_DJF + month / 3));
+        double sum = 0.0, max = -INFINITY, min = INFINITY;
+        int count = 0;
+        for (size_t r = 0; r < table.size(); ++r) {
+            const double deviation = table.month(month)[r] - season[r];
+            if (std::isnan(deviation)) continue;
+            sum += deviation;
+            max = std::max(max, deviation);
+            min = std::min(min, deviation);
+            ++count;
+        }
+        CHECK(count > 0);
+        CHECK_NEAR(stats[month].mean, sum / count, 1e-12);
+        CHECK_NEAR(stats[month].max, max, 0.0);
+        CHECK_NEAR(stats[month].min, min, 0.0);
+    }
+
+    for (const YearExtremes& e : computeYearExtremes(table)) {
+        const size_t r = static_cast<size_t>(e.year - 1950);
+        int hottest = -1, coldest = -1;
+        for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+            const double value = table.month(m)[r];
+            if (std::isnan(value)) continue;
+            if (hottest < 0 || value > table.month(hottest)[r]) hottest = m;
+            if (coldest < 0 || value < table.month(coldest)[r]) coldest = m;
+        }
+        CHECK(e.hottestMonth == hottest && e.coldestMonth == coldest);
+        if (hottest >= 0) {
+            CHECK(e.maxTemp == table.month(hottest)[r] && e.minTemp == table.month(coldest)[r]);
+        }
+    }
+
+    // The seasonal report prints no NaN for such a table
+    std::ostringstream report;
+    monthlyAnalysis(table, report);
+    yearlyAnalysis(table, report);
+    CHECK(report.str().find("nan") == std::string::npos);
+    return testResult();
+}
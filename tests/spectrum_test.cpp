@@ -0,0 +1,104 @@
+// FFT plans and periodograms against a naive discrete Fourier transform
+
+#include <cmath>
+#include <complex>
+#include <random>
+#include <vector>
+
+#include "spectrum.h"
+#include "test_check.h"
+
+namespace {
+
+const double PI = 3.14159265358979323846;
+
+// Function to compute X[k] = sum over j of x[j] exp(-2 pi i j k / n) term by
+// term in long double, from a table of the n roots of unity
+std::vector<std::complex<double>> naiveDft(const std::complex<double>* x, size_t n) {
+    std::vector<std::complex<long double>> roots(n);
+    for (size_t r = 0; r < n; ++r) {
+        const long double angle = -2.0L * PI * static_cast<long double>(r) / n;
+        roots[r] = {std::cos(angle), std::sin(angle)};
+    }
+    std::vector<std::complex<double>> result(n);
+    for (size_t k = 0; k < n; ++k) {
+        std::complex<long double> sum = 0.0L;
+        for (size_t j = 0; j < n; ++j) {
+            sum += std::complex<long double>(x[j].real(), x[j].imag()) * roots[(j * k) % n];
+        }
+        result[k] = std::complex<double>(static_cast<double>(sum.real()), static_cast<double>(sum.imag()));
+    }
+    return result;
+}
+
+void checkPlan(size_t n, size_t count, std::mt19937& rng) {
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<std::complex<double>> data(n * count);
+    for (auto& value : data) value = {noise(rng), noise(rng)};
+    const std::vector<std::complex<double>> input = data;
+
+    FftPlan plan(n);
+    CHECK(plan.size() == n);
+    plan.forward(data.data(), count);
+    // Errors grow like sqrt(n) log n times the size of a coefficient, itself about sqrt(n)
+    const double tolerance = 1e-13 * n * (1.0 + std::log2(static_cast<double>(n)));
+    for (size_t s = 0; s < count; ++s) {
+        const std::vector<std::complex<double>> expected = naiveDft(&input[s * n], n);
+        double worst = 0.0;
+        for (size_t k = 0; k < n; ++k) worst = std::max(worst, std::abs(data[s * n + k] - expected[k]));
+        if (worst > tolerance) {
+            std::cerr << "FFT of length " << n << ": error " << worst << "\n";
+            ++test_check::failures();
+        }
+    }
+}
+
+// Function to check the plain periodogram (no detrending, no taper) of series
+// interleaved with a time stride against |DFT|^2 scaled as scipy's density
+void checkPeriodogram(size_t n, size_t count, std::mt19937& rng) {
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<double> values(n * count);
+    for (double& value : values) value = noise(rng);
+
+    SpectrumOptions options;
+    options.detrend = DETREND_NONE;
+    options.taper = TAPER_NONE;
+    SpectrumPlan plan(n, options);
+    std::vector<double> power(count * plan.bins());
+    plan.compute(values.data(), 1, count, count, power.data());
+
+    std::vector<std::complex<double>> series(n);
+    for (size_t s = 0; s < count; ++s) {
+        for (size_t i = 0; i < n; ++i) series[i] = values[i * count + s];
+        const std::vector<std::complex<double>> spectrum = naiveDft(series.data(), n);
+        for (size_t bin = 0; bin < plan.bins(); ++bin) {
+            const bool folded = bin != 0 && 2 * bin != n;
+            const double expected = std::norm(spectrum[bin]) * (folded ? 2.0 : 1.0) / (options.sampleRate * n);
+            CHECK_NEAR(power[s * plan.bins() + bin], expected, 1e-9);
+        }
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(1965);
+    // Every small length: powers of two, mixed radix 2/3/4/5 and Bluestein
+    for (size_t n = 1; n <= 64; ++n) checkPlan(n, 3, rng);
+    // Monthly series of whole years, primes and lengths with a large prime factor
+    const size_t lengths[] = {120, 97, 360, 625, 729, 1001, 1024, 1728, 2048 + 1};
+    for (size_t n : lengths) checkPlan(n, 2, rng);
+
+    // Odd series counts leave one series without a partner in the paired transform
+    checkPeriodogram(240, 3, rng);
+    checkPeriodogram(97, 4, rng);
+
+    // A single value has no spectrum
+    SpectrumOptions options;
+    SpectrumPlan single(1, options);
+    const double value = 1.0;
+    double power[1];
+    single.compute(&value, 1, 1, 1, power);
+    CHECK(std::isnan(power[0]));
+    return testResult();
+}
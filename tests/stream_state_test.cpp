@@ -0,0 +1,117 @@
+// Stream ingestion split at every kind of point, through a checkpoint,
+// against ingesting the whole stream at once
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "stream_state.h"
+#include "synthetic_data.h"
+#include "test_check.h"
+
+namespace {
+
+struct Row {
+    int year;
+    double values[VALUE_COLUMNS];
+};
+
+// Same bits, or both NaN
+bool same(double a, double b) {
+    return (std::isnan(a) && std::isnan(b)) || std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+bool sameAccumulator(const RegressionAccumulator& a, const RegressionAccumulator& b) {
+    return same(a.count, b.count) && same(a.meanX, b.meanX) && same(a.meanY, b.meanY) && same(a.m2X, b.m2X) &&
+           same(a.m2Y, b.m2Y) && same(a.cXY, b.cXY) && same(a.originX, b.originX) && same(a.originY, b.originY) &&
+           same(a.lastX, b.lastX) && same(a.lastY, b.lastY) && same(a.linked, b.linked) && same(a.pairs, b.pairs) &&
+           same(a.pairYY, b.pairYY) && same(a.pairY, b.pairY) && same(a.pairXY, b.pairXY) &&
+           same(a.pairX, b.pairX) && same(a.pairXX, b.pairXX);
+}
+
+bool sameRecords(const RecordTracker& a, const RecordTracker& b) {
+    return same(a.maxValue, b.maxValue) && same(a.minValue, b.minValue) && same(a.secondValue, b.secondValue) &&
+           a.maxYear == b.maxYear && a.minYear == b.minYear && a.secondYear == b.secondYear &&
+           a.lastHighYear == b.lastHighYear && a.lastLowYear == b.lastLowYear && a.recordCount == b.recordCount &&
+           a.lowRecordCount == b.lowRecordCount;
+}
+
+bool sameEvents(const EventCounter& a, const EventCounter& b) {
+    return a.threshold == b.threshold && same(a.run.amplitude, b.run.amplitude) && a.run.sign == b.run.sign &&
+           a.run.length == b.run.length && a.run.startYear == b.run.startYear &&
+           a.run.startMonth == b.run.startMonth && a.run.lastYear == b.run.lastYear &&
+           a.run.lastMonth == b.run.lastMonth && same(a.run.peak, b.run.peak) &&
+           same(a.run.intensity, b.run.intensity) && a.heatwaveCount == b.heatwaveCount &&
+           a.coldSnapCount == b.coldSnapCount && a.longestHeatwave == b.longestHeatwave &&
+           a.longestColdSnap == b.longestColdSnap;
+}
+
+void checkSameState(const StreamState& a, const StreamState& b) {
+    CHECK(a.lastYear == b.lastYear && a.lastMonth == b.lastMonth);
+    CHECK(a.lastAnnualYear == b.lastAnnualYear && a.decadeStart == b.decadeStart);
+    for (int m = 0; m < MONTHS_PER_YEAR; ++m) {
+        CHECK(sameRecords(a.records[m], b.records[m]));
+        CHECK(sameAccumulator(a.gapRegression[m], b.gapRegression[m]));
+    }
+    CHECK(sameAccumulator(a.overallTrend, b.overallTrend));
+    CHECK(sameAccumulator(a.decadeTrend, b.decadeTrend));
+    CHECK(sameEvents(a.events, b.events));
+}
+
+// Function to parse the data rows of a generated table
+std::vector<Row> parseRows(const std::string& csv) {
+    std::vector<Row> rows;
+    std::string error;
+    const char* cursor = csv.data();
+    const char* const end = cursor + csv.size();
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) lineEnd = end;
+        Row row;
+        if (parseClimateRow(cursor, lineEnd, row.year, row.values, error) == ROW_OK) rows.push_back(row);
+        cursor = lineEnd + 1;
+    }
+    return rows;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<Row> rows = parseRows(generateSyntheticCsv(150, 2024, 0.02));
+    CHECK(rows.size() == 150);
+
+    StreamState whole;
+    for (const Row& row : rows) ingestRow(whole, row.year, row.values);
+
+    const std::string checkpoint =
+        (std::filesystem::temp_directory_path() / "stream_state_test.checkpoint").string();
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int> month(-1, MONTHS_PER_YEAR - 1);
+    for (size_t split = 0; split <= rows.size(); split += 7) {
+        // The first part ends with the split row published only up to some
+        // month (-1: not at all), as a table downloaded mid-year would be
+        StreamState first;
+        for (size_t r = 0; r < split; ++r) ingestRow(first, rows[r].year, rows[r].values);
+        if (split < rows.size()) {
+            Row partial = rows[split];
+            for (int m = month(rng) + 1; m < VALUE_COLUMNS; ++m) partial.values[m] = NAN;
+            ingestRow(first, partial.year, partial.values);
+        }
+
+        std::string error;
+        CHECK(saveStreamState(first, checkpoint, error));
+        StreamState resumed;
+        bool exists = false;
+        CHECK(loadStreamState(resumed, checkpoint, exists, error) && exists);
+
+        // The second part repeats the whole table, as a later download would
+        for (const Row& row : rows) ingestRow(resumed, row.year, row.values);
+        checkSameState(resumed, whole);
+    }
+    std::remove(checkpoint.c_str());
+    return testResult();
+}
@@ -0,0 +1,45 @@
+#ifndef TEST_CHECK_H
+#define TEST_CHECK_H
+
+#include <cmath>
+#include <iostream>
+
+// Minimal checks for the test programs: each failure is reported with its
+// location and counted, and main returns testResult()
+namespace test_check {
+inline int& failures() {
+    static int count = 0;
+    return count;
+}
+} // namespace test_check
+
+#define CHECK(condition)                                                                         \
+    do {                                                                                         \
+        if (!(condition)) {                                                                      \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n";      \
+            ++test_check::failures();                                                            \
+        }                                                                                        \
+    } while (0)
+
+// Equal within an absolute plus relative tolerance; two NaNs are equal
+#define CHECK_NEAR(actual, expected, tolerance)                                                  \
+    do {                                                                                         \
+        const double a_ = (actual), e_ = (expected);                                             \
+        const bool same_ = (std::isnan(a_) && std::isnan(e_)) ||                                 \
+                           std::fabs(a_ - e_) <= (tolerance) * (1.0 + std::fabs(e_));            \
+        if (!same_) {                                                                            \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " #actual " = " << a_                 \
+                      << ", expected " << e_ << "\n";                                            \
+            ++test_check::failures();                                                            \
+        }                                                                                        \
+    } while (0)
+
+inline int testResult() {
+    if (test_check::failures() > 0) {
+        std::cerr << test_check::failures() << " check(s) failed\n";
+        return 1;
+    }
+    return 0;
+}
+
+#endif // TEST_CHECK_H
@@ -0,0 +1,125 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <exception>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers_.push_back(std::unique_ptr<Worker>(new Worker));
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    sleepCv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::push(unsigned worker, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(workers_[worker]->mutex);
+        workers_[worker]->tasks.push_back(std::move(task));
+    }
+    ++queued_;
+}
+
+bool ThreadPool::take(unsigned worker, std::function<void()>& task) {
+    const unsigned n = size();
+    for (unsigned k = 0; k < n; ++k) {
+        Worker& victim = *workers_[(worker + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+        // Own work from the back (most recently pushed), stolen work from the front
+        if (k == 0) {
+            task = std::move(victim.tasks.back());
+            victim.tasks.pop_back();
+        } else {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+        --queued_;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    std::function<void()> task;
+    for (;;) {
+        if (take(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        sleepCv_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    if (begin >= end) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+
+    // Shared with the tasks so it outlives whichever finishes last
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining = 0;
+        std::exception_ptr error;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = (end - begin + grain - 1) / grain;
+
+    unsigned next = 0;
+    for (size_t lo = begin; lo < end; lo += grain) {
+        const size_t hi = std::min(end, lo + grain);
+        push(next, [batch, &body, lo, hi] {
+            std::exception_ptr error;
+            try {
+                body(lo, hi);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            if (error && !batch->error) batch->error = error;
+            if (--batch->remaining == 0) batch->done.notify_all();
+        });
+        next = (next + 1) % size();
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    sleepCv_.notify_all();
+
+    // Help out instead of blocking; body stays alive until every task has run
+    std::function<void()> task;
+    while (take(0, task)) {
+        task();
+        task = nullptr;
+    }
+
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&batch] { return batch->remaining == 0; });
+    if (batch->error) {
+        std::rethrow_exception(batch->error);
+    }
+}
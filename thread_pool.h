@@ -0,0 +1,52 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it takes work from
+// the back of its own deque and, when that is empty, steals from the front
+// of the others, so uneven chunks (e.g. ocean vs land cells with different
+// amounts of missing data) still keep every core busy.
+class ThreadPool {
+public:
+    // threads == 0 uses one worker per hardware thread
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    // Function to run body(chunkBegin, chunkEnd) over [begin, end) in chunks
+    // of at most grain items and wait for all of them. The calling thread
+    // helps with the work. The first exception thrown by body is rethrown.
+    void parallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void push(unsigned worker, std::function<void()> task);
+    bool take(unsigned worker, std::function<void()>& task);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::atomic<size_t> queued_{0};
+    std::mutex sleepMutex_;
+    std::condition_variable sleepCv_;
+    bool stopping_ = false;
+};
+
+#endif // THREAD_POOL_H